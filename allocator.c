@@ -0,0 +1,243 @@
+/*
+ * allocator.c -- the malloc allocator and a bump/arena allocator
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator.h"
+
+/* Every block handed out by an arena is aligned like malloc() does. */
+#define ALIGNMENT (alignof(max_align_t))
+
+static void *malloc_alloc(void *ctx, size_t size) {
+    (void) ctx;
+    return malloc(size);
+}
+
+static void *malloc_resize(void *ctx, void *ptr, size_t old_size,
+                           size_t new_size) {
+    (void) ctx;
+    (void) old_size;
+    return realloc(ptr, new_size);
+}
+
+static void malloc_release(void *ctx, void *ptr, size_t size) {
+    (void) ctx;
+    (void) size;
+    free(ptr);
+}
+
+const struct allocator malloc_allocator = {
+    .alloc = malloc_alloc,
+    .resize = malloc_resize,
+    .release = malloc_release,
+    .ctx = NULL,
+};
+
+/**
+ * struct chunk -- a piece of memory the arena allocates from
+ * @next: the next chunk of the arena
+ * @size: the number of bytes in @data
+ * @data: the memory
+ */
+struct chunk {
+    struct chunk *next;
+    size_t size;
+    alignas(max_align_t) unsigned char data[];
+};
+
+/**
+ * struct arena -- the structure where an arena is stored
+ * @allocator: the allocator handed out by arena_allocator()
+ * @chunk_size: the minimum size of a new chunk
+ * @first: the first chunk of the list of all chunks
+ * @current: the chunk being allocated from, NULL right after a reset
+ * @offset: the number of bytes of @current that are in use
+ * @last: the most recent allocation, which can be resized in place
+ * @used: the number of bytes handed out since the last reset
+ * @capacity: the total size of all chunks
+ *
+ * Chunks are allocated with malloc() when the arena runs out of space and
+ * stay on the @first list until arena_cleanup(). A reset only forgets
+ * where the arena was, so after a reset the same chunks are filled again
+ * from the start.
+ */
+struct arena {
+    struct allocator allocator;
+    size_t chunk_size;
+    struct chunk *first;
+    struct chunk *current;
+    size_t offset;
+    void *last;
+    size_t used;
+    size_t capacity;
+};
+
+static size_t align_up(size_t size) {
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+/* Move on to a chunk after @current that can hold 'size' bytes, allocating
+ * one if there is none. Return 0 if successful, 1 otherwise. */
+static int next_chunk(struct arena *a, size_t size) {
+    struct chunk *next = a->current ? a->current->next : a->first;
+
+    if (next == NULL || next->size < size) {
+        size_t chunk_size = size > a->chunk_size ? size : a->chunk_size;
+        struct chunk *c = malloc(sizeof(struct chunk) + chunk_size);
+        if (c == NULL) {
+            return 1;
+        }
+
+        c->size = chunk_size;
+        c->next = next;
+        if (a->current) {
+            a->current->next = c;
+        } else {
+            a->first = c;
+        }
+        a->capacity += chunk_size;
+        next = c;
+    }
+
+    a->current = next;
+    a->offset = 0;
+    return 0;
+}
+
+static void *arena_alloc(void *ctx, size_t size) {
+    struct arena *a = ctx;
+    size = align_up(size ? size : 1);
+
+    if (a->current == NULL || a->current->size - a->offset < size) {
+        if (next_chunk(a, size)) {
+            return NULL;
+        }
+    }
+
+    void *ptr = a->current->data + a->offset;
+    a->offset += size;
+    a->used += size;
+    a->last = ptr;
+    return ptr;
+}
+
+static void *arena_resize(void *ctx, void *ptr, size_t old_size,
+                          size_t new_size) {
+    struct arena *a = ctx;
+
+    if (ptr == NULL) {
+        return arena_alloc(a, new_size);
+    }
+
+    /* The most recent block can grow or shrink in place if it fits. */
+    if (ptr == a->last) {
+        size_t start = (size_t) ((unsigned char *) ptr - a->current->data);
+        size_t old_end = a->offset;
+        size_t new_end = start + align_up(new_size ? new_size : 1);
+        if (new_end <= a->current->size) {
+            a->offset = new_end;
+            a->used = a->used - old_end + new_end;
+            return ptr;
+        }
+    } else if (new_size <= old_size) {
+        return ptr;
+    }
+
+    void *new = arena_alloc(a, new_size);
+    if (new == NULL) {
+        return NULL;
+    }
+
+    memcpy(new, ptr, old_size < new_size ? old_size : new_size);
+    return new;
+}
+
+static void arena_release(void *ctx, void *ptr, size_t size) {
+    struct arena *a = ctx;
+    (void) size;
+
+    /* Only the most recent block can be given back before a reset. */
+    if (ptr != NULL && ptr == a->last) {
+        size_t start = (size_t) ((unsigned char *) ptr - a->current->data);
+        a->used -= a->offset - start;
+        a->offset = start;
+        a->last = NULL;
+    }
+}
+
+struct arena *arena_init(size_t chunk_size) {
+    struct arena *a = malloc(sizeof(struct arena));
+    if (a == NULL) {
+        return NULL;
+    }
+
+    a->allocator.alloc = arena_alloc;
+    a->allocator.resize = arena_resize;
+    a->allocator.release = arena_release;
+    a->allocator.ctx = a;
+    a->chunk_size = align_up(chunk_size ? chunk_size : 1);
+    a->first = NULL;
+    a->current = NULL;
+    a->offset = 0;
+    a->last = NULL;
+    a->used = 0;
+    a->capacity = 0;
+
+    return a;
+}
+
+void arena_cleanup(struct arena *a) {
+    if (a == NULL) {
+        return;
+    }
+
+    struct chunk *c = a->first;
+    while (c != NULL) {
+        struct chunk *next = c->next;
+        free(c);
+        c = next;
+    }
+    free(a);
+}
+
+void arena_reset(struct arena *a) {
+    if (a == NULL) {
+        return;
+    }
+
+    a->current = NULL;
+    a->offset = 0;
+    a->last = NULL;
+    a->used = 0;
+}
+
+const struct allocator *arena_allocator(struct arena *a) {
+    if (a == NULL) {
+        return NULL;
+    }
+
+    return &a->allocator;
+}
+
+size_t arena_used(const struct arena *a) {
+    if (a == NULL) {
+        return 0;
+    }
+
+    return a->used;
+}
+
+size_t arena_capacity(const struct arena *a) {
+    if (a == NULL) {
+        return 0;
+    }
+
+    return a->capacity;
+}
@@ -0,0 +1,58 @@
+#ifndef _ALLOCATOR_H_
+#define _ALLOCATOR_H_
+
+#include <stddef.h>
+
+/* An allocator is a table of functions that containers use instead of
+ * calling malloc(), realloc() and free() directly. Every function gets the
+ * 'ctx' pointer of the allocator as its first argument. */
+struct allocator {
+    /* Return a pointer to 'size' bytes of memory, or NULL on failure. */
+    void *(*alloc)(void *ctx, size_t size);
+
+    /* Resize the block 'ptr' of 'old_size' bytes to 'new_size' bytes and
+     * return its (possibly new) address, or NULL on failure in which case
+     * 'ptr' is left untouched. */
+    void *(*resize)(void *ctx, void *ptr, size_t old_size, size_t new_size);
+
+    /* Give back the block 'ptr' of 'size' bytes. 'ptr' may be NULL. */
+    void (*release)(void *ctx, void *ptr, size_t size);
+
+    void *ctx;
+};
+
+/* The allocator used by stack_init() and queue_init(). It calls malloc(),
+ * realloc() and free(). */
+extern const struct allocator malloc_allocator;
+
+/* Handle to an arena.
+ *
+ * An arena hands out memory from large chunks by bumping a pointer. Memory
+ * is not given back one block at a time; instead arena_reset() makes all of
+ * it available again at once, while keeping the chunks for reuse. */
+struct arena;
+
+/* Return a pointer to an arena that allocates chunks of at least
+ * 'chunk_size' bytes, or NULL if an error occured. No chunk is allocated
+ * until the first allocation. */
+struct arena *arena_init(size_t chunk_size);
+
+/* Free the arena and all of its chunks. Everything allocated from the
+ * arena becomes invalid. */
+void arena_cleanup(struct arena *a);
+
+/* Make all memory of the arena available again in O(1). Everything
+ * allocated from the arena becomes invalid, but the chunks are kept so
+ * that later allocations do not need to call malloc(). */
+void arena_reset(struct arena *a);
+
+/* Return the allocator that allocates from arena 'a'. */
+const struct allocator *arena_allocator(struct arena *a);
+
+/* Return the number of bytes handed out since the last reset. */
+size_t arena_used(const struct arena *a);
+
+/* Return the number of bytes in all chunks owned by the arena. */
+size_t arena_capacity(const struct arena *a);
+
+#endif
@@ -0,0 +1,394 @@
+/*
+ * bench_containers.c -- microbenchmarks for stack.c and queue.c
+ *
+ * Usage: bench_containers [-n items] [-r rounds] [-o results] [-v revision]
+ *
+ * Every pattern is run 'rounds' times on 'items' items and the fastest
+ * round is reported, as ns per operation and millions of operations per
+ * second. Pushes, pops and peeks all count as one operation. If a results
+ * file is given, one CSV line per container and pattern is appended to it,
+ * labelled with 'revision', and the table shows the change against the
+ * last run of another revision in that file.
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "queue.h"
+#include "stack.h"
+
+#define DEFAULT_ITEMS (1 << 20)
+#define DEFAULT_ROUNDS 5
+
+/* Number of items kept in the container by the sliding window pattern. */
+#define WINDOW 1024
+
+/* Keeps the compiler from dropping the values that are popped. */
+static volatile long sink;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+/* Each pattern returns the number of operations it did, or 0 if a
+ * container operation failed. */
+
+/* Push all items, then peek and pop them all. */
+static long stack_fill_drain(long items)
+{
+    struct stack *s = stack_init((size_t) items);
+    long sum = 0;
+    if (s == NULL) {
+        return 0;
+    }
+
+    for (long i = 0; i < items; i++) {
+        if (stack_push(s, (int) i)) {
+            stack_cleanup(s);
+            return 0;
+        }
+    }
+    for (long i = 0; i < items; i++) {
+        sum += stack_peek(s);
+        sum += stack_pop(s);
+    }
+
+    sink = sum;
+    stack_cleanup(s);
+    return items * 3;
+}
+
+/* Keep WINDOW items in the stack while pushing and popping one at a time. */
+static long stack_window(long items)
+{
+    struct stack *s = stack_init(WINDOW + 1);
+    long sum = 0;
+    if (s == NULL) {
+        return 0;
+    }
+
+    for (long i = 0; i < WINDOW; i++) {
+        stack_push(s, (int) i);
+    }
+    for (long i = 0; i < items; i++) {
+        if (stack_push(s, (int) i)) {
+            stack_cleanup(s);
+            return 0;
+        }
+        sum += stack_pop(s);
+    }
+
+    sink = sum;
+    stack_cleanup(s);
+    return WINDOW + items * 2;
+}
+
+/* Start at capacity 0, so the pushes include every resize. */
+static long stack_growth(long items)
+{
+    struct stack *s = stack_init(0);
+    if (s == NULL) {
+        return 0;
+    }
+
+    for (long i = 0; i < items; i++) {
+        if (stack_push(s, (int) i)) {
+            stack_cleanup(s);
+            return 0;
+        }
+    }
+
+    sink = (long) stack_size(s);
+    stack_cleanup(s);
+    return items;
+}
+
+/* Push two, pop one, until all items are pushed, then drain. */
+static long stack_interleaved(long items)
+{
+    struct stack *s = stack_init(16);
+    long sum = 0;
+    long ops = 0;
+    if (s == NULL) {
+        return 0;
+    }
+
+    for (long i = 0; i < items; i += 2) {
+        if (stack_push(s, (int) i) || stack_push(s, (int) i + 1)) {
+            stack_cleanup(s);
+            return 0;
+        }
+        sum += stack_pop(s);
+        ops += 3;
+    }
+    while (!stack_empty(s)) {
+        sum += stack_pop(s);
+        ops += 2;
+    }
+
+    sink = sum;
+    stack_cleanup(s);
+    return ops;
+}
+
+static long queue_fill_drain(long items)
+{
+    struct queue *q = queue_init((size_t) items);
+    long sum = 0;
+    if (q == NULL) {
+        return 0;
+    }
+
+    for (long i = 0; i < items; i++) {
+        if (queue_push(q, (int) i)) {
+            queue_cleanup(q);
+            return 0;
+        }
+    }
+    for (long i = 0; i < items; i++) {
+        sum += queue_peek(q);
+        sum += queue_pop(q);
+    }
+
+    sink = sum;
+    queue_cleanup(q);
+    return items * 3;
+}
+
+/* The window slides through the ring, so head and tail keep wrapping. */
+static long queue_window(long items)
+{
+    struct queue *q = queue_init(WINDOW + 1);
+    long sum = 0;
+    if (q == NULL) {
+        return 0;
+    }
+
+    for (long i = 0; i < WINDOW; i++) {
+        queue_push(q, (int) i);
+    }
+    for (long i = 0; i < items; i++) {
+        if (queue_push(q, (int) i)) {
+            queue_cleanup(q);
+            return 0;
+        }
+        sum += queue_pop(q);
+    }
+
+    sink = sum;
+    queue_cleanup(q);
+    return WINDOW + items * 2;
+}
+
+static long queue_growth(long items)
+{
+    struct queue *q = queue_init(0);
+    if (q == NULL) {
+        return 0;
+    }
+
+    for (long i = 0; i < items; i++) {
+        if (queue_push(q, (int) i)) {
+            queue_cleanup(q);
+            return 0;
+        }
+    }
+
+    sink = (long) queue_size(q);
+    queue_cleanup(q);
+    return items;
+}
+
+/* Growing while the items wrap around is the slow path of queue_push(). */
+static long queue_interleaved(long items)
+{
+    struct queue *q = queue_init(16);
+    long sum = 0;
+    long ops = 0;
+    if (q == NULL) {
+        return 0;
+    }
+
+    for (long i = 0; i < items; i += 2) {
+        if (queue_push(q, (int) i) || queue_push(q, (int) i + 1)) {
+            queue_cleanup(q);
+            return 0;
+        }
+        sum += queue_pop(q);
+        ops += 3;
+    }
+    while (!queue_empty(q)) {
+        sum += queue_pop(q);
+        ops += 2;
+    }
+
+    sink = sum;
+    queue_cleanup(q);
+    return ops;
+}
+
+/**
+ * struct pattern -- a benchmark
+ * @container: the container that is measured
+ * @name: the name of the access pattern
+ * @run: the function that runs the pattern once
+ */
+struct pattern {
+    const char *container;
+    const char *name;
+    long (*run)(long items);
+};
+
+static const struct pattern patterns[] = {
+    { "stack", "fill_drain", stack_fill_drain },
+    { "stack", "window", stack_window },
+    { "stack", "growth", stack_growth },
+    { "stack", "interleaved", stack_interleaved },
+    { "queue", "fill_drain", queue_fill_drain },
+    { "queue", "window", queue_window },
+    { "queue", "growth", queue_growth },
+    { "queue", "interleaved", queue_interleaved },
+};
+
+#define N_PATTERNS (sizeof(patterns) / sizeof(patterns[0]))
+
+/* Look up the ns/op of the last run of 'p' by a revision other than
+ * 'revision' in the results file 'fp'. Return it, or a negative number if
+ * there is none. */
+static double previous_result(FILE *fp, const struct pattern *p,
+                              const char *revision)
+{
+    char line[512];
+    double found = -1.0;
+
+    rewind(fp);
+    while (fgets(line, sizeof(line), fp)) {
+        char rev[128];
+        char container[64];
+        char name[64];
+        long items;
+        double ns;
+
+        if (sscanf(line, "%127[^,],%63[^,],%63[^,],%ld,%lf", rev, container,
+                   name, &items, &ns) != 5) {
+            continue; /* The header or a line we don't understand. */
+        }
+        if (strcmp(rev, revision) != 0 && strcmp(container, p->container) == 0
+            && strcmp(name, p->name) == 0) {
+            found = ns;
+        }
+    }
+
+    return found;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-n items] [-r rounds] [-o results] "
+                    "[-v revision]\n", prog);
+}
+
+int main(int argc, char *argv[])
+{
+    long items = DEFAULT_ITEMS;
+    int rounds = DEFAULT_ROUNDS;
+    const char *results = NULL;
+    const char *revision = "unknown";
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:r:o:v:")) != -1) {
+        switch (opt) {
+        case 'n':
+            items = atol(optarg);
+            break;
+        case 'r':
+            rounds = atoi(optarg);
+            break;
+        case 'o':
+            results = optarg;
+            break;
+        case 'v':
+            revision = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (items <= 0 || rounds <= 0 || strchr(revision, ',') != NULL) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE *out = NULL;
+    if (results != NULL) {
+        out = fopen(results, "a+");
+        if (out == NULL) {
+            perror(results);
+            return 1;
+        }
+        fseek(out, 0, SEEK_END);
+        if (ftell(out) == 0) {
+            fprintf(out, "revision,container,pattern,items,ns_per_op,"
+                         "mops_per_s\n");
+        }
+    }
+
+    printf("revision %s, items %ld, best of %d rounds\n", revision, items,
+           rounds);
+    printf("%-6s %-12s %10s %10s %9s\n", "", "pattern", "ns/op", "Mops/s",
+           "change");
+
+    int status = 0;
+    for (size_t i = 0; i < N_PATTERNS; i++) {
+        const struct pattern *p = &patterns[i];
+        double best = 0.0;
+        long ops = 0;
+
+        for (int r = 0; r < rounds; r++) {
+            double start = now();
+            ops = p->run(items);
+            double elapsed = now() - start;
+            if (r == 0 || elapsed < best) {
+                best = elapsed;
+            }
+        }
+        if (ops == 0) {
+            fprintf(stderr, "%s %s: a container operation failed\n",
+                    p->container, p->name);
+            status = 1;
+            continue;
+        }
+
+        double ns = best * 1e9 / (double) ops;
+        double mops = (double) ops / best / 1e6;
+        printf("%-6s %-12s %10.2f %10.2f", p->container, p->name, ns, mops);
+
+        if (out != NULL) {
+            double before = previous_result(out, p, revision);
+            if (before > 0.0) {
+                printf(" %+8.1f%%", (ns - before) / before * 100.0);
+            }
+            fseek(out, 0, SEEK_END);
+            fprintf(out, "%s,%s,%s,%ld,%.3f,%.3f\n", revision, p->container,
+                    p->name, items, ns, mops);
+        }
+        printf("\n");
+    }
+
+    if (out != NULL) {
+        fclose(out);
+    }
+    return status;
+}
@@ -0,0 +1,173 @@
+/*
+ * bench_mpmc.c -- throughput benchmark for the multi-producer/multi-consumer
+ *                 queue
+ *
+ * Usage: bench_mpmc [threads] [items] [capacity]
+ *
+ * 'threads' producers push 'items' integers in total while 'threads'
+ * consumers pop them. The same transfer is done through queue.c guarded by
+ * a mutex for comparison.
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "mpmc_queue.h"
+#include "queue.h"
+
+#define DEFAULT_THREADS 4
+#define DEFAULT_ITEMS 4000000
+#define DEFAULT_CAPACITY 1024
+#define MAX_THREADS 256
+
+static long items_per_thread;
+static size_t capacity = DEFAULT_CAPACITY;
+
+static struct mpmc_queue *mq;
+static struct queue *lq;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_long remaining;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+static void *mpmc_producer(void *arg)
+{
+    (void) arg;
+    for (long i = 0; i < items_per_thread; i++) {
+        while (mpmc_queue_push(mq, (int) (i & 0xffff))) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *mpmc_consumer(void *arg)
+{
+    (void) arg;
+    while (atomic_load_explicit(&remaining, memory_order_relaxed) > 0) {
+        if (mpmc_queue_pop(mq) == -1) {
+            sched_yield();
+            continue;
+        }
+        atomic_fetch_sub_explicit(&remaining, 1, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+static void *locked_producer(void *arg)
+{
+    (void) arg;
+    for (long i = 0; i < items_per_thread; i++) {
+        while (1) {
+            pthread_mutex_lock(&lock);
+            if (queue_size(lq) < capacity) {
+                queue_push(lq, (int) (i & 0xffff));
+                pthread_mutex_unlock(&lock);
+                break;
+            }
+            pthread_mutex_unlock(&lock);
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *locked_consumer(void *arg)
+{
+    (void) arg;
+    while (atomic_load_explicit(&remaining, memory_order_relaxed) > 0) {
+        pthread_mutex_lock(&lock);
+        int value = queue_pop(lq);
+        pthread_mutex_unlock(&lock);
+        if (value == -1) {
+            sched_yield();
+            continue;
+        }
+        atomic_fetch_sub_explicit(&remaining, 1, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+static double run(int threads, void *(*producer)(void *),
+                  void *(*consumer)(void *))
+{
+    pthread_t producers[MAX_THREADS];
+    pthread_t consumers[MAX_THREADS];
+
+    atomic_store(&remaining, items_per_thread * threads);
+    double start = now();
+
+    for (int i = 0; i < threads; i++) {
+        pthread_create(&consumers[i], NULL, consumer, NULL);
+        pthread_create(&producers[i], NULL, producer, NULL);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+    }
+
+    return now() - start;
+}
+
+static void report(const char *name, long items, double elapsed)
+{
+    printf("%-16s %12.2f %12.2f\n", name,
+           elapsed * 1e9 / (double) items, (double) items / elapsed / 1e6);
+}
+
+int main(int argc, char *argv[])
+{
+    int threads = DEFAULT_THREADS;
+    long items = DEFAULT_ITEMS;
+
+    if (argc > 1) {
+        threads = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        items = atol(argv[2]);
+    }
+    if (argc > 3) {
+        capacity = (size_t) atol(argv[3]);
+    }
+    if (threads <= 0 || threads > MAX_THREADS || items <= 0 || capacity == 0) {
+        fprintf(stderr, "usage: %s [threads] [items] [capacity]\n", argv[0]);
+        return 1;
+    }
+
+    items_per_thread = items / threads;
+    items = items_per_thread * threads;
+
+    mq = mpmc_queue_init(capacity);
+    lq = queue_init(capacity);
+    if (mq == NULL || lq == NULL) {
+        mpmc_queue_cleanup(mq);
+        queue_cleanup(lq);
+        return 1;
+    }
+
+    printf("threads %d+%d, items %ld, capacity %zu\n",
+           threads, threads, items, capacity);
+    printf("%-16s %12s %12s\n", "queue", "ns/item", "Mitems/s");
+    report("mpmc_queue", items, run(threads, mpmc_producer, mpmc_consumer));
+    mpmc_queue_stats(mq);
+    report("queue+mutex", items, run(threads, locked_producer, locked_consumer));
+    queue_stats(lq);
+
+    mpmc_queue_cleanup(mq);
+    queue_cleanup(lq);
+    return 0;
+}
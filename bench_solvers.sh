@@ -0,0 +1,219 @@
+#! /usr/bin/env bash
+
+# Benchmarks maze solvers on generated mazes of several sizes and topologies.
+#
+# usage: bench_solvers.sh [-g generator] [-o results] [-b baseline]
+#                         [-j containers] [-v revision] [-n sizes]
+#                         [-t topologies] [-r rounds] [-x percent] solver...
+#
+# Every solver runs with -q -s on every maze, 'rounds' times, and the run
+# with the fastest solve is kept. A solver may be given with options, for
+# example "./maze_solver_dfs -p 4". The first solver with "bfs" in its name
+# is the reference: solvers that search for a shortest path must report the
+# same length, solvers with "dfs" in their name must find a path exactly
+# when it does, of the same length on the perfect mazes. Any mismatch makes
+# the script exit with 1. Solvers given -p only explore what is reachable
+# and report no path, so only their timings and memory are recorded.
+#
+# Results are appended as CSV lines to 'results' and the statistics of the
+# containers as JSON lines to 'containers'. If a 'baseline' results file is
+# given, the solve time of each run is compared with its last run there, and
+# runs that are more than 'percent' slower are marked SLOWER.
+
+set -uo pipefail
+
+generator=./maze_gen
+results=
+baseline=
+containers=
+revision=unknown
+sizes="101 501 1001"
+topologies="backtracker prim braid rooms impossible"
+rounds=3
+threshold=10
+seed=1
+
+usage() {
+    echo "usage: $0 [-g generator] [-o results] [-b baseline]" \
+         "[-j containers] [-v revision] [-n sizes] [-t topologies]" \
+         "[-r rounds] [-x percent] solver..." >&2
+    exit 1
+}
+
+while getopts "g:o:b:j:v:n:t:r:x:" opt; do
+    case $opt in
+        g) generator=$OPTARG ;;
+        o) results=$OPTARG ;;
+        b) baseline=$OPTARG ;;
+        j) containers=$OPTARG ;;
+        v) revision=$OPTARG ;;
+        n) sizes=$OPTARG ;;
+        t) topologies=$OPTARG ;;
+        r) rounds=$OPTARG ;;
+        x) threshold=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -eq 0 ]; then
+    set -- ./maze_solver_bfs ./maze_solver_dfs
+fi
+if [ -n "$results" ] && [ -z "$containers" ]; then
+    containers="${results%.csv}_containers.jsonl"
+fi
+
+# The solvers write out.ppm to the working directory, so they run in here.
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# Make the program in a solver spec absolute, keeping its options.
+absolute() {
+    local program=${1%% *}
+    local options=
+    if [ "$program" != "$1" ]; then
+        options=" ${1#* }"
+    fi
+    echo "$(cd "$(dirname "$program")" && pwd)/$(basename "$program")$options"
+}
+
+reference=
+for solver in "$@"; do
+    case ${solver%% *} in
+        *bfs*) reference=$solver; break ;;
+    esac
+done
+if [ -z "$reference" ]; then
+    echo "$0: no bfs solver to check the path lengths against" >&2
+    exit 1
+fi
+
+header="revision,solver,topology,size,path,parse_s,solve_s,render_s,maxrss_kb,expanded,push,max,peak_bytes,extra_bytes"
+if [ -n "$results" ] && [ ! -s "$results" ]; then
+    echo "$header" > "$results"
+fi
+
+# Print the fields of a report line, in the order of the CSV columns.
+report_fields() {
+    awk '/^report / {
+        for (i = 2; i <= NF; i++) {
+            split($i, kv, "=")
+            v[kv[1]] = kv[2]
+        }
+        print v["path"], v["parse"], v["solve"], v["render"], v["maxrss_kb"],
+              v["expanded"], v["push"], v["max"], v["peak_bytes"],
+              v["extra_bytes"]
+    }' "$1"
+}
+
+# Run 'solver' on 'maze' 'rounds' times. Leave the report of the fastest
+# solve in $tmp/best.
+run_solver() {
+    local command maze=$2 best=
+    command=$(absolute "$1")
+    for ((round = 0; round < rounds; round++)); do
+        (cd "$tmp" && $command -q -s < "$maze" > /dev/null 2> "$tmp/report")
+        local solve
+        solve=$(report_fields "$tmp/report" | awk '{ print $3 }')
+        if [ -z "$solve" ]; then
+            echo "" > "$tmp/best"
+            return
+        fi
+        if [ -z "$best" ] || awk -v a="$solve" -v b="$best" \
+                'BEGIN { exit !(a < b) }'; then
+            best=$solve
+            cp "$tmp/report" "$tmp/best"
+        fi
+    done
+}
+
+# The solve time of the last run of 'solver' 'topology' 'size' in the
+# baseline, or nothing.
+baseline_solve() {
+    [ -n "$baseline" ] && [ -f "$baseline" ] || return 0
+    awk -F, -v s="$1" -v t="$2" -v n="$3" \
+        '$2 == s && $3 == t && $4 == n { found = $7 } END { print found }' \
+        "$baseline"
+}
+
+printf "%-28s %-12s %6s %8s %10s %10s %10s %9s\n" solver topology size path \
+       "solve ms" "maxrss kb" expanded change
+failed=0
+
+for topology in $topologies; do
+    for size in $sizes; do
+        maze="$tmp/maze_${topology}_$size.txt"
+        if ! "$generator" -a "$topology" -s "$seed" -o "$maze" "$size"; then
+            echo "$0: could not generate a $topology maze of size $size" >&2
+            exit 1
+        fi
+
+        run_solver "$reference" "$maze"
+        expected=$(report_fields "$tmp/best" | awk '{ print $1 }')
+
+        for solver in "$@"; do
+            label=$(basename "$solver")
+            run_solver "$solver" "$maze"
+            read -r path parse solve render maxrss expanded push max \
+                peak_bytes extra_bytes < <(report_fields "$tmp/best")
+            if [ -z "${path:-}" ]; then
+                echo "FAILED: $label did not report on $topology $size"
+                failed=1
+                continue
+            fi
+
+            check=
+            kind=${solver%% *}
+            case " $solver " in
+                *" -p "*) kind=reachability ;;
+            esac
+            case $kind in
+                reachability)
+                    ;;
+                *dfs*)
+                    if [ "$expected" -eq -1 ]; then
+                        [ "$path" -ne -1 ] && check=mismatch
+                    elif [ "$path" -eq -1 ] || [ "$path" -lt "$expected" ]; then
+                        check=mismatch
+                    fi
+                    case $topology in
+                        backtracker|prim|eller)
+                            [ "$path" -ne "$expected" ] && check=mismatch ;;
+                    esac
+                    ;;
+                *)
+                    [ "$path" -ne "$expected" ] && check=mismatch ;;
+            esac
+            if [ -n "$check" ]; then
+                echo "FAILED: $label found a path of length $path on" \
+                     "$topology $size, bfs found $expected"
+                failed=1
+            fi
+
+            change=$(baseline_solve "$label" "$topology" "$size" |
+                awk -v now="$solve" -v x="$threshold" '
+                    $1 > 0 {
+                        pct = (now - $1) / $1 * 100
+                        mark = (pct > x && now >= 0.001) ? " SLOWER" : ""
+                        printf "%+.1f%%%s", pct, mark
+                    }')
+
+            printf "%-28s %-12s %6s %8s %10.2f %10s %10s %9s\n" "$label" \
+                   "$topology" "$size" "$path" \
+                   "$(awk -v s="$solve" 'BEGIN { print s * 1000 }')" \
+                   "$maxrss" "$expanded" "$change"
+
+            if [ -n "$results" ]; then
+                echo "$revision,$label,$topology,$size,$path,$parse,$solve,$render,$maxrss,$expanded,$push,$max,$peak_bytes,$extra_bytes" \
+                    >> "$results"
+            fi
+            if [ -n "$containers" ]; then
+                grep '^{' "$tmp/best" |
+                    sed "s/^{/{\"revision\":\"$revision\",\"solver\":\"$label\",\"topology\":\"$topology\",\"size\":$size,/" \
+                    >> "$containers"
+            fi
+        done
+    done
+done
+
+exit $failed
@@ -0,0 +1,172 @@
+/*
+ * bench_spsc.c -- throughput benchmark for the single-producer/single-consumer
+ *                 queue
+ *
+ * Usage: bench_spsc [items] [capacity]
+ *
+ * One thread pushes 'items' integers and a second thread pops them. The same
+ * transfer is done through queue.c guarded by a mutex, which is what the
+ * pipeline used before, so both numbers are printed side by side.
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "queue.h"
+#include "spsc_queue.h"
+
+#define DEFAULT_ITEMS 10000000
+#define DEFAULT_CAPACITY 1024
+
+struct locked_queue {
+    pthread_mutex_t lock;
+    struct queue *q;
+    size_t capacity;
+};
+
+static long items = DEFAULT_ITEMS;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+static void *spsc_producer(void *arg)
+{
+    struct spsc_queue *q = arg;
+    for (long i = 0; i < items; i++) {
+        while (spsc_queue_push(q, (int) (i & 0xffff))) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *locked_producer(void *arg)
+{
+    struct locked_queue *lq = arg;
+    for (long i = 0; i < items; i++) {
+        while (1) {
+            pthread_mutex_lock(&lq->lock);
+            /* Keep the same bound as the ring so the comparison is fair. */
+            if (queue_size(lq->q) < lq->capacity) {
+                queue_push(lq->q, (int) (i & 0xffff));
+                pthread_mutex_unlock(&lq->lock);
+                break;
+            }
+            pthread_mutex_unlock(&lq->lock);
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static double bench_spsc(size_t capacity)
+{
+    struct spsc_queue *q = spsc_queue_init(capacity);
+    if (q == NULL) {
+        return -1;
+    }
+
+    pthread_t thread;
+    double start = now();
+    pthread_create(&thread, NULL, spsc_producer, q);
+
+    long sum = 0;
+    for (long i = 0; i < items; i++) {
+        int value;
+        while ((value = spsc_queue_pop(q)) == -1) {
+            sched_yield();
+        }
+        sum += value;
+    }
+
+    pthread_join(thread, NULL);
+    double elapsed = now() - start;
+
+    spsc_queue_stats(q);
+    spsc_queue_cleanup(q);
+    return sum < 0 ? -1 : elapsed;
+}
+
+static double bench_locked(size_t capacity)
+{
+    struct locked_queue lq;
+    lq.q = queue_init(capacity);
+    if (lq.q == NULL) {
+        return -1;
+    }
+    lq.capacity = capacity;
+    pthread_mutex_init(&lq.lock, NULL);
+
+    pthread_t thread;
+    double start = now();
+    pthread_create(&thread, NULL, locked_producer, &lq);
+
+    long sum = 0;
+    for (long i = 0; i < items; i++) {
+        int value;
+        while (1) {
+            pthread_mutex_lock(&lq.lock);
+            value = queue_pop(lq.q);
+            pthread_mutex_unlock(&lq.lock);
+            if (value != -1) {
+                break;
+            }
+            sched_yield();
+        }
+        sum += value;
+    }
+
+    pthread_join(thread, NULL);
+    double elapsed = now() - start;
+
+    queue_stats(lq.q);
+    pthread_mutex_destroy(&lq.lock);
+    queue_cleanup(lq.q);
+    return sum < 0 ? -1 : elapsed;
+}
+
+static void report(const char *name, double elapsed)
+{
+    if (elapsed < 0) {
+        printf("%-16s failed\n", name);
+        return;
+    }
+
+    printf("%-16s %12.2f %12.2f\n", name,
+           elapsed * 1e9 / (double) items, (double) items / elapsed / 1e6);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t capacity = DEFAULT_CAPACITY;
+
+    if (argc > 1) {
+        items = atol(argv[1]);
+    }
+    if (argc > 2) {
+        capacity = (size_t) atol(argv[2]);
+    }
+    if (items <= 0 || capacity == 0) {
+        fprintf(stderr, "usage: %s [items] [capacity]\n", argv[0]);
+        return 1;
+    }
+
+    printf("items %ld, capacity %zu\n", items, capacity);
+    printf("%-16s %12s %12s\n", "queue", "ns/item", "Mitems/s");
+    report("spsc_queue", bench_spsc(capacity));
+    report("queue+mutex", bench_locked(capacity));
+
+    return 0;
+}
@@ -0,0 +1,239 @@
+#include <check.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "allocator.h"
+#include "queue_ext.h"
+#include "stack_ext.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+#ifndef ck_assert_ptr_null
+#define ck_assert_ptr_null(X) _ck_assert_ptr(X, ==, NULL)
+#endif
+
+/* An allocator that counts the blocks it hands out and can be told to
+ * fail, to check that containers only allocate through their allocator. */
+struct counting {
+    int live;
+    int fail;
+};
+
+static void *counting_alloc(void *ctx, size_t size) {
+    struct counting *c = ctx;
+    if (c->fail) {
+        return NULL;
+    }
+    c->live++;
+    return malloc(size);
+}
+
+static void *counting_resize(void *ctx, void *ptr, size_t old_size,
+                             size_t new_size) {
+    struct counting *c = ctx;
+    (void) old_size;
+    if (c->fail) {
+        return NULL;
+    }
+    return realloc(ptr, new_size);
+}
+
+static void counting_release(void *ctx, void *ptr, size_t size) {
+    struct counting *c = ctx;
+    (void) size;
+    if (ptr != NULL) {
+        c->live--;
+    }
+    free(ptr);
+}
+
+START_TEST(test_arena_alignment) {
+    struct arena *a = arena_init(64);
+    const struct allocator *al = arena_allocator(a);
+    for (size_t size = 1; size < 200; size += 7) {
+        void *p = al->alloc(al->ctx, size);
+        ck_assert_ptr_nonnull(p);
+        ck_assert_int_eq((uintptr_t) p % _Alignof(max_align_t), 0);
+    }
+    arena_cleanup(a);
+}
+END_TEST
+
+START_TEST(test_arena_reset_reuses_chunks) {
+    struct arena *a = arena_init(1024);
+    const struct allocator *al = arena_allocator(a);
+
+    char *first = al->alloc(al->ctx, 100);
+    for (int i = 0; i < 100; i++) {
+        ck_assert_ptr_nonnull(al->alloc(al->ctx, 100));
+    }
+    size_t capacity = arena_capacity(a);
+    ck_assert(arena_used(a) >= 101 * 100);
+
+    arena_reset(a);
+    ck_assert_int_eq(arena_used(a), 0);
+
+    /* The same memory is handed out again, without new chunks. */
+    ck_assert_ptr_eq(al->alloc(al->ctx, 100), first);
+    for (int i = 0; i < 100; i++) {
+        ck_assert_ptr_nonnull(al->alloc(al->ctx, 100));
+    }
+    ck_assert_int_eq(arena_capacity(a), capacity);
+    arena_cleanup(a);
+}
+END_TEST
+
+START_TEST(test_arena_large_block) {
+    struct arena *a = arena_init(64);
+    const struct allocator *al = arena_allocator(a);
+    char *p = al->alloc(al->ctx, 10000);
+    ck_assert_ptr_nonnull(p);
+    p[9999] = 'x';
+    arena_cleanup(a);
+}
+END_TEST
+
+START_TEST(test_arena_resize_in_place) {
+    struct arena *a = arena_init(4096);
+    const struct allocator *al = arena_allocator(a);
+    int *p = al->alloc(al->ctx, 10 * sizeof(int));
+    for (int i = 0; i < 10; i++) {
+        p[i] = i;
+    }
+
+    int *q = al->resize(al->ctx, p, 10 * sizeof(int), 100 * sizeof(int));
+    ck_assert_ptr_eq(p, q);
+
+    /* Once something else was allocated the block has to move. */
+    al->alloc(al->ctx, 8);
+    q = al->resize(al->ctx, p, 100 * sizeof(int), 200 * sizeof(int));
+    ck_assert_ptr_ne(p, q);
+    for (int i = 0; i < 10; i++) {
+        ck_assert_int_eq(q[i], i);
+    }
+    arena_cleanup(a);
+}
+END_TEST
+
+START_TEST(test_stack_with_arena) {
+    struct arena *a = arena_init(256);
+
+    for (int round = 0; round < 3; round++) {
+        struct stack *s = stack_init_with_allocator(0, arena_allocator(a));
+        ck_assert_ptr_nonnull(s);
+        for (int i = 0; i < 1000; i++) {
+            ck_assert_int_eq(stack_push(s, i), 0);
+        }
+        for (int i = 999; i >= 0; i--) {
+            ck_assert_int_eq(stack_pop(s), i);
+        }
+        stack_cleanup(s);
+        arena_reset(a);
+    }
+    arena_cleanup(a);
+}
+END_TEST
+
+START_TEST(test_queue_with_arena) {
+    struct arena *a = arena_init(256);
+
+    for (int round = 0; round < 3; round++) {
+        struct queue *q = queue_init_with_allocator(0, arena_allocator(a));
+        struct queue *other = queue_init_with_allocator(4, arena_allocator(a));
+        ck_assert_ptr_nonnull(q);
+        ck_assert_ptr_nonnull(other);
+        for (int i = 0; i < 1000; i++) {
+            ck_assert_int_eq(queue_push(q, i), 0);
+            ck_assert_int_eq(queue_push(other, -i), 0);
+        }
+        for (int i = 0; i < 1000; i++) {
+            ck_assert_int_eq(queue_pop(q), i);
+            ck_assert_int_eq(queue_pop(other), -i);
+        }
+        arena_reset(a);
+    }
+    arena_cleanup(a);
+}
+END_TEST
+
+START_TEST(test_containers_use_allocator) {
+    struct counting c = { 0, 0 };
+    struct allocator al = { counting_alloc, counting_resize,
+                            counting_release, &c };
+
+    struct stack *s = stack_init_with_allocator(1, &al);
+    struct queue *q = queue_init_with_allocator(1, &al);
+    for (int i = 0; i < 100; i++) {
+        ck_assert_int_eq(stack_push(s, i), 0);
+        ck_assert_int_eq(queue_push(q, i), 0);
+    }
+    ck_assert(c.live > 0);
+
+    /* A failing allocator makes growth fail without losing items. */
+    c.fail = 1;
+    for (int i = 0; i < 1000 && stack_push(s, i) == 0; i++) {
+    }
+    ck_assert_int_eq(stack_push(s, 0), 1);
+    for (int i = 0; i < 1000 && queue_push(q, i) == 0; i++) {
+    }
+    ck_assert_int_eq(queue_push(q, 0), 1);
+    ck_assert_ptr_null(stack_init_with_allocator(1, &al));
+    ck_assert_ptr_null(queue_init_with_allocator(1, &al));
+    c.fail = 0;
+
+    ck_assert_int_eq(queue_pop(q), 0);
+    stack_cleanup(s);
+    queue_cleanup(q);
+    ck_assert_int_eq(c.live, 0);
+}
+END_TEST
+
+START_TEST(test_allocator_null) {
+    ck_assert_ptr_null(stack_init_with_allocator(10, NULL));
+    ck_assert_ptr_null(queue_init_with_allocator(10, NULL));
+    ck_assert_ptr_null(arena_allocator(NULL));
+    arena_reset(NULL);
+    arena_cleanup(NULL);
+}
+END_TEST
+
+Suite *allocator_suite(void) {
+    Suite *s;
+    TCase *tc_arena;
+    TCase *tc_containers;
+    s = suite_create("allocator");
+
+    tc_arena = tcase_create("Arena");
+    tcase_add_test(tc_arena, test_arena_alignment);
+    tcase_add_test(tc_arena, test_arena_reset_reuses_chunks);
+    tcase_add_test(tc_arena, test_arena_large_block);
+    tcase_add_test(tc_arena, test_arena_resize_in_place);
+
+    tc_containers = tcase_create("Containers");
+    tcase_add_test(tc_containers, test_stack_with_arena);
+    tcase_add_test(tc_containers, test_queue_with_arena);
+    tcase_add_test(tc_containers, test_containers_use_allocator);
+    tcase_add_test(tc_containers, test_allocator_null);
+
+    suite_add_tcase(s, tc_arena);
+    suite_add_tcase(s, tc_containers);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = allocator_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
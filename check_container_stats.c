@@ -0,0 +1,183 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "container_stats.h"
+#include "queue_ext.h"
+#include "stack_ext.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+
+/* Read everything written to 'fp' into 'buf'. */
+static void read_back(FILE *fp, char *buf, size_t size) {
+    rewind(fp);
+    size_t n = fread(buf, 1, size - 1, fp);
+    buf[n] = '\0';
+    fclose(fp);
+}
+
+static const struct container_stats example = {
+    .push = 1, .pop = 2, .max = 3, .resizes = 4, .bytes_copied = 5,
+    .capacity = 6, .peak_capacity = 7, .bytes = 8, .peak_bytes = 9,
+    .failed = 10, .empty_pops = 11,
+};
+
+START_TEST(test_stats_json) {
+    char buf[512];
+    FILE *fp = tmpfile();
+    ck_assert_ptr_nonnull(fp);
+
+    ck_assert_int_eq(container_stats_write_json(fp, "bfs \"r\"\n", &example), 0);
+    read_back(fp, buf, sizeof(buf));
+    ck_assert_str_eq(buf, "{\"name\":\"bfs \\\"r\\\"\\u000a\",\"push\":1,"
+                          "\"pop\":2,\"max\":3,\"resizes\":4,"
+                          "\"bytes_copied\":5,\"capacity\":6,"
+                          "\"peak_capacity\":7,\"bytes\":8,"
+                          "\"peak_bytes\":9,\"failed\":10,"
+                          "\"empty_pops\":11}\n");
+}
+END_TEST
+
+START_TEST(test_stats_csv) {
+    char buf[512];
+    FILE *fp = tmpfile();
+    ck_assert_ptr_nonnull(fp);
+
+    ck_assert_int_eq(container_stats_write_csv_header(fp), 0);
+    ck_assert_int_eq(container_stats_write_csv(fp, "a,\"b\"", &example), 0);
+    read_back(fp, buf, sizeof(buf));
+    ck_assert_str_eq(buf, "name,push,pop,max,resizes,bytes_copied,capacity,"
+                          "peak_capacity,bytes,peak_bytes,failed,empty_pops\n"
+                          "\"a,\"\"b\"\"\",1,2,3,4,5,6,7,8,9,10,11\n");
+}
+END_TEST
+
+START_TEST(test_stats_null) {
+    ck_assert_int_eq(container_stats_write_json(NULL, "x", &example), 1);
+    ck_assert_int_eq(container_stats_write_json(stderr, NULL, &example), 1);
+    ck_assert_int_eq(container_stats_write_json(stderr, "x", NULL), 1);
+    ck_assert_int_eq(container_stats_write_csv_header(NULL), 1);
+    ck_assert_int_eq(container_stats_write_csv(NULL, "x", &example), 1);
+    ck_assert_int_eq(container_stats_write_csv(stderr, "x", NULL), 1);
+}
+END_TEST
+
+START_TEST(test_stack_growth_stats) {
+    struct stack *s = stack_init(1);
+    struct container_stats stats;
+
+    /* Capacity goes 1, 3, 7, 15, 31. */
+    for (int i = 0; i < 20; i++) {
+        ck_assert_int_eq(stack_push(s, i), 0);
+    }
+    ck_assert_int_eq(stack_pop(s), 19);
+
+    ck_assert_int_eq(stack_get_stats(s, &stats), 0);
+    ck_assert_int_eq(stats.push, 20);
+    ck_assert_int_eq(stats.pop, 1);
+    ck_assert_int_eq(stats.max, 20);
+    ck_assert_int_eq(stats.resizes, 4);
+    ck_assert_int_eq(stats.capacity, 31);
+    ck_assert_int_eq(stats.peak_capacity, 31);
+    ck_assert_int_eq(stats.bytes, 31 * sizeof(int));
+    ck_assert_int_eq(stats.peak_bytes, 31 * sizeof(int));
+    ck_assert_int_le(stats.bytes_copied, (1 + 3 + 7 + 15) * sizeof(int));
+    ck_assert_int_eq(stats.failed, 0);
+    ck_assert_int_eq(stats.empty_pops, 0);
+    stack_cleanup(s);
+}
+END_TEST
+
+START_TEST(test_stack_inline_stats) {
+    struct stack_inline storage;
+    struct stack *s = stack_init_inline(&storage);
+    struct container_stats stats;
+
+    for (int i = 0; i <= STACK_INLINE_CAPACITY; i++) {
+        ck_assert_int_eq(stack_push(s, i), 0);
+    }
+    ck_assert_int_eq(stack_get_stats(s, &stats), 0);
+    ck_assert_int_eq(stats.resizes, 1);
+    ck_assert_int_eq(stats.bytes_copied, STACK_INLINE_CAPACITY * sizeof(int));
+    stack_cleanup(s);
+}
+END_TEST
+
+START_TEST(test_stack_failed_stats) {
+    struct stack *s = stack_init_mapped(2, false);
+    struct container_stats stats;
+
+    ck_assert_int_eq(stack_push(s, 1), 0);
+    ck_assert_int_eq(stack_push(s, 2), 0);
+    ck_assert_int_eq(stack_push(s, 3), 1);
+    ck_assert_int_eq(stack_pop(s), 2);
+    ck_assert_int_eq(stack_pop(s), 1);
+    ck_assert_int_eq(stack_pop(s), -1);
+
+    ck_assert_int_eq(stack_get_stats(s, &stats), 0);
+    ck_assert_int_eq(stats.push, 2);
+    ck_assert_int_eq(stats.failed, 1);
+    ck_assert_int_eq(stats.empty_pops, 1);
+    ck_assert_int_eq(stats.resizes, 0);
+    stack_cleanup(s);
+}
+END_TEST
+
+START_TEST(test_queue_growth_stats) {
+    struct queue *q = queue_init(1);
+    struct container_stats stats;
+
+    /* Every resize copies all items, which is 1 + 3 + 7 + 15 of them. */
+    for (int i = 0; i < 20; i++) {
+        ck_assert_int_eq(queue_push(q, i), 0);
+    }
+
+    ck_assert_int_eq(queue_get_stats(q, &stats), 0);
+    ck_assert_int_eq(stats.resizes, 4);
+    ck_assert_int_eq(stats.bytes_copied, (1 + 3 + 7 + 15) * sizeof(int));
+    ck_assert_int_eq(stats.capacity, 31);
+    ck_assert_int_eq(stats.peak_bytes, 31 * sizeof(int));
+    queue_cleanup(q);
+}
+END_TEST
+
+Suite *container_stats_suite(void) {
+    Suite *s;
+    TCase *tc_emit;
+    TCase *tc_containers;
+    s = suite_create("container stats");
+
+    tc_emit = tcase_create("Emit");
+    tcase_add_test(tc_emit, test_stats_json);
+    tcase_add_test(tc_emit, test_stats_csv);
+    tcase_add_test(tc_emit, test_stats_null);
+
+    tc_containers = tcase_create("Containers");
+    tcase_add_test(tc_containers, test_stack_growth_stats);
+    tcase_add_test(tc_containers, test_stack_inline_stats);
+    tcase_add_test(tc_containers, test_stack_failed_stats);
+    tcase_add_test(tc_containers, test_queue_growth_stats);
+
+    suite_add_tcase(s, tc_emit);
+    suite_add_tcase(s, tc_containers);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = container_stats_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,196 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "deque.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+#ifndef ck_assert_ptr_null
+#define ck_assert_ptr_null(X) _ck_assert_ptr(X, ==, NULL)
+#endif
+
+
+START_TEST(test_deque_init_cleanup) {
+    struct deque *d = deque_init(10);
+    ck_assert_ptr_nonnull(d);
+    ck_assert_int_eq(deque_empty(d), 1);
+    ck_assert_int_eq(deque_size(d), 0);
+    deque_cleanup(d);
+}
+END_TEST
+
+START_TEST(test_deque_queue_order) {
+    struct deque *d = deque_init(10);
+    ck_assert_int_eq(deque_push_back(d, 'x'), 0);
+    ck_assert_int_eq(deque_push_back(d, 'y'), 0);
+    ck_assert_int_eq(deque_push_back(d, 'z'), 0);
+
+    ck_assert_int_eq(deque_pop_front(d), 'x');
+    ck_assert_int_eq(deque_pop_front(d), 'y');
+    ck_assert_int_eq(deque_pop_front(d), 'z');
+
+    /* The same the other way around. */
+    ck_assert_int_eq(deque_push_front(d, 'x'), 0);
+    ck_assert_int_eq(deque_push_front(d, 'y'), 0);
+    ck_assert_int_eq(deque_pop_back(d), 'x');
+    ck_assert_int_eq(deque_pop_back(d), 'y');
+    ck_assert_int_eq(deque_empty(d), 1);
+    deque_cleanup(d);
+}
+END_TEST
+
+START_TEST(test_deque_stack_order) {
+    struct deque *d = deque_init(10);
+    ck_assert_int_eq(deque_push_front(d, 'x'), 0);
+    ck_assert_int_eq(deque_push_front(d, 'y'), 0);
+    ck_assert_int_eq(deque_pop_front(d), 'y');
+    ck_assert_int_eq(deque_pop_front(d), 'x');
+
+    ck_assert_int_eq(deque_push_back(d, 'x'), 0);
+    ck_assert_int_eq(deque_push_back(d, 'y'), 0);
+    ck_assert_int_eq(deque_pop_back(d), 'y');
+    ck_assert_int_eq(deque_pop_back(d), 'x');
+    deque_cleanup(d);
+}
+END_TEST
+
+START_TEST(test_deque_both_ends) {
+    struct deque *d = deque_init(4);
+    ck_assert_int_eq(deque_push_back(d, 2), 0);
+    ck_assert_int_eq(deque_push_front(d, 1), 0);
+    ck_assert_int_eq(deque_push_back(d, 3), 0);
+    ck_assert_int_eq(deque_push_front(d, 0), 0);
+
+    ck_assert_int_eq(deque_size(d), 4);
+    ck_assert_int_eq(deque_peek_front(d), 0);
+    ck_assert_int_eq(deque_peek_back(d), 3);
+    ck_assert_int_eq(deque_pop_front(d), 0);
+    ck_assert_int_eq(deque_pop_back(d), 3);
+    ck_assert_int_eq(deque_pop_front(d), 1);
+    ck_assert_int_eq(deque_pop_back(d), 2);
+    ck_assert_int_eq(deque_peek_front(d), -1);
+    ck_assert_int_eq(deque_peek_back(d), -1);
+    deque_cleanup(d);
+}
+END_TEST
+
+START_TEST(test_deque_grow) {
+    /* Fill the deque from both ends, so that the ring wraps around when
+     * it grows. */
+    struct deque *d = deque_init(3);
+    for (int i = 0; i < 100; i++) {
+        ck_assert_int_eq(deque_push_front(d, -i - 1), 0);
+        ck_assert_int_eq(deque_push_back(d, i), 0);
+    }
+    ck_assert_int_eq(deque_size(d), 200);
+
+    for (int i = 99; i >= 0; i--) {
+        ck_assert_int_eq(deque_pop_front(d), -i - 1);
+    }
+    for (int i = 0; i < 100; i++) {
+        ck_assert_int_eq(deque_pop_front(d), i);
+    }
+    ck_assert_int_eq(deque_empty(d), 1);
+    deque_cleanup(d);
+}
+END_TEST
+
+START_TEST(test_deque_zero_capacity) {
+    struct deque *d = deque_init(0);
+    ck_assert_ptr_nonnull(d);
+    ck_assert_int_eq(deque_push_front(d, 'x'), 0);
+    ck_assert_int_eq(deque_push_back(d, 'y'), 0);
+    ck_assert_int_eq(deque_pop_front(d), 'x');
+    ck_assert_int_eq(deque_pop_front(d), 'y');
+    deque_cleanup(d);
+}
+END_TEST
+
+START_TEST(test_deque_get_stats) {
+    struct deque *d = deque_init(2);
+    struct container_stats stats;
+
+    ck_assert_int_eq(deque_push_back(d, 1), 0);
+    ck_assert_int_eq(deque_push_front(d, 2), 0);
+    ck_assert_int_eq(deque_push_back(d, 3), 0);
+    ck_assert_int_eq(deque_pop_back(d), 3);
+    ck_assert_int_eq(deque_pop_front(d), 2);
+    ck_assert_int_eq(deque_pop_front(d), 1);
+    ck_assert_int_eq(deque_pop_back(d), -1);
+
+    ck_assert_int_eq(deque_get_stats(d, &stats), 0);
+    ck_assert_int_eq(stats.push, 3);
+    ck_assert_int_eq(stats.pop, 3);
+    ck_assert_int_eq(stats.max, 3);
+    ck_assert_int_eq(stats.resizes, 1);
+    ck_assert_int_eq(stats.bytes_copied, 2 * sizeof(int));
+    ck_assert_int_eq(stats.capacity, 5);
+    ck_assert_int_eq(stats.peak_capacity, 5);
+    ck_assert_int_eq(stats.bytes, 5 * sizeof(int));
+    ck_assert_int_eq(stats.peak_bytes, 5 * sizeof(int));
+    ck_assert_int_eq(stats.failed, 0);
+    ck_assert_int_eq(stats.empty_pops, 1);
+    deque_cleanup(d);
+}
+END_TEST
+
+START_TEST(test_deque_null_ptr) {
+    struct container_stats stats;
+    struct deque *d = deque_init(1);
+
+    deque_cleanup(NULL);
+    deque_stats(NULL);
+    ck_assert_int_eq(deque_get_stats(NULL, &stats), 1);
+    ck_assert_int_eq(deque_get_stats(d, NULL), 1);
+    ck_assert_int_eq(deque_push_front(NULL, 'x'), 1);
+    ck_assert_int_eq(deque_push_back(NULL, 'x'), 1);
+    ck_assert_int_eq(deque_pop_front(NULL), -1);
+    ck_assert_int_eq(deque_pop_back(NULL), -1);
+    ck_assert_int_eq(deque_peek_front(NULL), -1);
+    ck_assert_int_eq(deque_peek_back(NULL), -1);
+    ck_assert_int_eq(deque_empty(NULL), -1);
+    ck_assert_int_eq(deque_size(NULL), 0);
+    deque_cleanup(d);
+}
+END_TEST
+
+Suite *deque_suite(void) {
+    Suite *s;
+    TCase *tc_core;
+    TCase *tc_limits;
+    s = suite_create("deque");
+
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_deque_init_cleanup);
+    tcase_add_test(tc_core, test_deque_queue_order);
+    tcase_add_test(tc_core, test_deque_stack_order);
+    tcase_add_test(tc_core, test_deque_both_ends);
+    tcase_add_test(tc_core, test_deque_get_stats);
+
+    tc_limits = tcase_create("Limits");
+    tcase_add_test(tc_limits, test_deque_grow);
+    tcase_add_test(tc_limits, test_deque_zero_capacity);
+    tcase_add_test(tc_limits, test_deque_null_ptr);
+
+    suite_add_tcase(s, tc_core);
+    suite_add_tcase(s, tc_limits);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = deque_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,129 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "queue_ext.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+
+/* Built with tiny chunks, so this many items go through the file many
+ * times over. */
+#define ITEMS 100000
+
+START_TEST(test_extmem_fill_drain) {
+    struct queue *q = queue_init(1);
+    ck_assert_ptr_nonnull(q);
+
+    for (int i = 0; i < ITEMS; i++) {
+        ck_assert_int_eq(queue_push(q, i), 0);
+    }
+    ck_assert_int_eq(queue_size(q), ITEMS);
+    for (int i = 0; i < ITEMS; i++) {
+        ck_assert_int_eq(queue_peek(q), i);
+        ck_assert_int_eq(queue_pop(q), i);
+    }
+    ck_assert_int_eq(queue_empty(q), 1);
+    ck_assert_int_eq(queue_pop(q), -1);
+    queue_cleanup(q);
+}
+END_TEST
+
+START_TEST(test_extmem_interleaved) {
+    struct queue *q = queue_init(1);
+    int pushed = 0;
+    int popped = 0;
+
+    /* Grow in bursts and drain partially, like a BFS frontier does. */
+    for (int round = 0; round < 200; round++) {
+        for (int i = 0; i < round * 7 + 3; i++) {
+            ck_assert_int_eq(queue_push(q, pushed++), 0);
+        }
+        for (int i = 0; i < round * 5 + 1; i++) {
+            ck_assert_int_eq(queue_pop(q), popped++);
+        }
+        ck_assert_int_eq(queue_size(q), (size_t) (pushed - popped));
+    }
+    while (!queue_empty(q)) {
+        ck_assert_int_eq(queue_pop(q), popped++);
+    }
+    ck_assert_int_eq(popped, pushed);
+
+    /* Reuse after the file has been drained completely. */
+    for (int i = 0; i < ITEMS / 10; i++) {
+        ck_assert_int_eq(queue_push(q, i), 0);
+    }
+    for (int i = 0; i < ITEMS / 10; i++) {
+        ck_assert_int_eq(queue_pop(q), i);
+    }
+    queue_cleanup(q);
+}
+END_TEST
+
+START_TEST(test_extmem_cleanup_spilled) {
+    struct queue *q = queue_init(1);
+
+    for (int i = 0; i < ITEMS; i++) {
+        ck_assert_int_eq(queue_push(q, i), 0);
+    }
+    for (int i = 0; i < ITEMS / 3; i++) {
+        ck_assert_int_eq(queue_pop(q), i);
+    }
+    queue_cleanup(q);
+}
+END_TEST
+
+START_TEST(test_extmem_no_tmpdir) {
+    setenv("TMPDIR", "/nonexistent/queue_extmem", 1);
+    struct queue *q = queue_init(1);
+
+    /* Once the memory budget is used up the queue can't spill. */
+    int pushed = 0;
+    while (pushed < ITEMS && queue_push(q, pushed) == 0) {
+        pushed++;
+    }
+    ck_assert_int_lt(pushed, ITEMS);
+    ck_assert_int_eq(queue_size(q), (size_t) pushed);
+
+    /* Everything that was accepted is still there. */
+    for (int i = 0; i < pushed; i++) {
+        ck_assert_int_eq(queue_pop(q), i);
+    }
+    ck_assert_int_eq(queue_empty(q), 1);
+    queue_cleanup(q);
+}
+END_TEST
+
+Suite *extmem_suite(void) {
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("extmem");
+
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_extmem_fill_drain);
+    tcase_add_test(tc_core, test_extmem_interleaved);
+    tcase_add_test(tc_core, test_extmem_cleanup_spilled);
+    tcase_add_test(tc_core, test_extmem_no_tmpdir);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = extmem_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
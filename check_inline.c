@@ -0,0 +1,133 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "queue_ext.h"
+#include "stack_ext.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+#ifndef ck_assert_ptr_null
+#define ck_assert_ptr_null(X) _ck_assert_ptr(X, ==, NULL)
+#endif
+
+START_TEST(test_stack_inline_simple) {
+    struct stack_inline storage;
+    struct stack *s = stack_init_inline(&storage);
+    ck_assert_ptr_nonnull(s);
+
+    ck_assert_int_eq(stack_push(s, 'x'), 0);
+    ck_assert_int_eq(stack_push(s, 'y'), 0);
+    ck_assert_int_eq(stack_peek(s), 'y');
+    ck_assert_int_eq(stack_pop(s), 'y');
+    ck_assert_int_eq(stack_pop(s), 'x');
+    ck_assert_int_eq(stack_empty(s), 1);
+    stack_cleanup(s);
+}
+END_TEST
+
+START_TEST(test_stack_inline_spill) {
+    struct stack_inline storage;
+    struct stack *s = stack_init_inline(&storage);
+
+    for (int i = 0; i < STACK_INLINE_CAPACITY * 10; i++) {
+        ck_assert_int_eq(stack_push(s, i), 0);
+    }
+    for (int i = STACK_INLINE_CAPACITY * 10 - 1; i >= 0; i--) {
+        ck_assert_int_eq(stack_pop(s), i);
+    }
+    stack_cleanup(s);
+}
+END_TEST
+
+START_TEST(test_stack_inline_reuse) {
+    struct stack_inline storage;
+
+    for (int round = 0; round < 3; round++) {
+        struct stack *s = stack_init_inline(&storage);
+        for (int i = 0; i < STACK_INLINE_CAPACITY + round; i++) {
+            ck_assert_int_eq(stack_push(s, i), 0);
+        }
+        ck_assert_int_eq(stack_size(s), STACK_INLINE_CAPACITY + round);
+        stack_cleanup(s);
+    }
+}
+END_TEST
+
+START_TEST(test_queue_inline_simple) {
+    struct queue_inline storage;
+    struct queue *q = queue_init_inline(&storage);
+    ck_assert_ptr_nonnull(q);
+
+    ck_assert_int_eq(queue_push(q, 'x'), 0);
+    ck_assert_int_eq(queue_push(q, 'y'), 0);
+    ck_assert_int_eq(queue_peek(q), 'x');
+    ck_assert_int_eq(queue_pop(q), 'x');
+    ck_assert_int_eq(queue_pop(q), 'y');
+    ck_assert_int_eq(queue_empty(q), 1);
+    queue_cleanup(q);
+}
+END_TEST
+
+START_TEST(test_queue_inline_spill) {
+    struct queue_inline storage;
+    struct queue *q = queue_init_inline(&storage);
+
+    /* Wrap around inside the inline items before spilling. */
+    for (int i = 0; i < QUEUE_INLINE_CAPACITY / 2; i++) {
+        ck_assert_int_eq(queue_push(q, -1), 0);
+        ck_assert_int_eq(queue_pop(q), -1);
+    }
+    for (int i = 0; i < QUEUE_INLINE_CAPACITY * 10; i++) {
+        ck_assert_int_eq(queue_push(q, i), 0);
+    }
+    for (int i = 0; i < QUEUE_INLINE_CAPACITY * 10; i++) {
+        ck_assert_int_eq(queue_pop(q), i);
+    }
+    queue_cleanup(q);
+}
+END_TEST
+
+START_TEST(test_inline_null) {
+    ck_assert_ptr_null(stack_init_inline(NULL));
+    ck_assert_ptr_null(queue_init_inline(NULL));
+}
+END_TEST
+
+Suite *inline_suite(void) {
+    Suite *s;
+    TCase *tc_stack;
+    TCase *tc_queue;
+    s = suite_create("inline");
+
+    tc_stack = tcase_create("Stack");
+    tcase_add_test(tc_stack, test_stack_inline_simple);
+    tcase_add_test(tc_stack, test_stack_inline_spill);
+    tcase_add_test(tc_stack, test_stack_inline_reuse);
+
+    tc_queue = tcase_create("Queue");
+    tcase_add_test(tc_queue, test_queue_inline_simple);
+    tcase_add_test(tc_queue, test_queue_inline_spill);
+    tcase_add_test(tc_queue, test_inline_null);
+
+    suite_add_tcase(s, tc_stack);
+    suite_add_tcase(s, tc_queue);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = inline_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
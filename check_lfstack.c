@@ -0,0 +1,166 @@
+#include <check.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lfstack.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+#ifndef ck_assert_ptr_null
+#define ck_assert_ptr_null(X) _ck_assert_ptr(X, ==, NULL)
+#endif
+
+#define THREADS 4
+#define POOL_ITEMS 64
+#define ROUNDS 200000
+
+START_TEST(test_lfstack_init_cleanup) {
+    struct lfstack *s = lfstack_init(10);
+    ck_assert_ptr_nonnull(s);
+    lfstack_cleanup(s);
+}
+END_TEST
+
+START_TEST(test_lfstack_order) {
+    struct lfstack *s = lfstack_init(10);
+    ck_assert_int_eq(lfstack_empty(s), 1);
+    ck_assert_int_eq(lfstack_push(s, 'x'), 0);
+    ck_assert_int_eq(lfstack_push(s, 'y'), 0);
+    ck_assert_int_eq(lfstack_push(s, 'z'), 0);
+    ck_assert_int_eq(lfstack_size(s), 3);
+
+    ck_assert_int_eq(lfstack_peek(s), 'z');
+    ck_assert_int_eq(lfstack_pop(s), 'z');
+    ck_assert_int_eq(lfstack_pop(s), 'y');
+    ck_assert_int_eq(lfstack_push(s, 'a'), 0);
+    ck_assert_int_eq(lfstack_pop(s), 'a');
+    ck_assert_int_eq(lfstack_pop(s), 'x');
+    ck_assert_int_eq(lfstack_empty(s), 1);
+    lfstack_cleanup(s);
+}
+END_TEST
+
+START_TEST(test_lfstack_full) {
+    struct lfstack *s = lfstack_init(5);
+    for (int i = 0; i < 5; i++) {
+        ck_assert_int_eq(lfstack_push(s, i), 0);
+    }
+    ck_assert_int_eq(lfstack_push(s, 5), 1);
+
+    for (int i = 4; i >= 0; i--) {
+        ck_assert_int_eq(lfstack_pop(s), i);
+    }
+    ck_assert_int_eq(lfstack_pop(s), -1);
+    ck_assert_int_eq(lfstack_peek(s), -1);
+    lfstack_cleanup(s);
+}
+END_TEST
+
+START_TEST(test_lfstack_zero_capacity) {
+    struct lfstack *s = lfstack_init(0);
+    ck_assert_ptr_nonnull(s);
+    ck_assert_int_eq(lfstack_push(s, 1), 1);
+    ck_assert_int_eq(lfstack_pop(s), -1);
+    lfstack_cleanup(s);
+}
+END_TEST
+
+static struct lfstack *shared;
+
+/* Use the stack as a free list: take an item, then give it back. */
+static void *worker(void *arg) {
+    (void) arg;
+    for (int i = 0; i < ROUNDS; i++) {
+        int item = lfstack_pop(shared);
+        if (item == -1) {
+            sched_yield();
+            continue;
+        }
+        while (lfstack_push(shared, item)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+START_TEST(test_lfstack_threads) {
+    pthread_t threads[THREADS];
+    int seen[POOL_ITEMS] = { 0 };
+
+    shared = lfstack_init(POOL_ITEMS);
+    for (int i = 0; i < POOL_ITEMS; i++) {
+        ck_assert_int_eq(lfstack_push(shared, i), 0);
+    }
+
+    for (int i = 0; i < THREADS; i++) {
+        ck_assert_int_eq(pthread_create(&threads[i], NULL, worker, NULL), 0);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    /* No item may be lost or duplicated. */
+    ck_assert_int_eq(lfstack_size(shared), POOL_ITEMS);
+    for (int i = 0; i < POOL_ITEMS; i++) {
+        int item = lfstack_pop(shared);
+        ck_assert(item >= 0 && item < POOL_ITEMS);
+        seen[item]++;
+    }
+    for (int i = 0; i < POOL_ITEMS; i++) {
+        ck_assert_int_eq(seen[i], 1);
+    }
+    ck_assert_int_eq(lfstack_empty(shared), 1);
+    lfstack_cleanup(shared);
+}
+END_TEST
+
+START_TEST(test_lfstack_null_ptr) {
+    lfstack_cleanup(NULL);
+    lfstack_stats(NULL);
+    ck_assert_int_eq(lfstack_push(NULL, 'x'), 1);
+    ck_assert_int_eq(lfstack_pop(NULL), -1);
+    ck_assert_int_eq(lfstack_peek(NULL), -1);
+    ck_assert_int_eq(lfstack_empty(NULL), -1);
+}
+END_TEST
+
+Suite *lfstack_suite(void) {
+    Suite *s;
+    TCase *tc_core;
+    TCase *tc_threads;
+    s = suite_create("lock-free stack");
+
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_lfstack_init_cleanup);
+    tcase_add_test(tc_core, test_lfstack_order);
+    tcase_add_test(tc_core, test_lfstack_full);
+    tcase_add_test(tc_core, test_lfstack_zero_capacity);
+    tcase_add_test(tc_core, test_lfstack_null_ptr);
+
+    tc_threads = tcase_create("Threads");
+    tcase_set_timeout(tc_threads, 30);
+    tcase_add_test(tc_threads, test_lfstack_threads);
+
+    suite_add_tcase(s, tc_core);
+    suite_add_tcase(s, tc_threads);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = lfstack_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
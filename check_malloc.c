@@ -6,8 +6,9 @@
 #include <stdlib.h>
 #include <time.h>
 
-#include "stack.h"
-#include "queue.h"
+#include "allocator.h"
+#include "stack_ext.h"
+#include "queue_ext.h"
 
 // For older versions of the check library
 #ifndef ck_assert_ptr_nonnull
@@ -195,6 +196,129 @@ START_TEST(test_queue_init_no_malloc) {
 }
 END_TEST
 
+START_TEST(test_stack_init_with_allocator_no_malloc) {
+    struct stack *s = NULL;
+
+    enable_malloc_failing();
+
+    MALLOC_LOOP(s, stack_init_with_allocator(5, &malloc_allocator), NULL);
+
+    restore_malloc();
+
+    if (stack_push(s, 10))
+        ck_assert(0);
+
+    if (stack_pop(s) != 10)
+        ck_assert(0);
+
+    stack_cleanup(s);
+    exit(exit_code);
+}
+END_TEST
+
+START_TEST(test_queue_init_with_allocator_no_malloc) {
+    struct queue *q = NULL;
+
+    enable_malloc_failing();
+
+    MALLOC_LOOP(q, queue_init_with_allocator(5, &malloc_allocator), NULL);
+
+    restore_malloc();
+
+    if (queue_push(q, 10))
+        ck_assert(0);
+
+    if (queue_pop(q) != 10)
+        ck_assert(0);
+
+    queue_cleanup(q);
+    exit(exit_code);
+}
+END_TEST
+
+START_TEST(test_arena_init_no_malloc) {
+    struct arena *a = NULL;
+
+    enable_malloc_failing();
+
+    MALLOC_LOOP(a, arena_init(64), NULL);
+
+    restore_malloc();
+
+    struct stack *s = stack_init_with_allocator(5, arena_allocator(a));
+    if (s == NULL)
+        ck_assert(0);
+
+    if (stack_push(s, 10))
+        ck_assert(0);
+
+    if (stack_pop(s) != 10)
+        ck_assert(0);
+
+    stack_cleanup(s);
+    arena_cleanup(a);
+    exit(exit_code);
+}
+END_TEST
+
+START_TEST(test_stack_init_inline_no_malloc) {
+    struct stack_inline storage;
+
+    enable_malloc_failing();
+
+    /* Small stacks must not allocate at all. */
+    struct stack *s = stack_init_inline(&storage);
+    if (s == NULL)
+        ck_assert(0);
+
+    for (int i = 0; i < STACK_INLINE_CAPACITY; i++) {
+        if (stack_push(s, i))
+            ck_assert(0);
+    }
+
+    /* Spilling to the heap fails, but the stack stays intact. */
+    if (stack_push(s, STACK_INLINE_CAPACITY) != 1)
+        ck_assert(0);
+
+    restore_malloc();
+
+    if (stack_pop(s) != STACK_INLINE_CAPACITY - 1)
+        ck_assert(0);
+
+    stack_cleanup(s);
+    exit(exit_code);
+}
+END_TEST
+
+START_TEST(test_queue_init_inline_no_malloc) {
+    struct queue_inline storage;
+
+    enable_malloc_failing();
+
+    /* Small queues must not allocate at all. */
+    struct queue *q = queue_init_inline(&storage);
+    if (q == NULL)
+        ck_assert(0);
+
+    for (int i = 0; i < QUEUE_INLINE_CAPACITY; i++) {
+        if (queue_push(q, i))
+            ck_assert(0);
+    }
+
+    /* Spilling to the heap fails, but the queue stays intact. */
+    if (queue_push(q, QUEUE_INLINE_CAPACITY) != 1)
+        ck_assert(0);
+
+    restore_malloc();
+
+    if (queue_pop(q) != 0)
+        ck_assert(0);
+
+    queue_cleanup(q);
+    exit(exit_code);
+}
+END_TEST
+
 Suite *heap_suite(void) {
     Suite *s;
     TCase *tc_core;
@@ -206,6 +330,13 @@ Suite *heap_suite(void) {
     /* Regular tests. */
     tcase_add_exit_test(tc_core, test_stack_init_no_malloc, exit_code);
     tcase_add_exit_test(tc_core, test_queue_init_no_malloc, exit_code);
+    tcase_add_exit_test(tc_core, test_stack_init_with_allocator_no_malloc,
+                        exit_code);
+    tcase_add_exit_test(tc_core, test_queue_init_with_allocator_no_malloc,
+                        exit_code);
+    tcase_add_exit_test(tc_core, test_arena_init_no_malloc, exit_code);
+    tcase_add_exit_test(tc_core, test_stack_init_inline_no_malloc, exit_code);
+    tcase_add_exit_test(tc_core, test_queue_init_inline_no_malloc, exit_code);
 
     suite_add_tcase(s, tc_core);
     return s;
@@ -0,0 +1,277 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <check.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "maze_cache.h"
+#include "maze_render.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+#ifndef ck_assert_ptr_null
+#define ck_assert_ptr_null(X) _ck_assert_ptr(X, ==, NULL)
+#endif
+
+#define N 40
+
+#define CACHE "check_maze_cache.cache"
+
+/* The character at (r, c) of the generated maze, with a wall in column
+ * 'wall' unless it is 0. */
+static char expected(int r, int c, int wall) {
+    if (r == 3 && c == 1) {
+        return 'S';
+    }
+    if (r == N - 2 && c == N - 4) {
+        return 'D';
+    }
+    if (r == 0 || c == 0 || r == N - 1 || c == N - 1 || c == wall) {
+        return WALL;
+    }
+    return (r * 7 + c * 13) % 5 == 0 ? WALL : FLOOR;
+}
+
+/* Return a file holding the generated maze, at its start. */
+static FILE *maze_file(int wall) {
+    FILE *fp = tmpfile();
+    ck_assert_ptr_nonnull(fp);
+    for (int r = 0; r < N; r++) {
+        for (int c = 0; c < N; c++) {
+            fputc(expected(r, c, wall), fp);
+        }
+        fputc('\n', fp);
+    }
+    rewind(fp);
+    return fp;
+}
+
+/* Read the generated maze from stdin. */
+static struct maze *read_maze(int wall) {
+    FILE *fp = maze_file(wall);
+    ck_assert_int_ne(dup2(fileno(fp), 0), -1);
+    fclose(fp);
+    clearerr(stdin);
+
+    struct maze *m = maze_read();
+    ck_assert_ptr_nonnull(m);
+    return m;
+}
+
+/* Compute the distance field to the destination of 'm' into 'field'. */
+static void compute(struct maze_distance *field, const struct maze *m) {
+    int r, c;
+    maze_destination(m, &r, &c);
+    int destination = maze_index(m, r, c);
+    ck_assert_int_eq(maze_distance_compute(field, m, &destination, 1), 0);
+}
+
+/* Return whether the streams 'a' and 'b' hold the same bytes. */
+static bool same(FILE *a, FILE *b) {
+    rewind(a);
+    rewind(b);
+    int ca, cb;
+    do {
+        ca = getc(a);
+        cb = getc(b);
+    } while (ca == cb && ca != EOF);
+    return ca == cb;
+}
+
+START_TEST(test_cache_key_file) {
+    FILE *a = maze_file(0);
+    FILE *b = maze_file(0);
+    FILE *c = maze_file(20);
+    uint64_t ka, kb, kc;
+
+    ck_assert_int_eq(maze_cache_key_file(a, &ka), 0);
+    ck_assert_int_eq(maze_cache_key_file(b, &kb), 0);
+    ck_assert_int_eq(maze_cache_key_file(c, &kc), 0);
+    ck_assert(ka == kb);
+    ck_assert(ka != kc);
+
+    /* Taking the key reads nothing from the stream. */
+    ck_assert_int_eq(getc(a), WALL);
+
+    /* Once the stream has buffered the file, its offset is unknown. */
+    ck_assert_int_eq(maze_cache_key_file(a, &ka), 1);
+
+    /* Only what is left of the file counts. */
+    ck_assert_int_eq(fseek(b, N + 1, SEEK_SET), 0);
+    ck_assert_int_eq(maze_cache_key_file(b, &kb), 0);
+    ck_assert(ka != kb);
+
+    fclose(a);
+    fclose(b);
+    fclose(c);
+
+    /* A pipe cannot be keyed. */
+    int fds[2];
+    ck_assert_int_eq(pipe(fds), 0);
+    FILE *p = fdopen(fds[0], "r");
+    ck_assert_ptr_nonnull(p);
+    ck_assert_int_eq(maze_cache_key_file(p, &ka), 1);
+    fclose(p);
+    close(fds[1]);
+}
+END_TEST
+
+START_TEST(test_cache_save_load) {
+    struct maze *m = read_maze(0);
+    struct maze_distance field;
+    struct maze_cache cache;
+    uint64_t key = 12345;
+
+    compute(&field, m);
+    ck_assert_int_eq(maze_cache_save(m, &field, CACHE, key), 0);
+    ck_assert_int_eq(maze_cache_load(&cache, CACHE, key + 1), 1);
+    ck_assert_int_eq(maze_cache_load(&cache, CACHE, key), 0);
+    ck_assert_ptr_nonnull(cache.map);
+    ck_assert_int_eq(cache.n, N);
+    ck_assert_int_eq(cache.start, 3 * N + 1);
+    ck_assert_int_eq(cache.finish, (N - 2) * N + N - 4);
+    ck_assert_int_eq(cache.field.reached, field.reached);
+    for (int r = 0; r < N; r++) {
+        for (int c = 0; c < N; c++) {
+            ck_assert_int_eq(cache.cells[r * N + c],
+                             expected(r, c, 0) == WALL ? WALL : FLOOR);
+            ck_assert_int_eq(maze_distance_get(&cache.field, r * N + c),
+                             maze_distance_get(&field, r * N + c));
+        }
+    }
+
+    maze_cache_cleanup(&cache);
+    ck_assert_ptr_null(cache.map);
+    maze_cache_cleanup(&cache);
+    maze_distance_cleanup(&field);
+
+    /* A truncated file is rejected. */
+    ck_assert_int_eq(truncate(CACHE, 100), 0);
+    ck_assert_int_eq(maze_cache_load(&cache, CACHE, key), 1);
+    remove(CACHE);
+    ck_assert_int_eq(maze_cache_load(&cache, CACHE, key), 1);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_cache_render) {
+    struct maze *m = read_maze(0);
+    struct maze_distance field;
+    struct maze_cache cache;
+    char cells[N * N];
+
+    compute(&field, m);
+    ck_assert_int_eq(maze_cache_save(m, &field, CACHE, 1), 0);
+    ck_assert_int_eq(maze_cache_load(&cache, CACHE, 1), 0);
+    remove(CACHE);
+
+    /* The cached path and text are those of the maze itself. */
+    int length = maze_cache_descend(&cache, cells);
+    ck_assert_int_gt(length, 0);
+    ck_assert_int_eq(maze_distance_descend(&field, m, 3, 1), length);
+
+    FILE *ours = tmpfile();
+    FILE *theirs = tmpfile();
+    ck_assert_ptr_nonnull(ours);
+    ck_assert_ptr_nonnull(theirs);
+    ck_assert_int_eq(maze_cache_render_text(&cache, cells, ours), 0);
+    ck_assert_int_eq(maze_render_text(m, theirs, false, 1), 0);
+    ck_assert(same(ours, theirs));
+    fclose(ours);
+    fclose(theirs);
+
+    maze_cache_cleanup(&cache);
+    maze_distance_cleanup(&field);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_cache_unreachable) {
+    struct maze *m = read_maze(20);
+    struct maze_distance field;
+    struct maze_cache cache;
+    char cells[N * N];
+
+    /* The wall in column 20 cuts the start off from the destination. */
+    compute(&field, m);
+    ck_assert_int_eq(maze_cache_save(m, &field, CACHE, 2), 0);
+    ck_assert_int_eq(maze_cache_load(&cache, CACHE, 2), 0);
+    remove(CACHE);
+    ck_assert_int_eq(maze_cache_descend(&cache, cells),
+                     MAZE_DISTANCE_UNREACHABLE);
+
+    maze_cache_cleanup(&cache);
+    maze_distance_cleanup(&field);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_cache_null) {
+    struct maze *m = read_maze(0);
+    struct maze_distance field;
+    struct maze_cache cache;
+    char cells[N * N];
+    uint64_t key;
+
+    compute(&field, m);
+    ck_assert_int_eq(maze_cache_key_file(NULL, &key), 1);
+    ck_assert_int_eq(maze_cache_key_file(stdin, NULL), 1);
+    ck_assert_int_eq(maze_cache_save(NULL, &field, CACHE, 0), 1);
+    ck_assert_int_eq(maze_cache_save(m, NULL, CACHE, 0), 1);
+    ck_assert_int_eq(maze_cache_save(m, &field, NULL, 0), 1);
+    ck_assert_int_eq(maze_cache_load(NULL, CACHE, 0), 1);
+    ck_assert_int_eq(maze_cache_load(&cache, NULL, 0), 1);
+    ck_assert_int_eq(maze_cache_descend(NULL, cells),
+                     MAZE_DISTANCE_UNREACHABLE);
+    ck_assert_int_eq(maze_cache_render_text(NULL, cells, stdout), 1);
+    maze_cache_cleanup(NULL);
+
+    ck_assert_int_eq(maze_cache_save(m, &field, CACHE, 0), 0);
+    ck_assert_int_eq(maze_cache_load(&cache, CACHE, 0), 0);
+    remove(CACHE);
+    ck_assert_int_eq(maze_cache_descend(&cache, NULL),
+                     MAZE_DISTANCE_UNREACHABLE);
+    ck_assert_int_eq(maze_cache_render_text(&cache, NULL, stdout), 1);
+    ck_assert_int_eq(maze_cache_render_text(&cache, cells, NULL), 1);
+
+    maze_cache_cleanup(&cache);
+    maze_distance_cleanup(&field);
+    maze_cleanup(m);
+}
+END_TEST
+
+Suite *maze_cache_suite(void) {
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("maze cache");
+
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_cache_key_file);
+    tcase_add_test(tc_core, test_cache_save_load);
+    tcase_add_test(tc_core, test_cache_render);
+    tcase_add_test(tc_core, test_cache_unreachable);
+    tcase_add_test(tc_core, test_cache_null);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = maze_cache_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
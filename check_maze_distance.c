@@ -0,0 +1,289 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <check.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "maze_distance.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+#ifndef ck_assert_ptr_null
+#define ck_assert_ptr_null(X) _ck_assert_ptr(X, ==, NULL)
+#endif
+
+#define N 40
+
+#define FIELD "check_maze_distance.field"
+
+/* The character at (r, c) of the generated maze. Column 20 is a wall, so
+ * the right half can only be reached from a source there. */
+static char expected(int r, int c) {
+    if (r == 1 && c == 1) {
+        return 'S';
+    }
+    if (r == N - 2 && c == N - 2) {
+        return 'D';
+    }
+    if (r == 0 || c == 0 || r == N - 1 || c == N - 1 || c == 20) {
+        return WALL;
+    }
+    return (r * 7 + c * 13) % 5 == 0 ? WALL : FLOOR;
+}
+
+/* Read the generated maze from stdin. */
+static struct maze *read_maze(void) {
+    FILE *fp = tmpfile();
+    ck_assert_ptr_nonnull(fp);
+    for (int r = 0; r < N; r++) {
+        for (int c = 0; c < N; c++) {
+            fputc(expected(r, c), fp);
+        }
+        fputc('\n', fp);
+    }
+    rewind(fp);
+    ck_assert_int_ne(dup2(fileno(fp), 0), -1);
+    fclose(fp);
+    clearerr(stdin);
+
+    struct maze *m = maze_read();
+    ck_assert_ptr_nonnull(m);
+    return m;
+}
+
+/* Fill 'dist' with the distances from the cell 'source' with a plain
+ * breadth-first search on maze_get(). */
+static void reference(const struct maze *m, int source, int *dist) {
+    int queue[N * N];
+    int head = 0;
+    int tail = 0;
+
+    for (int i = 0; i < N * N; i++) {
+        dist[i] = MAZE_DISTANCE_UNREACHABLE;
+    }
+    dist[source] = 0;
+    queue[tail++] = source;
+    while (head < tail) {
+        int cell = queue[head++];
+        for (int d = 0; d < N_MOVES; d++) {
+            int r = cell / N + m_offsets[d][0];
+            int c = cell % N + m_offsets[d][1];
+            if (r < 1 || c < 1 || r > N - 2 || c > N - 2
+                || maze_get(m, r, c) == WALL
+                || dist[r * N + c] != MAZE_DISTANCE_UNREACHABLE) {
+                continue;
+            }
+            dist[r * N + c] = dist[cell] + 1;
+            queue[tail++] = r * N + c;
+        }
+    }
+}
+
+START_TEST(test_distance_single) {
+    struct maze *m = read_maze();
+    struct maze_distance field;
+    int want[N * N];
+    int source = 1 * N + 1;
+
+    ck_assert_int_eq(maze_distance_compute(&field, m, &source, 1), 0);
+    reference(m, source, want);
+    long reached = 0;
+    for (int i = 0; i < N * N; i++) {
+        ck_assert_int_eq(maze_distance_get(&field, i), want[i]);
+        reached += want[i] != MAZE_DISTANCE_UNREACHABLE;
+    }
+    ck_assert_int_eq(field.reached, reached);
+    ck_assert_int_eq(maze_distance_get(&field, -1),
+                     MAZE_DISTANCE_UNREACHABLE);
+    ck_assert_int_eq(maze_distance_get(&field, N * N),
+                     MAZE_DISTANCE_UNREACHABLE);
+
+    maze_distance_cleanup(&field);
+    ck_assert_ptr_null(field.dist);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_distance_multi) {
+    struct maze *m = read_maze();
+    struct maze_distance field;
+    int a[N * N];
+    int b[N * N];
+    /* A wall and a border cell are left out. */
+    int sources[] = { 1 * N + 1, (N - 2) * N + N - 2, 5 * N + 20, 3 };
+
+    ck_assert_int_eq(maze_distance_compute(&field, m, sources, 4), 0);
+    reference(m, sources[0], a);
+    reference(m, sources[1], b);
+    for (int i = 0; i < N * N; i++) {
+        int want = a[i];
+        if (want == MAZE_DISTANCE_UNREACHABLE
+            || (b[i] != MAZE_DISTANCE_UNREACHABLE && b[i] < want)) {
+            want = b[i];
+        }
+        ck_assert_int_eq(maze_distance_get(&field, i), want);
+    }
+
+    maze_distance_cleanup(&field);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_distance_descend) {
+    struct maze *m = read_maze();
+    struct maze_distance field;
+    int source = 1 * N + 1;
+
+    ck_assert_int_eq(maze_distance_compute(&field, m, &source, 1), 0);
+    int length = maze_distance_get(&field, 15 * N + 17);
+    ck_assert_int_gt(length, 0);
+    int next = maze_distance_next(&field, 15 * N + 17);
+    ck_assert_int_eq(maze_distance_get(&field, next), length - 1);
+    ck_assert_int_eq(maze_distance_next(&field, source),
+                     MAZE_DISTANCE_UNREACHABLE);
+    ck_assert_int_eq(maze_distance_next(&field, (N - 2) * N + N - 2),
+                     MAZE_DISTANCE_UNREACHABLE);
+    ck_assert_int_eq(maze_distance_descend(&field, m, 15, 17), length);
+
+    /* Exactly 'length' cells are marked, ending at the source. */
+    int marked = 0;
+    for (int r = 0; r < N; r++) {
+        for (int c = 0; c < N; c++) {
+            marked += maze_get(m, r, c) == PATH;
+        }
+    }
+    ck_assert_int_eq(marked, length);
+    ck_assert_int_eq(maze_get(m, 1, 1), PATH);
+    ck_assert_int_eq(maze_get(m, 15, 17), FLOOR);
+
+    /* The right half cannot reach the source. */
+    ck_assert_int_eq(maze_distance_descend(&field, m, N - 2, N - 2),
+                     MAZE_DISTANCE_UNREACHABLE);
+    ck_assert_int_eq(maze_distance_descend(&field, m, 0, 0),
+                     MAZE_DISTANCE_UNREACHABLE);
+    ck_assert_int_eq(maze_distance_descend(&field, m, N, 1),
+                     MAZE_DISTANCE_UNREACHABLE);
+    ck_assert_int_eq(maze_distance_descend(&field, m, 1, 1), 0);
+
+    maze_distance_cleanup(&field);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_distance_save_load) {
+    struct maze *m = read_maze();
+    struct maze_distance field;
+    struct maze_distance mapped;
+    int source = (N - 2) * N + N - 2;
+    uint64_t key = maze_distance_key(m, &source, 1);
+
+    ck_assert_int_eq(maze_distance_compute(&field, m, &source, 1), 0);
+    ck_assert_int_eq(maze_distance_save(&field, FIELD, key), 0);
+    ck_assert_int_eq(maze_distance_load(&mapped, FIELD, key + 1), 1);
+    ck_assert_int_eq(maze_distance_load(&mapped, FIELD, key), 0);
+    ck_assert_ptr_nonnull(mapped.map);
+    ck_assert_int_eq(mapped.n, N);
+    ck_assert_int_eq(mapped.reached, field.reached);
+    for (int i = 0; i < N * N; i++) {
+        ck_assert_int_eq(maze_distance_get(&mapped, i),
+                         maze_distance_get(&field, i));
+    }
+    ck_assert_int_eq(maze_distance_descend(&mapped, m, 2, 23),
+                     maze_distance_get(&field, 2 * N + 23));
+
+    maze_distance_cleanup(&mapped);
+    maze_distance_cleanup(&field);
+
+    /* A truncated file is rejected. */
+    ck_assert_int_eq(truncate(FIELD, 100), 0);
+    ck_assert_int_eq(maze_distance_load(&mapped, FIELD, key), 1);
+    remove(FIELD);
+    ck_assert_int_eq(maze_distance_load(&mapped, FIELD, key), 1);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_distance_key) {
+    struct maze *m = read_maze();
+    int a = 1 * N + 1;
+    int b = 2 * N + 1;
+
+    ck_assert(maze_distance_key(m, &a, 1) == maze_distance_key(m, &a, 1));
+    ck_assert(maze_distance_key(m, &a, 1) != maze_distance_key(m, &b, 1));
+
+    /* Marks left by a solver do not change the key. */
+    uint64_t key = maze_distance_key(m, &a, 1);
+    maze_set(m, 1, 2, VISITED);
+    ck_assert(maze_distance_key(m, &a, 1) == key);
+    maze_set(m, 1, 2, WALL);
+    ck_assert(maze_distance_key(m, &a, 1) != key);
+
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_distance_null) {
+    struct maze *m = read_maze();
+    struct maze_distance field;
+    int source = 1 * N + 1;
+
+    ck_assert_int_eq(maze_distance_compute(NULL, m, &source, 1), 1);
+    ck_assert_int_eq(maze_distance_compute(&field, NULL, &source, 1), 1);
+    ck_assert_int_eq(maze_distance_compute(&field, m, NULL, 1), 1);
+    ck_assert_int_eq(maze_distance_get(NULL, 0), MAZE_DISTANCE_UNREACHABLE);
+    ck_assert_int_eq(maze_distance_load(NULL, FIELD, 0), 1);
+    ck_assert_int_eq(maze_distance_load(&field, NULL, 0), 1);
+
+    /* No sources leaves every cell unreachable. */
+    ck_assert_int_eq(maze_distance_compute(&field, m, NULL, 0), 0);
+    ck_assert_int_eq(field.reached, 0);
+    ck_assert_int_eq(maze_distance_descend(NULL, m, 1, 1),
+                     MAZE_DISTANCE_UNREACHABLE);
+    ck_assert_int_eq(maze_distance_descend(&field, NULL, 1, 1),
+                     MAZE_DISTANCE_UNREACHABLE);
+    ck_assert_int_eq(maze_distance_save(NULL, FIELD, 0), 1);
+    ck_assert_int_eq(maze_distance_save(&field, NULL, 0), 1);
+    ck_assert_int_eq(maze_distance_save(&field, "no/such/dir/field", 0), 1);
+    maze_distance_cleanup(&field);
+    maze_distance_cleanup(&field);
+    maze_distance_cleanup(NULL);
+
+    maze_cleanup(m);
+}
+END_TEST
+
+Suite *maze_distance_suite(void) {
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("maze distance");
+
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_distance_single);
+    tcase_add_test(tc_core, test_distance_multi);
+    tcase_add_test(tc_core, test_distance_descend);
+    tcase_add_test(tc_core, test_distance_save_load);
+    tcase_add_test(tc_core, test_distance_key);
+    tcase_add_test(tc_core, test_distance_null);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = maze_distance_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,221 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <check.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "maze_neighbors.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+#ifndef ck_assert_ptr_null
+#define ck_assert_ptr_null(X) _ck_assert_ptr(X, ==, NULL)
+#endif
+
+#define N 50
+
+/* The character at (r, c) of the generated maze. The border has a few
+ * floor cells, which the flat copy has to turn into walls. */
+static char expected(int r, int c) {
+    if (r == 1 && c == 1) {
+        return 'S';
+    }
+    if (r == N - 2 && c == N - 2) {
+        return 'D';
+    }
+    if (r == 0 || c == 0 || r == N - 1 || c == N - 1) {
+        return (r + c) % 7 == 0 ? FLOOR : WALL;
+    }
+    return (r * 7 + c * 13) % 5 == 0 ? WALL : FLOOR;
+}
+
+/* Read the generated maze from stdin. */
+static struct maze *read_maze(void) {
+    FILE *fp = tmpfile();
+    ck_assert_ptr_nonnull(fp);
+    for (int r = 0; r < N; r++) {
+        for (int c = 0; c < N; c++) {
+            fputc(expected(r, c), fp);
+        }
+        fputc('\n', fp);
+    }
+    rewind(fp);
+    ck_assert_int_ne(dup2(fileno(fp), 0), -1);
+    fclose(fp);
+    clearerr(stdin);
+
+    struct maze *m = maze_read();
+    ck_assert_ptr_nonnull(m);
+    return m;
+}
+
+/* The cell at (r, c) of 'm' as the flat copy should hold it. */
+static char flat_cell(const struct maze *m, int r, int c) {
+    if (r < 1 || c < 1 || r > N - 2 || c > N - 2) {
+        return WALL;
+    }
+    return maze_get(m, r, c);
+}
+
+START_TEST(test_flat_load) {
+    struct maze *m = read_maze();
+    struct maze_flat flat;
+
+    ck_assert_int_eq(maze_flat_load(&flat, m), 0);
+    ck_assert_int_eq(flat.n, N);
+    for (int d = 0; d < N_MOVES; d++) {
+        ck_assert_int_eq(flat.offsets[d],
+                         m_offsets[d][0] * N + m_offsets[d][1]);
+    }
+    for (int r = 0; r < N; r++) {
+        for (int c = 0; c < N; c++) {
+            ck_assert_int_eq(maze_flat_index(&flat, r, c), r * N + c);
+            ck_assert_int_eq(maze_flat_get(&flat, r * N + c),
+                             flat_cell(m, r, c));
+        }
+    }
+
+    /* The rows before and after the maze are walls. */
+    for (int i = 1; i <= N; i++) {
+        ck_assert_int_eq(flat.cells[-i], WALL);
+        ck_assert_int_eq(flat.cells[N * N - 1 + i], WALL);
+    }
+
+    maze_flat_cleanup(&flat);
+    ck_assert_ptr_null(flat.cells);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_flat_neighbors) {
+    struct maze *m = read_maze();
+    struct maze_flat flat;
+    const char values[] = { WALL, FLOOR, VISITED, PATH };
+
+    ck_assert_int_eq(maze_flat_load(&flat, m), 0);
+    for (int r = 1; r < N - 1; r++) {
+        for (int c = 1; c < N - 1; c++) {
+            if ((r + c) % 3 == 0) {
+                maze_flat_set(&flat, r * N + c, c % 2 ? VISITED : PATH);
+            }
+        }
+    }
+
+    /* Compare with one lookup per neighbour, for every cell and even on
+     * the border. */
+    for (int r = 0; r < N; r++) {
+        for (int c = 0; c < N; c++) {
+            int index = r * N + c;
+            for (size_t v = 0; v < sizeof(values); v++) {
+                unsigned int want = 0;
+                for (int d = 0; d < N_MOVES; d++) {
+                    if (flat.cells[index + flat.offsets[d]] == values[v]) {
+                        want |= 1u << d;
+                    }
+                }
+                ck_assert_int_eq(maze_flat_neighbors(&flat, index,
+                                                     values[v]), want);
+            }
+        }
+    }
+
+    maze_flat_cleanup(&flat);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_flat_neighbors_bytes) {
+    struct maze *m = read_maze();
+    struct maze_flat flat;
+    int index = 10 * N + 10;
+
+    /* Bytes that differ from the value only in their top bit or by one
+     * must not match. */
+    ck_assert_int_eq(maze_flat_load(&flat, m), 0);
+    flat.cells[index + flat.offsets[0]] = (char) 0xa0;
+    flat.cells[index + flat.offsets[1]] = 0x20;
+    flat.cells[index + flat.offsets[2]] = 0x21;
+    flat.cells[index + flat.offsets[3]] = (char) 0xa0;
+    ck_assert_int_eq(maze_flat_neighbors(&flat, index, 0x20), 0x2);
+    ck_assert_int_eq(maze_flat_neighbors(&flat, index, (char) 0xa0), 0x9);
+    ck_assert_int_eq(maze_flat_neighbors(&flat, index, 0x21), 0x4);
+    ck_assert_int_eq(maze_flat_neighbors(&flat, index, 0x00), 0x0);
+
+    maze_flat_cleanup(&flat);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_flat_store) {
+    struct maze *m = read_maze();
+    struct maze_flat flat;
+
+    ck_assert_int_eq(maze_flat_load(&flat, m), 0);
+    maze_flat_set(&flat, 1 * N + 1, VISITED);
+    maze_flat_set(&flat, 1 * N + 2, PATH);
+    maze_flat_set(&flat, 2 * N + 1, WALL);
+    maze_flat_store(&flat, m);
+
+    ck_assert_int_eq(maze_get(m, 1, 1), VISITED);
+    ck_assert_int_eq(maze_get(m, 1, 2), PATH);
+    ck_assert_int_eq(maze_get(m, 2, 1), FLOOR);
+
+    /* The walls put on the border are not written back. */
+    ck_assert_int_eq(maze_get(m, 0, 7), FLOOR);
+
+    maze_flat_cleanup(&flat);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_flat_null) {
+    struct maze *m = read_maze();
+    struct maze_flat flat;
+
+    ck_assert_int_eq(maze_flat_load(NULL, m), 1);
+    ck_assert_int_eq(maze_flat_load(&flat, NULL), 1);
+    maze_flat_store(NULL, m);
+    maze_flat_cleanup(NULL);
+
+    ck_assert_int_eq(maze_flat_load(&flat, m), 0);
+    maze_flat_store(&flat, NULL);
+    maze_flat_cleanup(&flat);
+    maze_flat_cleanup(&flat);
+    maze_cleanup(m);
+}
+END_TEST
+
+Suite *maze_neighbors_suite(void) {
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("maze neighbors");
+
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_flat_load);
+    tcase_add_test(tc_core, test_flat_neighbors);
+    tcase_add_test(tc_core, test_flat_neighbors_bytes);
+    tcase_add_test(tc_core, test_flat_store);
+    tcase_add_test(tc_core, test_flat_null);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = maze_neighbors_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
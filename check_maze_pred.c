@@ -0,0 +1,153 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "maze_pred.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+#ifndef ck_assert_ptr_null
+#define ck_assert_ptr_null(X) _ck_assert_ptr(X, ==, NULL)
+#endif
+
+#define N 9
+
+/* Read an open maze of size N, walls only on the border, from stdin. */
+static struct maze *read_maze(void) {
+    FILE *fp = tmpfile();
+    ck_assert_ptr_nonnull(fp);
+    for (int r = 0; r < N; r++) {
+        for (int c = 0; c < N; c++) {
+            char ch = FLOOR;
+            if (r == 0 || c == 0 || r == N - 1 || c == N - 1) {
+                ch = WALL;
+            } else if (r == 1 && c == 1) {
+                ch = 'S';
+            } else if (r == N - 2 && c == N - 2) {
+                ch = 'D';
+            }
+            fputc(ch, fp);
+        }
+        fputc('\n', fp);
+    }
+    rewind(fp);
+    ck_assert_int_ne(dup2(fileno(fp), 0), -1);
+    fclose(fp);
+    clearerr(stdin);
+
+    struct maze *m = maze_read();
+    ck_assert_ptr_nonnull(m);
+    return m;
+}
+
+START_TEST(test_pred_bytes) {
+    ck_assert_int_eq(maze_pred_bytes(0), 0);
+    ck_assert_int_eq(maze_pred_bytes(1), 1);
+    ck_assert_int_eq(maze_pred_bytes(2), 1);
+    ck_assert_int_eq(maze_pred_bytes(3), 3);
+    ck_assert(maze_pred_bytes(30000) == 225000000);
+}
+END_TEST
+
+START_TEST(test_pred_set_get) {
+    struct maze_pred p;
+    ck_assert_int_eq(maze_pred_init(&p, N), 0);
+    ck_assert_int_eq(p.n, N);
+
+    /* Neighbouring cells share a byte and must not disturb each other. */
+    for (int i = 0; i < N * N; i++) {
+        maze_pred_set(&p, i, (unsigned int) (i * 7) % N_MOVES);
+    }
+    for (int i = 0; i < N * N; i++) {
+        ck_assert_int_eq(maze_pred_get(&p, i), (i * 7) % N_MOVES);
+    }
+
+    /* Setting a cell again replaces its direction. */
+    for (int i = 0; i < N * N; i += 3) {
+        maze_pred_set(&p, i, 3 - (unsigned int) (i * 7) % N_MOVES);
+    }
+    for (int i = 0; i < N * N; i++) {
+        int want = (i * 7) % N_MOVES;
+        ck_assert_int_eq(maze_pred_get(&p, i), i % 3 == 0 ? 3 - want : want);
+    }
+
+    maze_pred_cleanup(&p);
+    ck_assert_ptr_null(p.bits);
+}
+END_TEST
+
+START_TEST(test_pred_mark) {
+    struct maze *m = read_maze();
+    struct maze_flat flat;
+    struct maze_pred p;
+    ck_assert_int_eq(maze_flat_load(&flat, m), 0);
+    ck_assert_int_eq(maze_pred_init(&p, N), 0);
+
+    /* From (1, 1) right to (1, 4), then down to (5, 4). */
+    int start = maze_flat_index(&flat, 1, 1);
+    for (int c = 2; c <= 4; c++) {
+        maze_pred_set(&p, maze_flat_index(&flat, 1, c), 1);
+    }
+    for (int r = 2; r <= 5; r++) {
+        maze_pred_set(&p, maze_flat_index(&flat, r, 4), 2);
+    }
+
+    int end = maze_flat_index(&flat, 5, 4);
+    ck_assert_int_eq(maze_pred_mark(&p, &flat, end, start, PATH), 7);
+    ck_assert_int_eq(maze_flat_get(&flat, start), FLOOR);
+    ck_assert_int_eq(maze_flat_get(&flat, end), PATH);
+    ck_assert_int_eq(maze_flat_get(&flat, maze_flat_index(&flat, 1, 2)), PATH);
+    ck_assert_int_eq(maze_flat_get(&flat, maze_flat_index(&flat, 3, 4)), PATH);
+    ck_assert_int_eq(maze_flat_get(&flat, maze_flat_index(&flat, 2, 2)),
+                     FLOOR);
+    ck_assert_int_eq(maze_pred_mark(&p, &flat, start, start, PATH), 0);
+
+    maze_pred_cleanup(&p);
+    maze_flat_cleanup(&flat);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_pred_null) {
+    struct maze_pred p;
+    ck_assert_int_eq(maze_pred_init(NULL, N), 1);
+    ck_assert_int_eq(maze_pred_init(&p, -1), 1);
+    ck_assert_int_eq(maze_pred_mark(NULL, NULL, 0, 0, PATH), 0);
+    maze_pred_cleanup(NULL);
+}
+END_TEST
+
+Suite *maze_pred_suite(void) {
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("maze predecessors");
+
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_pred_bytes);
+    tcase_add_test(tc_core, test_pred_set_get);
+    tcase_add_test(tc_core, test_pred_mark);
+    tcase_add_test(tc_core, test_pred_null);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = maze_pred_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,289 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <check.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "maze_render.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+
+/* Big enough to be split over several threads. */
+#define N 300
+
+#define IMAGE_A "check_maze_render_a.img"
+#define IMAGE_B "check_maze_render_b.img"
+
+/* The character at (r, c) of the generated maze. */
+static char expected(int r, int c) {
+    if (r == 1 && c == 1) {
+        return 'S';
+    }
+    if (r == N - 2 && c == N - 2) {
+        return 'D';
+    }
+    if (r == 0 || c == 0 || r == N - 1 || c == N - 1) {
+        return WALL;
+    }
+    return (r * 7 + c * 13) % 5 == 0 ? WALL : FLOOR;
+}
+
+/* Read the generated maze from stdin and mark some cells as visited and
+ * as part of a path, so every colour is used. */
+static struct maze *read_maze(void) {
+    FILE *fp = tmpfile();
+    ck_assert_ptr_nonnull(fp);
+    for (int r = 0; r < N; r++) {
+        for (int c = 0; c < N; c++) {
+            fputc(expected(r, c), fp);
+        }
+        fputc('\n', fp);
+    }
+    rewind(fp);
+    ck_assert_int_ne(dup2(fileno(fp), 0), -1);
+    fclose(fp);
+    clearerr(stdin);
+
+    struct maze *m = maze_read();
+    ck_assert_ptr_nonnull(m);
+    for (int r = 1; r < N - 1; r++) {
+        for (int c = 1; c < N - 1; c++) {
+            if (maze_get(m, r, c) == FLOOR && (r + c) % 3 == 0) {
+                maze_set(m, r, c, c % 2 ? VISITED : PATH);
+            }
+        }
+    }
+    return m;
+}
+
+/* Read the whole file 'fp' into a new buffer and close it. */
+static char *slurp(FILE *fp, size_t *size) {
+    fseek(fp, 0, SEEK_END);
+    long len = ftell(fp);
+    ck_assert_int_ge(len, 0);
+    rewind(fp);
+
+    char *buf = malloc((size_t) len + 1);
+    ck_assert_ptr_nonnull(buf);
+    *size = fread(buf, 1, (size_t) len, fp);
+    ck_assert_int_eq(*size, len);
+    fclose(fp);
+    return buf;
+}
+
+static char *slurp_file(const char *filename, size_t *size) {
+    FILE *fp = fopen(filename, "rb");
+    ck_assert_ptr_nonnull(fp);
+    char *buf = slurp(fp, size);
+    remove(filename);
+    return buf;
+}
+
+/* Return what maze_print() writes to stdout. */
+static char *print_output(const struct maze *m, bool blocks, size_t *size) {
+    FILE *fp = tmpfile();
+    ck_assert_ptr_nonnull(fp);
+
+    fflush(stdout);
+    int saved = dup(1);
+    ck_assert_int_ne(saved, -1);
+    ck_assert_int_ne(dup2(fileno(fp), 1), -1);
+    maze_print(m, blocks);
+    fflush(stdout);
+    ck_assert_int_ne(dup2(saved, 1), -1);
+    close(saved);
+
+    return slurp(fp, size);
+}
+
+/* Check that maze_render_text() writes the same as maze_print(). */
+static void check_text(bool blocks, int threads) {
+    struct maze *m = read_maze();
+    size_t want_size;
+    size_t got_size;
+    char *want = print_output(m, blocks, &want_size);
+
+    FILE *fp = tmpfile();
+    ck_assert_ptr_nonnull(fp);
+    ck_assert_int_eq(maze_render_text(m, fp, blocks, threads), 0);
+    char *got = slurp(fp, &got_size);
+
+    ck_assert_int_eq(got_size, want_size);
+    ck_assert(memcmp(got, want, want_size) == 0);
+    free(want);
+    free(got);
+    maze_cleanup(m);
+}
+
+START_TEST(test_render_text) {
+    check_text(false, 1);
+}
+END_TEST
+
+START_TEST(test_render_text_threads) {
+    check_text(false, 3);
+}
+END_TEST
+
+START_TEST(test_render_text_blocks) {
+    check_text(true, 1);
+    check_text(true, 4);
+}
+END_TEST
+
+START_TEST(test_render_ppm) {
+    struct maze *m = read_maze();
+    size_t want_size;
+    size_t got_size;
+
+    ck_assert_int_eq(maze_output_ppm(m, IMAGE_A), 0);
+    char *want = slurp_file(IMAGE_A, &want_size);
+
+    for (int threads = 0; threads <= 3; threads++) {
+        ck_assert_int_eq(maze_render_ppm(m, IMAGE_B, threads), 0);
+        char *got = slurp_file(IMAGE_B, &got_size);
+        ck_assert_int_eq(got_size, want_size);
+        ck_assert(memcmp(got, want, want_size) == 0);
+        free(got);
+    }
+
+    free(want);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_render_pgm) {
+    struct maze *m = read_maze();
+    const char *header = "P5\n300 300\n255\n";
+    size_t size;
+
+    ck_assert_int_eq(maze_render_pgm(m, IMAGE_A, 2), 0);
+    unsigned char *img = (unsigned char *) slurp_file(IMAGE_A, &size);
+    ck_assert_int_eq(size, strlen(header) + N * N);
+    ck_assert(memcmp(img, header, strlen(header)) == 0);
+
+    const unsigned char *pixels = img + strlen(header);
+    ck_assert_int_eq(pixels[1 * N + 1], MAZE_RENDER_GREY_START);
+    ck_assert_int_eq(pixels[(N - 2) * N + N - 2],
+                     MAZE_RENDER_GREY_DESTINATION);
+    for (int r = 0; r < N; r++) {
+        for (int c = 0; c < N; c++) {
+            if ((r == 1 && c == 1) || (r == N - 2 && c == N - 2)) {
+                continue;
+            }
+            char ch = maze_get(m, r, c);
+            int grey = ch == WALL ? MAZE_RENDER_GREY_WALL
+                       : ch == PATH ? MAZE_RENDER_GREY_PATH
+                       : ch == VISITED ? MAZE_RENDER_GREY_VISITED
+                       : MAZE_RENDER_GREY_FLOOR;
+            ck_assert_int_eq(pixels[r * N + c], grey);
+        }
+    }
+
+    free(img);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_render_overview_full_size) {
+    struct maze *m = read_maze();
+    size_t want_size;
+    size_t got_size;
+
+    /* Each pixel covers a single cell, which gives the full image. */
+    ck_assert_int_eq(maze_render_ppm(m, IMAGE_A, 1), 0);
+    char *want = slurp_file(IMAGE_A, &want_size);
+    ck_assert_int_eq(maze_render_overview(m, IMAGE_B, 0), 0);
+    char *got = slurp_file(IMAGE_B, &got_size);
+
+    ck_assert_int_eq(got_size, want_size);
+    ck_assert(memcmp(got, want, want_size) == 0);
+    free(want);
+    free(got);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_render_overview_scaled) {
+    struct maze *m = read_maze();
+    const char *header = "P6\n100 100\n255\n";
+    size_t size;
+
+    /* 3 by 3 cells per pixel. */
+    ck_assert_int_eq(maze_render_overview(m, IMAGE_A, 100), 0);
+    unsigned char *img = (unsigned char *) slurp_file(IMAGE_A, &size);
+    ck_assert_int_eq(size, strlen(header) + 3 * 100 * 100);
+    ck_assert(memcmp(img, header, strlen(header)) == 0);
+
+    const unsigned char *pixels = img + strlen(header);
+    const unsigned char green[3] = { 0, 255, 0 };
+    const unsigned char orange[3] = { 255, 165, 0 };
+    ck_assert(memcmp(&pixels[0], green, 3) == 0);
+    ck_assert(memcmp(&pixels[3 * (99 * 100 + 99)], orange, 3) == 0);
+
+    free(img);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_render_null) {
+    struct maze *m = read_maze();
+
+    ck_assert_int_eq(maze_render_text(NULL, stdout, false, 1), 1);
+    ck_assert_int_eq(maze_render_text(m, NULL, false, 1), 1);
+    ck_assert_int_eq(maze_render_ppm(NULL, IMAGE_A, 1), 1);
+    ck_assert_int_eq(maze_render_ppm(m, NULL, 1), 1);
+    ck_assert_int_eq(maze_render_pgm(NULL, IMAGE_A, 1), 1);
+    ck_assert_int_eq(maze_render_pgm(m, NULL, 1), 1);
+    ck_assert_int_eq(maze_render_overview(NULL, IMAGE_A, 0), 1);
+    ck_assert_int_eq(maze_render_overview(m, NULL, 0), 1);
+    ck_assert_int_eq(maze_render_overview(m, IMAGE_A, -1), 1);
+    ck_assert_int_eq(maze_render_ppm(m, "no/such/dir/x.ppm", 1), 1);
+
+    maze_cleanup(m);
+}
+END_TEST
+
+Suite *maze_render_suite(void) {
+    Suite *s;
+    TCase *tc_text;
+    TCase *tc_image;
+    s = suite_create("maze render");
+
+    tc_text = tcase_create("Text");
+    tcase_add_test(tc_text, test_render_text);
+    tcase_add_test(tc_text, test_render_text_threads);
+    tcase_add_test(tc_text, test_render_text_blocks);
+
+    tc_image = tcase_create("Image");
+    tcase_add_test(tc_image, test_render_ppm);
+    tcase_add_test(tc_image, test_render_pgm);
+    tcase_add_test(tc_image, test_render_overview_full_size);
+    tcase_add_test(tc_image, test_render_overview_scaled);
+    tcase_add_test(tc_image, test_render_null);
+
+    suite_add_tcase(s, tc_text);
+    suite_add_tcase(s, tc_image);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = maze_render_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,236 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <check.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "maze_simd.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+#ifndef ck_assert_ptr_null
+#define ck_assert_ptr_null(X) _ck_assert_ptr(X, ==, NULL)
+#endif
+
+#define MAX_N 130
+
+/* Not part of maze.h, but maze_simd.c keeps it as maze.c has it. */
+struct maze *maze_init(int n);
+
+/* Characters of the generated mazes: besides walls and floors, bytes next
+ * to WALL, marks a solver writes and bytes with the top bit set, which
+ * must all become FLOOR. */
+static const char chars[] = { WALL, WALL, WALL, FLOOR, FLOOR, FLOOR, '"',
+                              '$', PATH, VISITED, '\t', (char) 0x80,
+                              (char) 0xa3, (char) 0xff };
+
+/* The character at (r, c) of the generated maze of size 'n' with 'marks'
+ * starts and destinations, which are scattered so the last ones are not
+ * always last in their row. */
+static char generated(int n, int r, int c, int marks) {
+    unsigned int x = (unsigned int) (r * 7919 + c * 104729 + n * 31);
+    x = x * 2654435761u;
+    if (marks > 0 && (x >> 20) % 97 == 0) {
+        return (x >> 8) % 2 == 0 ? 'S' : 'D';
+    }
+    return chars[(x >> 12) % sizeof(chars)];
+}
+
+/* Make stdin read 'text'. */
+static void stdin_from(const char *text) {
+    FILE *fp = tmpfile();
+    ck_assert_ptr_nonnull(fp);
+    fputs(text, fp);
+    rewind(fp);
+    ck_assert_int_ne(dup2(fileno(fp), 0), -1);
+    fclose(fp);
+    clearerr(stdin);
+}
+
+/* Make stdin read the generated maze of size 'n' with 'rows' rows,
+ * followed by 'tail'. */
+static void stdin_from_maze(int n, int rows, int marks, const char *tail) {
+    FILE *fp = tmpfile();
+    ck_assert_ptr_nonnull(fp);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < n; c++) {
+            fputc(generated(n, r, c, marks), fp);
+        }
+        fputc('\n', fp);
+    }
+    fputs(tail, fp);
+    rewind(fp);
+    ck_assert_int_ne(dup2(fileno(fp), 0), -1);
+    fclose(fp);
+    clearerr(stdin);
+}
+
+/* Check that 'm' is the generated maze of size 'n' as maze.c reads it. */
+static void check_maze(const struct maze *m, int n, int marks) {
+    int start = n + 1;
+    int finish = (n - 2) * n + n - 2;
+
+    ck_assert_ptr_nonnull(m);
+    ck_assert_int_eq(maze_size(m), n);
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            char ch = generated(n, r, c, marks);
+            ck_assert_int_eq(maze_get(m, r, c), ch == WALL ? WALL : FLOOR);
+            if (ch == 'S') {
+                start = r * n + c;
+            } else if (ch == 'D') {
+                finish = r * n + c;
+            }
+        }
+    }
+
+    int r, c;
+    maze_start(m, &r, &c);
+    ck_assert_int_eq(maze_index(m, r, c), start);
+    maze_destination(m, &r, &c);
+    ck_assert_int_eq(maze_index(m, r, c), finish);
+}
+
+START_TEST(test_simd_levels) {
+    enum maze_simd_level best = maze_simd_best();
+
+    ck_assert_int_eq(maze_simd_use(MAZE_SIMD_SCALAR), MAZE_SIMD_SCALAR);
+    ck_assert_int_eq(maze_simd_level(), MAZE_SIMD_SCALAR);
+    ck_assert_int_eq(maze_simd_use(MAZE_SIMD_AVX2), best);
+    ck_assert_int_eq(maze_simd_level(), best);
+#if defined(__x86_64__)
+    ck_assert_int_ge(best, MAZE_SIMD_SSE2);
+#endif
+    ck_assert_str_eq(maze_simd_name(MAZE_SIMD_SCALAR), "scalar");
+    ck_assert_str_eq(maze_simd_name(MAZE_SIMD_SSE2), "sse2");
+    ck_assert_str_eq(maze_simd_name(MAZE_SIMD_AVX2), "avx2");
+}
+END_TEST
+
+START_TEST(test_simd_env) {
+    setenv("MAZE_SIMD", "scalar", 1);
+    ck_assert_int_eq(maze_simd_level(), MAZE_SIMD_SCALAR);
+}
+END_TEST
+
+START_TEST(test_simd_read) {
+    /* Around every width the vector loops and their tails handle. */
+    const int sizes[] = { 1, 2, 3, 7, 15, 16, 17, 31, 32, 33, 47, 48, 49,
+                          63, 64, 65, 95, 96, 97, MAX_N };
+
+    for (int l = MAZE_SIMD_SCALAR; l <= MAZE_SIMD_AVX2; l++) {
+        maze_simd_use((enum maze_simd_level) l);
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            for (int marks = 0; marks <= 1; marks++) {
+                int n = sizes[i];
+                stdin_from_maze(n, n, marks, "");
+                struct maze *m = maze_read();
+                check_maze(m, n, marks);
+                maze_cleanup(m);
+            }
+        }
+    }
+}
+END_TEST
+
+START_TEST(test_simd_not_square) {
+    for (int l = MAZE_SIMD_SCALAR; l <= MAZE_SIMD_AVX2; l++) {
+        maze_simd_use((enum maze_simd_level) l);
+
+        /* More rows than columns. */
+        stdin_from_maze(40, 41, 1, "");
+        ck_assert_ptr_null(maze_read());
+
+        /* More columns than rows. */
+        stdin_from_maze(40, 39, 1, "");
+        ck_assert_ptr_null(maze_read());
+
+        /* A row of another length ends the maze early. */
+        stdin_from_maze(40, 20, 1, "#\n");
+        ck_assert_ptr_null(maze_read());
+
+        stdin_from("");
+        ck_assert_ptr_null(maze_read());
+        stdin_from("\n");
+        ck_assert_ptr_null(maze_read());
+    }
+}
+END_TEST
+
+START_TEST(test_simd_next_maze) {
+    maze_simd_use(MAZE_SIMD_AVX2);
+
+    /* The line that ends a maze is read with it, as by maze.c, so the
+     * next maze starts right after the blank line. */
+    stdin_from_maze(33, 33, 1, "\n###\n#S#\n#D#\n");
+    struct maze *m = maze_read();
+    check_maze(m, 33, 1);
+    maze_cleanup(m);
+
+    m = maze_read();
+    ck_assert_ptr_nonnull(m);
+    ck_assert_int_eq(maze_size(m), 3);
+    int r, c;
+    maze_start(m, &r, &c);
+    ck_assert_int_eq(r, 1);
+    ck_assert_int_eq(c, 1);
+    maze_destination(m, &r, &c);
+    ck_assert_int_eq(r, 2);
+    ck_assert_int_eq(c, 1);
+    ck_assert_int_eq(maze_get(m, 1, 1), FLOOR);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_simd_init) {
+    struct maze *m = maze_init(17);
+
+    ck_assert_ptr_nonnull(m);
+    for (int r = 0; r < 17; r++) {
+        for (int c = 0; c < 17; c++) {
+            ck_assert_int_eq(maze_get(m, r, c), WALL);
+        }
+    }
+    maze_set(m, 3, 4, PATH);
+    ck_assert_int_eq(maze_get(m, 3, 4), PATH);
+    maze_cleanup(m);
+    ck_assert_ptr_null(maze_init(0));
+}
+END_TEST
+
+Suite *maze_simd_suite(void) {
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("maze simd");
+
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_simd_levels);
+    tcase_add_test(tc_core, test_simd_env);
+    tcase_add_test(tc_core, test_simd_read);
+    tcase_add_test(tc_core, test_simd_not_square);
+    tcase_add_test(tc_core, test_simd_next_maze);
+    tcase_add_test(tc_core, test_simd_init);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = maze_simd_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -14,6 +14,20 @@ echo "Checking the actual path in the ascii maze..."
 echo
 ./check_maze_solver.sh ./maze_solver_dfs path 0 $inputs
 
+echo
+echo "Checking the solver built on the disk-spilling queue..."
+./check_maze_solver.sh ./maze_solver_bfs_ext path 0 $inputs
+
+echo
+echo "Checking the solver built on the tiled maze..."
+./check_maze_solver.sh ./maze_solver_bfs_tiled path 0 $inputs
+
+echo
+echo "Checking the solvers built on the vectorized parser..."
+./check_maze_solver.sh ./maze_solver_bfs_simd path 0 $inputs
+echo
+./check_maze_solver.sh ./maze_solver_dfs_simd path 0 $inputs
+
 # multi path checks
 inputs="mazes/maze_7x7_multiple_paths.txt mazes/maze_15x15_multiple_paths.txt"
 echo
@@ -32,3 +46,188 @@ echo "Checking the path length for special mazes..."
 # Check if mazes with no path are handled correctly
 ./check_maze_solver.sh ./maze_solver_bfs length 1 mazes/maze_impossible.txt
 
+
+# Generated mazes: a perfect maze has exactly one path, so both solvers have
+# to agree on its length.
+echo
+echo "Checking generated mazes..."
+for algorithm in backtracker prim eller; do
+    for size in 5 6 41; do
+        maze=$(./maze_gen -a $algorithm -s 7 $size)
+        bfs=$(echo "$maze" | ./maze_solver_bfs 2>/dev/null | grep -o "length: .*")
+        for mode in dfs dldfs tremaux; do
+            dfs=$(echo "$maze" | ./maze_solver_dfs -m $mode 2>/dev/null \
+                  | grep -o "length: .*")
+            if [ -z "$bfs" ] || [ "$bfs" != "$dfs" ]; then
+                echo "FAILED: $algorithm $size: bfs '$bfs', $mode '$dfs'"
+            else
+                echo "passed: $algorithm $size $mode"
+            fi
+        done
+    done
+done
+for algorithm in braid rooms; do
+    if ./maze_gen -a $algorithm -s 7 41 | ./maze_solver_bfs 2>/dev/null \
+            | grep -q "found a path"; then
+        echo "passed: $algorithm"
+    else
+        echo "FAILED: $algorithm has no path"
+    fi
+done
+if (./maze_gen -a impossible -s 7 41 | ./maze_solver_bfs) 2>/dev/null \
+        | grep -q "found a path"; then
+    echo "FAILED: impossible has a path"
+else
+    echo "passed: impossible"
+fi
+# Without costs the cheapest path is a shortest one. With costs it is at
+# least as long as one, and the costs do not move the walls.
+for algorithm in backtracker braid rooms; do
+    bfs=$(./maze_gen -a $algorithm -s 7 41 | ./maze_solver_bfs 2>/dev/null \
+          | grep -o "length: [0-9]*" | grep -o "[0-9]*")
+    plain=$(./maze_gen -a $algorithm -s 7 41 | ./maze_solver_dijkstra \
+            2>/dev/null | grep -o "cost: [0-9]*" | grep -o "[0-9]*")
+    weighted=$(./maze_gen -a $algorithm -s 7 -w 9 41 \
+               | ./maze_solver_dijkstra 2>/dev/null | grep -o "cost: [0-9]*" \
+               | grep -o "[0-9]*")
+    if [ -z "$bfs" ] || [ "$bfs" != "$plain" ] || [ -z "$weighted" ] \
+            || [ "$weighted" -lt "$bfs" ]; then
+        echo "FAILED: $algorithm dijkstra: bfs '$bfs', cost '$plain'," \
+             "weighted '$weighted'"
+    else
+        echo "passed: $algorithm dijkstra"
+    fi
+done
+# With costs of 0 and 1 the 0-1 search agrees with Dijkstra's algorithm.
+for algorithm in backtracker braid rooms; do
+    dial=$(./maze_gen -a $algorithm -s 7 -w 0 41 | ./maze_solver_dijkstra \
+           2>/dev/null | grep -o "cost: [0-9]*")
+    deque=$(./maze_gen -a $algorithm -s 7 -w 0 41 \
+            | ./maze_solver_dijkstra -m 01bfs 2>/dev/null \
+            | grep -o "cost: [0-9]*")
+    if [ -z "$dial" ] || [ "$dial" != "$deque" ]; then
+        echo "FAILED: $algorithm 01bfs: dijkstra '$dial', 01bfs '$deque'"
+    else
+        echo "passed: $algorithm 01bfs"
+    fi
+done
+if ./maze_gen -a braid -s 7 -w 9 41 | ./maze_solver_dijkstra -m 01bfs \
+        2>/dev/null | grep -q "found a path"; then
+    echo "FAILED: 01bfs accepted costs above 1"
+else
+    echo "passed: 01bfs rejects costs above 1"
+fi
+if (./maze_gen -a impossible -s 7 -w 9 41 | ./maze_solver_dijkstra) \
+        2>/dev/null | grep -q "found a path"; then
+    echo "FAILED: impossible has a path for dijkstra"
+else
+    echo "passed: impossible dijkstra"
+fi
+
+# A distance field gives the bfs length, whether it is computed or mapped
+# back in from the file the first run saved it to.
+field=$(mktemp)
+rm -f "$field"
+for algorithm in braid rooms impossible; do
+    maze=$(./maze_gen -a $algorithm -s 7 41)
+    bfs=$(echo "$maze" | ./maze_solver_bfs 2>/dev/null | grep -o "length: .*")
+    for run in computed mapped; do
+        got=$(echo "$maze" | ./maze_solver_bfs -f "$field" 2>/dev/null \
+              | grep -o "length: .*")
+        if [ "$bfs" != "$got" ]; then
+            echo "FAILED: $algorithm $run field: bfs '$bfs', field '$got'"
+        else
+            echo "passed: $algorithm $run field"
+        fi
+    done
+done
+
+# A cached map prints what the distance field prints, whether the cache is
+# written, mapped without reading the map, or not used for a pipe.
+map=$(mktemp)
+cache=$(mktemp)
+expected=$(mktemp)
+rm -f "$cache"
+for algorithm in braid rooms impossible; do
+    ./maze_gen -a $algorithm -s 7 41 > "$map"
+    ./maze_solver_bfs -i none -f "$field" < "$map" > "$expected" 2>/dev/null
+    rm -f "$field"
+    for run in saved mapped piped; do
+        if [ $run = piped ]; then
+            got=$(cat "$map" | ./maze_solver_bfs -i none -c "$cache" \
+                  2>/dev/null | cmp - "$expected" 2>&1)
+        else
+            got=$(./maze_solver_bfs -i none -c "$cache" < "$map" \
+                  2>/dev/null | cmp - "$expected" 2>&1)
+        fi
+        if [ -n "$got" ]; then
+            echo "FAILED: $algorithm $run cache: $got"
+        else
+            echo "passed: $algorithm $run cache"
+        fi
+    done
+    rm -f "$cache"
+done
+rm -f "$field" "$map" "$expected"
+for mode in dldfs tremaux; do
+    if ./maze_gen -a rooms -s 7 41 | ./maze_solver_dfs -m $mode 2>/dev/null \
+            | grep -q "found a path"; then
+        echo "passed: rooms $mode"
+    else
+        echo "FAILED: rooms has no path for $mode"
+    fi
+    if (./maze_gen -a impossible -s 7 41 | ./maze_solver_dfs -m $mode) \
+            2>/dev/null | grep -q "found a path"; then
+        echo "FAILED: impossible has a path for $mode"
+    else
+        echo "passed: impossible $mode"
+    fi
+done
+
+# A batch gives the same output as solving its mazes one at a time, with
+# mazes of different sizes in between.
+batch=$(mktemp)
+single=$(mktemp)
+for solver in ./maze_solver_bfs ./maze_solver_dfs; do
+    : > "$batch"
+    : > "$single"
+    for algorithm in braid impossible rooms backtracker; do
+        for size in 41 15; do
+            ./maze_gen -a $algorithm -s 7 $size >> "$batch"
+            echo >> "$batch"
+            ./maze_gen -a $algorithm -s 7 $size | $solver -i none \
+                2>/dev/null >> "$single"
+        done
+    done
+    if $solver -b < "$batch" 2>/dev/null | cmp -s - "$single"; then
+        echo "passed: $solver batch"
+    else
+        echo "FAILED: $solver batch differs from single runs"
+    fi
+    # The pipeline keeps the mazes in order.
+    if $solver -B < "$batch" 2>/dev/null | cmp -s - "$single"; then
+        echo "passed: $solver pipelined batch"
+    else
+        echo "FAILED: $solver pipelined batch differs from single runs"
+    fi
+done
+
+# The vectorized parser reads every maze of a batch as maze.c does, with
+# vectors of every width, and fails where it fails.
+for level in scalar sse2 avx2; do
+    ./maze_solver_bfs -b < "$batch" > "$single" 2>/dev/null
+    if MAZE_SIMD=$level ./maze_solver_bfs_simd -b < "$batch" 2>/dev/null \
+            | cmp -s - "$single"; then
+        echo "passed: $level parser batch"
+    else
+        echo "FAILED: $level parser batch differs from maze.c"
+    fi
+    if printf '#####\n#S D#\n#####\n' \
+            | MAZE_SIMD=$level ./maze_solver_bfs_simd 2>/dev/null \
+            | grep -q "Error reading maze"; then
+        echo "passed: $level parser not square"
+    else
+        echo "FAILED: $level parser read a maze that is not square"
+    fi
+done
+rm -f "$batch" "$single"
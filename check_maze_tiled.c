@@ -0,0 +1,235 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <check.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "maze_render.h"
+#include "maze_tiled.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+#ifndef ck_assert_ptr_null
+#define ck_assert_ptr_null(X) _ck_assert_ptr(X, ==, NULL)
+#endif
+
+/* Spans several tiles in both directions, but not a whole number. */
+#define N 300
+
+/* The character at (r, c) of the generated maze. */
+static char expected(int r, int c) {
+    if (r == 1 && c == 1) {
+        return 'S';
+    }
+    if (r == N - 2 && c == N - 2) {
+        return 'D';
+    }
+    if (r == 0 || c == 0 || r == N - 1 || c == N - 1) {
+        return WALL;
+    }
+    return (r * 7 + c * 13) % 5 == 0 ? WALL : FLOOR;
+}
+
+/* Write a maze of 'rows' rows of N columns to a temporary file and make it
+ * stdin. */
+static void stdin_from_maze(int rows) {
+    FILE *fp = tmpfile();
+    ck_assert_ptr_nonnull(fp);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < N; c++) {
+            fputc(expected(r, c), fp);
+        }
+        fputc('\n', fp);
+    }
+    rewind(fp);
+    ck_assert_int_ne(dup2(fileno(fp), 0), -1);
+    fclose(fp);
+    clearerr(stdin);
+}
+
+/* Read the generated maze with room for 'tiles' tiles in the cache. */
+static struct maze *read_maze(const char *tiles) {
+    setenv("MAZE_TILE_CACHE", tiles, 1);
+    stdin_from_maze(N);
+    return maze_read();
+}
+
+/* Return the character maze_read() should have stored at (r, c). */
+static char stored(int r, int c) {
+    return expected(r, c) == WALL ? WALL : FLOOR;
+}
+
+START_TEST(test_tiled_read) {
+    struct maze *m = read_maze("2");
+    ck_assert_ptr_nonnull(m);
+    ck_assert_int_eq(maze_size(m), N);
+
+    int r;
+    int c;
+    maze_start(m, &r, &c);
+    ck_assert_int_eq(r, 1);
+    ck_assert_int_eq(c, 1);
+    maze_destination(m, &r, &c);
+    ck_assert_int_eq(r, N - 2);
+    ck_assert_int_eq(c, N - 2);
+
+    /* Column by column, so nearly every access needs another tile. */
+    for (c = 0; c < N; c++) {
+        for (r = 0; r < N; r++) {
+            ck_assert_int_eq(maze_get(m, r, c), stored(r, c));
+        }
+    }
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_tiled_set_evict) {
+    struct maze *m = read_maze("3");
+    ck_assert_ptr_nonnull(m);
+
+    for (int r = 1; r < N - 1; r++) {
+        for (int c = 1; c < N - 1; c++) {
+            if (maze_get(m, r, c) == FLOOR && (r + c) % 3 == 0) {
+                maze_set(m, r, c, VISITED);
+            }
+        }
+    }
+    for (int c = N - 2; c > 0; c--) {
+        for (int r = N - 2; r > 0; r--) {
+            char want = stored(r, c);
+            if (want == FLOOR && (r + c) % 3 == 0) {
+                want = VISITED;
+            }
+            ck_assert_int_eq(maze_get(m, r, c), want);
+        }
+    }
+
+    struct maze_tile_stats stats;
+    ck_assert_int_eq(maze_tile_stats(m, &stats), 0);
+    ck_assert_int_eq(stats.cached, 3);
+    ck_assert_int_gt(stats.hits, stats.misses);
+    ck_assert_int_gt(stats.evictions, 0);
+    ck_assert_int_gt(stats.writebacks, 0);
+    ck_assert_int_le(stats.evictions, stats.misses);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_tiled_cache_fits) {
+    /* Every tile fits, so each one is loaded once and never written. */
+    struct maze *m = read_maze("1000");
+    ck_assert_ptr_nonnull(m);
+
+    for (int i = 0; i < 3; i++) {
+        for (int c = 0; c < N; c++) {
+            for (int r = 0; r < N; r++) {
+                ck_assert_int_eq(maze_get(m, r, c), stored(r, c));
+            }
+        }
+    }
+
+    struct maze_tile_stats stats;
+    ck_assert_int_eq(maze_tile_stats(m, &stats), 0);
+    int tiles = (N + MAZE_TILE_SIZE - 1) / MAZE_TILE_SIZE;
+    ck_assert_int_eq(stats.misses, (size_t) (tiles * tiles));
+    ck_assert_int_eq(stats.evictions, 0);
+    ck_assert_int_eq(stats.writebacks, 0);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_tiled_render_threads) {
+    /* Two tiles are too few for the rows of one band, so the cache evicts
+     * and writes back while the maze is rendered. */
+    struct maze *m = read_maze("2");
+    ck_assert_ptr_nonnull(m);
+    for (int r = 1; r < N - 1; r++) {
+        for (int c = 1; c < N - 1; c++) {
+            if (stored(r, c) == FLOOR && (r + c) % 3 == 0) {
+                maze_set(m, r, c, VISITED);
+            }
+        }
+    }
+
+    char *want = malloc((size_t) N * (N + 1) + 1);
+    ck_assert_ptr_nonnull(want);
+    char *p = want;
+    for (int r = 0; r < N; r++) {
+        for (int c = 0; c < N; c++) {
+            char ch = expected(r, c);
+            if (ch == FLOOR && (r + c) % 3 == 0) {
+                ch = VISITED;
+            }
+            *p++ = ch;
+        }
+        *p++ = '\n';
+    }
+    *p++ = '\n';
+    size_t size = (size_t) (p - want);
+
+    for (int threads = 1; threads <= 4; threads++) {
+        FILE *fp = tmpfile();
+        ck_assert_ptr_nonnull(fp);
+        ck_assert_int_eq(maze_render_text(m, fp, false, threads), 0);
+        ck_assert_int_eq(ftell(fp), (long) size);
+        rewind(fp);
+
+        char *got = malloc(size);
+        ck_assert_ptr_nonnull(got);
+        ck_assert_int_eq(fread(got, 1, size, fp), size);
+        ck_assert(memcmp(got, want, size) == 0);
+        free(got);
+        fclose(fp);
+    }
+
+    struct maze_tile_stats stats;
+    ck_assert_int_eq(maze_tile_stats(m, &stats), 0);
+    ck_assert_int_gt(stats.evictions, 0);
+    free(want);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_tiled_not_square) {
+    setenv("MAZE_TILE_CACHE", "2", 1);
+    stdin_from_maze(N - 1);
+    ck_assert_ptr_null(maze_read());
+    ck_assert_int_eq(maze_tile_stats(NULL, NULL), 1);
+}
+END_TEST
+
+Suite *maze_tiled_suite(void) {
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("maze tiled");
+
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_tiled_read);
+    tcase_add_test(tc_core, test_tiled_set_evict);
+    tcase_add_test(tc_core, test_tiled_cache_fits);
+    tcase_add_test(tc_core, test_tiled_render_threads);
+    tcase_add_test(tc_core, test_tiled_not_square);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = maze_tiled_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,195 @@
+#include <check.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpmc_queue.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+#ifndef ck_assert_ptr_null
+#define ck_assert_ptr_null(X) _ck_assert_ptr(X, ==, NULL)
+#endif
+
+#define THREADS 4
+#define ITEMS_PER_THREAD 100000
+
+START_TEST(test_mpmc_queue_init_cleanup) {
+    struct mpmc_queue *q = mpmc_queue_init(10);
+    ck_assert_ptr_nonnull(q);
+    mpmc_queue_cleanup(q);
+}
+END_TEST
+
+START_TEST(test_mpmc_queue_init_huge) {
+    /* No power of two this large fits in a size_t. */
+    ck_assert_ptr_null(mpmc_queue_init(SIZE_MAX / 2 + 2));
+    ck_assert_ptr_null(mpmc_queue_init(SIZE_MAX));
+
+    /* A power of two, but too many cells for a size_t of bytes. */
+    ck_assert_ptr_null(mpmc_queue_init(SIZE_MAX / 8));
+}
+END_TEST
+
+START_TEST(test_mpmc_queue_order) {
+    struct mpmc_queue *q = mpmc_queue_init(10);
+    ck_assert_int_eq(mpmc_queue_push(q, 'x'), 0);
+    ck_assert_int_eq(mpmc_queue_push(q, 'y'), 0);
+    ck_assert_int_eq(mpmc_queue_push(q, 'z'), 0);
+
+    ck_assert_int_eq(mpmc_queue_peek(q), 'x');
+    ck_assert_int_eq(mpmc_queue_pop(q), 'x');
+    ck_assert_int_eq(mpmc_queue_pop(q), 'y');
+    ck_assert_int_eq(mpmc_queue_size(q), 1);
+    ck_assert_int_eq(mpmc_queue_pop(q), 'z');
+    ck_assert_int_eq(mpmc_queue_empty(q), 1);
+    mpmc_queue_cleanup(q);
+}
+END_TEST
+
+START_TEST(test_mpmc_queue_full) {
+    struct mpmc_queue *q = mpmc_queue_init(3); /* Rounded up to 4. */
+    for (int i = 0; i < 4; i++) {
+        ck_assert_int_eq(mpmc_queue_push(q, i), 0);
+    }
+    ck_assert_int_eq(mpmc_queue_push(q, 4), 1);
+
+    for (int round = 0; round < 100; round++) {
+        ck_assert_int_eq(mpmc_queue_pop(q), round);
+        ck_assert_int_eq(mpmc_queue_push(q, round + 4), 0);
+    }
+
+    for (int i = 100; i < 104; i++) {
+        ck_assert_int_eq(mpmc_queue_pop(q), i);
+    }
+    ck_assert_int_eq(mpmc_queue_pop(q), -1);
+    ck_assert_int_eq(mpmc_queue_peek(q), -1);
+    mpmc_queue_cleanup(q);
+}
+END_TEST
+
+static struct mpmc_queue *shared;
+static atomic_int seen[THREADS * ITEMS_PER_THREAD];
+static atomic_int consumed;
+
+static void *producer(void *arg) {
+    int base = *(int *) arg * ITEMS_PER_THREAD;
+    for (int i = 0; i < ITEMS_PER_THREAD; i++) {
+        while (mpmc_queue_push(shared, base + i)) {
+            sched_yield(); /* Queue full, wait for a consumer. */
+        }
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg) {
+    (void) arg;
+    while (atomic_load(&consumed) < THREADS * ITEMS_PER_THREAD) {
+        int value = mpmc_queue_pop(shared);
+        if (value == -1) {
+            sched_yield(); /* Queue empty, wait for a producer. */
+            continue;
+        }
+        atomic_fetch_add(&seen[value], 1);
+        atomic_fetch_add(&consumed, 1);
+    }
+    return NULL;
+}
+
+/* Peek while the others push and pop. Every item seen must be one that
+ * was pushed. */
+static void *peeker(void *arg) {
+    atomic_int *bad = arg;
+    while (atomic_load(&consumed) < THREADS * ITEMS_PER_THREAD) {
+        int value = mpmc_queue_peek(shared);
+        if (value < -1 || value >= THREADS * ITEMS_PER_THREAD) {
+            atomic_fetch_add(bad, 1);
+        }
+    }
+    return NULL;
+}
+
+START_TEST(test_mpmc_queue_threads) {
+    pthread_t producers[THREADS];
+    pthread_t consumers[THREADS];
+    pthread_t peek_thread;
+    atomic_int bad;
+    int ids[THREADS];
+
+    shared = mpmc_queue_init(128);
+    ck_assert_ptr_nonnull(shared);
+    atomic_init(&bad, 0);
+
+    ck_assert_int_eq(pthread_create(&peek_thread, NULL, peeker, &bad), 0);
+    for (int i = 0; i < THREADS; i++) {
+        ids[i] = i;
+        ck_assert_int_eq(pthread_create(&consumers[i], NULL, consumer, NULL), 0);
+        ck_assert_int_eq(pthread_create(&producers[i], NULL, producer, &ids[i]), 0);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+    }
+    pthread_join(peek_thread, NULL);
+    ck_assert_int_eq(atomic_load(&bad), 0);
+
+    /* Every item must have been popped exactly once. */
+    for (int i = 0; i < THREADS * ITEMS_PER_THREAD; i++) {
+        ck_assert_int_eq(atomic_load(&seen[i]), 1);
+    }
+    ck_assert_int_eq(mpmc_queue_empty(shared), 1);
+    mpmc_queue_cleanup(shared);
+}
+END_TEST
+
+START_TEST(test_mpmc_queue_null_ptr) {
+    mpmc_queue_cleanup(NULL);
+    mpmc_queue_stats(NULL);
+    ck_assert_int_eq(mpmc_queue_push(NULL, 'x'), 1);
+    ck_assert_int_eq(mpmc_queue_pop(NULL), -1);
+    ck_assert_int_eq(mpmc_queue_peek(NULL), -1);
+    ck_assert_int_eq(mpmc_queue_empty(NULL), -1);
+}
+END_TEST
+
+Suite *mpmc_queue_suite(void) {
+    Suite *s;
+    TCase *tc_core;
+    TCase *tc_threads;
+    s = suite_create("mpmc queue");
+
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_mpmc_queue_init_cleanup);
+    tcase_add_test(tc_core, test_mpmc_queue_init_huge);
+    tcase_add_test(tc_core, test_mpmc_queue_order);
+    tcase_add_test(tc_core, test_mpmc_queue_full);
+    tcase_add_test(tc_core, test_mpmc_queue_null_ptr);
+
+    tc_threads = tcase_create("Threads");
+    tcase_set_timeout(tc_threads, 30);
+    tcase_add_test(tc_threads, test_mpmc_queue_threads);
+
+    suite_add_tcase(s, tc_core);
+    suite_add_tcase(s, tc_threads);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = mpmc_queue_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
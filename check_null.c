@@ -2,8 +2,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-#include "queue.h"
-#include "stack.h"
+#include "queue_ext.h"
+#include "stack_ext.h"
 
 /* For older versions of the check library */
 #ifndef ck_assert_ptr_nonnull
@@ -23,6 +23,12 @@ START_TEST(test_stack_stats) {
 }
 END_TEST
 
+START_TEST(test_stack_get_stats) {
+    struct container_stats stats;
+    ck_assert_int_eq(stack_get_stats(NULL, &stats), 1);
+}
+END_TEST
+
 START_TEST(test_stack_push) {
     ck_assert_int_eq(stack_push(NULL, 0), 1);
 }
@@ -58,6 +64,12 @@ START_TEST(test_queue_stats) {
 }
 END_TEST
 
+START_TEST(test_queue_get_stats) {
+    struct container_stats stats;
+    ck_assert_int_eq(queue_get_stats(NULL, &stats), 1);
+}
+END_TEST
+
 START_TEST(test_queue_push) {
     ck_assert_int_eq(queue_push(NULL, 2), 1);
 }
@@ -92,6 +104,7 @@ Suite *null_suite(void) {
     tc_stack = tcase_create("Stack");
     tcase_add_test(tc_stack, test_stack_cleanup);
     tcase_add_test(tc_stack, test_stack_stats);
+    tcase_add_test(tc_stack, test_stack_get_stats);
     tcase_add_test(tc_stack, test_stack_push);
     tcase_add_test(tc_stack, test_stack_pop);
     tcase_add_test(tc_stack, test_stack_peek);
@@ -101,6 +114,7 @@ Suite *null_suite(void) {
     tc_queue = tcase_create("Queue");
     tcase_add_test(tc_queue, test_queue_cleanup);
     tcase_add_test(tc_queue, test_queue_stats);
+    tcase_add_test(tc_queue, test_queue_get_stats);
     tcase_add_test(tc_queue, test_queue_push);
     tcase_add_test(tc_queue, test_queue_pop);
     tcase_add_test(tc_queue, test_queue_peek);
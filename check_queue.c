@@ -2,7 +2,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-#include "queue.h"
+#include "queue_ext.h"
 
 /* For older versions of the check library */
 #ifndef ck_assert_ptr_nonnull
@@ -245,6 +245,35 @@ START_TEST(test_queue_multiple_queues) {
 }
 END_TEST
 
+START_TEST(test_queue_get_stats) {
+    struct queue *q = queue_init(4);
+    struct container_stats stats;
+
+    for (int i = 0; i < 5000; i++) {
+        ck_assert_int_eq(queue_push(q, i), 0);
+    }
+    for (int i = 0; i < 5000; i++) {
+        ck_assert_int_eq(queue_pop(q), i);
+    }
+    ck_assert_int_eq(queue_pop(q), -1);
+    ck_assert_int_eq(queue_pop(q), -1);
+
+    ck_assert_int_eq(queue_get_stats(q, &stats), 0);
+    ck_assert_int_eq(stats.push, 5000);
+    ck_assert_int_eq(stats.pop, 5000);
+    ck_assert_int_eq(stats.max, 5000);
+    ck_assert_int_eq(stats.failed, 0);
+    ck_assert_int_eq(stats.empty_pops, 2);
+    ck_assert_int_gt(stats.resizes, 0);
+    ck_assert_int_gt(stats.capacity, 0);
+    ck_assert_int_ge(stats.peak_capacity, stats.capacity);
+    ck_assert_int_ge(stats.peak_bytes, stats.bytes);
+
+    ck_assert_int_eq(queue_get_stats(q, NULL), 1);
+    ck_assert_int_eq(queue_get_stats(NULL, &stats), 1);
+    queue_cleanup(q);
+}
+END_TEST
 
 START_TEST(test_queue_null_ptr) {
     ck_assert_int_eq(queue_push(NULL, 'x'), 1);
@@ -268,6 +297,7 @@ Suite *queue_suite(void) {
     tcase_add_test(tc_core, test_queue_push_pop);
     tcase_add_test(tc_core, test_queue_peek);
     tcase_add_test(tc_core, test_queue_empty);
+    tcase_add_test(tc_core, test_queue_get_stats);
 
     tc_limits = tcase_create("Limits");
     tcase_add_test(tc_limits, test_queue_overflow);
@@ -0,0 +1,200 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "solver_pipeline.h"
+
+#define MAX_MAZES 16
+
+/* What the callbacks of the tests saw, in the order they saw it. */
+struct seen {
+    int sizes[MAX_MAZES];
+    int results[MAX_MAZES];
+    int emitted;
+    int fail_size;
+};
+
+/* Write an open maze of size 'n', walls only on the border, to 'fp'. */
+static void write_maze(FILE *fp, int n) {
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            char ch = FLOOR;
+            if (r == 0 || c == 0 || r == n - 1 || c == n - 1) {
+                ch = WALL;
+            } else if (r == 1 && c == 1) {
+                ch = 'S';
+            } else if (r == n - 2 && c == n - 2) {
+                ch = 'D';
+            }
+            fputc(ch, fp);
+        }
+        fputc('\n', fp);
+    }
+}
+
+/* Make stdin read the mazes of the sizes in 'sizes', separated by blank
+ * lines, followed by 'tail'. */
+static void feed(const int *sizes, int count, const char *tail) {
+    FILE *fp = tmpfile();
+    ck_assert_ptr_ne(fp, NULL);
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            fputc('\n', fp);
+        }
+        write_maze(fp, sizes[i]);
+    }
+    fputs(tail, fp);
+    rewind(fp);
+    ck_assert_int_ne(dup2(fileno(fp), 0), -1);
+    fclose(fp);
+    clearerr(stdin);
+}
+
+static int solve(void *ctx, struct maze *m) {
+    (void) ctx;
+    return maze_size(m) * 10;
+}
+
+static int emit(void *ctx, struct maze *m, int result) {
+    struct seen *seen = ctx;
+    ck_assert_int_lt(seen->emitted, MAX_MAZES);
+    seen->sizes[seen->emitted] = maze_size(m);
+    seen->results[seen->emitted] = result;
+    seen->emitted++;
+    return maze_size(m) == seen->fail_size;
+}
+
+START_TEST(test_pipeline_order) {
+    int sizes[] = { 5, 7, 9, 11, 13, 15, 17, 19 };
+    struct seen seen = { { 0 }, { 0 }, 0, 0 };
+    struct solver_pipeline p = { solve, emit, &seen, 3, 0, 0, 0, 0 };
+
+    feed(sizes, 8, "\n\n");
+    ck_assert_int_eq(solver_pipeline_run(&p), 0);
+    ck_assert_int_eq(p.mazes, 8);
+    ck_assert_int_eq(seen.emitted, 8);
+    for (int i = 0; i < 8; i++) {
+        ck_assert_int_eq(seen.sizes[i], sizes[i]);
+        ck_assert_int_eq(seen.results[i], sizes[i] * 10);
+    }
+    ck_assert(p.parse >= 0 && p.solve_time >= 0 && p.emit_time >= 0);
+}
+END_TEST
+
+START_TEST(test_pipeline_depth_one) {
+    int sizes[] = { 9, 5, 7 };
+    struct seen seen = { { 0 }, { 0 }, 0, 0 };
+    struct solver_pipeline p = { solve, emit, &seen, 1, 0, 0, 0, 0 };
+
+    feed(sizes, 3, "");
+    ck_assert_int_eq(solver_pipeline_run(&p), 0);
+    ck_assert_int_eq(seen.emitted, 3);
+    ck_assert_int_eq(seen.sizes[0], 9);
+    ck_assert_int_eq(seen.sizes[2], 7);
+}
+END_TEST
+
+/* Solve slowly without using the processor. */
+static int solve_sleeping(void *ctx, struct maze *m) {
+    struct timespec ts = { 0, 50 * 1000 * 1000 };
+    nanosleep(&ts, NULL);
+    return solve(ctx, m);
+}
+
+START_TEST(test_pipeline_sleeps) {
+    int sizes[] = { 5, 7, 9, 11 };
+    struct seen seen = { { 0 }, { 0 }, 0, 0 };
+    struct solver_pipeline p = { solve_sleeping, emit, &seen, 3, 0, 0, 0, 0 };
+
+    /* The reader and the writer sleep while they wait for the solver, so
+     * the batch takes far less processor time than its 200 ms. */
+    feed(sizes, 4, "");
+    clock_t start = clock();
+    ck_assert_int_eq(solver_pipeline_run(&p), 0);
+    double seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+    ck_assert_int_eq(seen.emitted, 4);
+    ck_assert(seconds < 0.1);
+}
+END_TEST
+
+START_TEST(test_pipeline_not_found) {
+    int sizes[] = { 5, 7, 9 };
+    struct seen seen = { { 0 }, { 0 }, 0, 7 };
+    struct solver_pipeline p = { solve, emit, &seen, 4, 0, 0, 0, 0 };
+
+    /* One maze without a path fails the batch, but not the others. */
+    feed(sizes, 3, "");
+    ck_assert_int_eq(solver_pipeline_run(&p), 1);
+    ck_assert_int_eq(seen.emitted, 3);
+}
+END_TEST
+
+START_TEST(test_pipeline_bad_maze) {
+    int sizes[] = { 5, 7 };
+    struct seen seen = { { 0 }, { 0 }, 0, 0 };
+    struct solver_pipeline p = { solve, emit, &seen, 4, 0, 0, 0, 0 };
+
+    /* A maze with more columns than rows ends the batch. */
+    feed(sizes, 2, "\n#####\n#S D#\n\n#####\n");
+    ck_assert_int_eq(solver_pipeline_run(&p), 1);
+    ck_assert_int_eq(p.mazes, 2);
+    ck_assert_int_eq(seen.emitted, 2);
+
+    feed(sizes, 0, "");
+    ck_assert_int_eq(solver_pipeline_run(&p), 1);
+    ck_assert_int_eq(p.mazes, 0);
+    ck_assert_int_eq(seen.emitted, 2);
+}
+END_TEST
+
+START_TEST(test_pipeline_null) {
+    struct seen seen = { { 0 }, { 0 }, 0, 0 };
+    struct solver_pipeline p = { solve, emit, &seen, 0, 0, 0, 0, 0 };
+
+    ck_assert_int_eq(solver_pipeline_run(NULL), 1);
+    ck_assert_int_eq(solver_pipeline_run(&p), 1);
+    p.depth = 2;
+    p.solve = NULL;
+    ck_assert_int_eq(solver_pipeline_run(&p), 1);
+    p.solve = solve;
+    p.emit = NULL;
+    ck_assert_int_eq(solver_pipeline_run(&p), 1);
+    ck_assert_int_eq(seen.emitted, 0);
+}
+END_TEST
+
+Suite *solver_pipeline_suite(void) {
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("solver pipeline");
+
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_pipeline_order);
+    tcase_add_test(tc_core, test_pipeline_depth_one);
+    tcase_add_test(tc_core, test_pipeline_sleeps);
+    tcase_add_test(tc_core, test_pipeline_not_found);
+    tcase_add_test(tc_core, test_pipeline_bad_maze);
+    tcase_add_test(tc_core, test_pipeline_null);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = solver_pipeline_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,131 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "solver_report.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+
+/* Read everything written to 'fp' into 'buf'. */
+static void read_back(FILE *fp, char *buf, size_t size) {
+    rewind(fp);
+    size_t n = fread(buf, 1, size - 1, fp);
+    buf[n] = '\0';
+    fclose(fp);
+}
+
+START_TEST(test_report_init) {
+    struct solver_report report;
+
+    solver_report_init(&report, "bfs");
+    ck_assert_str_eq(report.solver, "bfs");
+    ck_assert_int_eq(report.path_length, -1);
+    ck_assert_int_eq(report.expanded, 0);
+    ck_assert_int_eq(report.extra_bytes, 0);
+    ck_assert_int_eq(report.n_containers, 0);
+}
+END_TEST
+
+START_TEST(test_report_print) {
+    struct solver_report report;
+    struct container_stats a = { .push = 5, .max = 3, .peak_bytes = 64 };
+    struct container_stats b = { .push = 7, .max = 2, .peak_bytes = 32 };
+    char buf[1024];
+    FILE *fp = tmpfile();
+    ck_assert_ptr_nonnull(fp);
+
+    solver_report_init(&report, "bfs");
+    report.path_length = 12;
+    report.parse = 0.5;
+    report.solve = 0.25;
+    report.render = 0.125;
+    report.expanded = 40;
+    report.extra_bytes = 1000;
+    ck_assert_int_eq(solver_report_add(&report, "rqueue", &a), 0);
+    ck_assert_int_eq(solver_report_add(&report, "cqueue", &b), 0);
+    ck_assert_int_eq(solver_report_print(fp, &report), 0);
+    read_back(fp, buf, sizeof(buf));
+
+    ck_assert(strncmp(buf, "report solver=bfs path=12 parse=0.500000 "
+                           "solve=0.250000 render=0.125000 maxrss_kb=",
+                      strlen("report solver=bfs path=12 parse=0.500000 "
+                             "solve=0.250000 render=0.125000 maxrss_kb="))
+              == 0);
+    ck_assert_ptr_nonnull(strstr(buf, " expanded=40 extra_bytes=1000 "
+                                      "push=12 max=5 peak_bytes=96\n"));
+    ck_assert_ptr_nonnull(strstr(buf, "\n{\"name\":\"rqueue\",\"push\":5,"));
+    ck_assert_ptr_nonnull(strstr(buf, "\n{\"name\":\"cqueue\",\"push\":7,"));
+}
+END_TEST
+
+START_TEST(test_report_full) {
+    struct solver_report report;
+    struct container_stats stats = { 0 };
+
+    solver_report_init(&report, "dfs");
+    for (int i = 0; i < SOLVER_REPORT_MAX_CONTAINERS; i++) {
+        ck_assert_int_eq(solver_report_add(&report, "stack", &stats), 0);
+    }
+    ck_assert_int_eq(solver_report_add(&report, "stack", &stats), 1);
+    ck_assert_int_eq(report.n_containers, SOLVER_REPORT_MAX_CONTAINERS);
+}
+END_TEST
+
+START_TEST(test_report_null) {
+    struct solver_report report;
+    struct container_stats stats = { 0 };
+
+    solver_report_init(NULL, "bfs");
+    solver_report_init(&report, NULL);
+    ck_assert_int_eq(solver_report_print(stderr, &report), 1);
+    ck_assert_int_eq(solver_report_print(NULL, &report), 1);
+    ck_assert_int_eq(solver_report_print(stderr, NULL), 1);
+    ck_assert_int_eq(solver_report_add(NULL, "x", &stats), 1);
+    ck_assert_int_eq(solver_report_add(&report, NULL, &stats), 1);
+    ck_assert_int_eq(solver_report_add(&report, "x", NULL), 1);
+}
+END_TEST
+
+START_TEST(test_report_clock) {
+    double a = solver_report_now();
+    double b = solver_report_now();
+
+    ck_assert(a > 0.0);
+    ck_assert(b >= a);
+}
+END_TEST
+
+Suite *solver_report_suite(void) {
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("solver report");
+
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_report_init);
+    tcase_add_test(tc_core, test_report_print);
+    tcase_add_test(tc_core, test_report_full);
+    tcase_add_test(tc_core, test_report_null);
+    tcase_add_test(tc_core, test_report_clock);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = solver_report_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
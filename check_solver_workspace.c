@@ -0,0 +1,224 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "solver_workspace.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+#ifndef ck_assert_ptr_null
+#define ck_assert_ptr_null(X) _ck_assert_ptr(X, ==, NULL)
+#endif
+
+/* Read an open maze of size 'n', walls only on the border, from stdin. */
+static struct maze *read_maze(int n) {
+    FILE *fp = tmpfile();
+    ck_assert_ptr_nonnull(fp);
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            char ch = FLOOR;
+            if (r == 0 || c == 0 || r == n - 1 || c == n - 1) {
+                ch = WALL;
+            } else if (r == 1 && c == 1) {
+                ch = 'S';
+            } else if (r == n - 2 && c == n - 2) {
+                ch = 'D';
+            }
+            fputc(ch, fp);
+        }
+        fputc('\n', fp);
+    }
+    rewind(fp);
+    ck_assert_int_ne(dup2(fileno(fp), 0), -1);
+    fclose(fp);
+    clearerr(stdin);
+
+    struct maze *m = maze_read();
+    ck_assert_ptr_nonnull(m);
+    return m;
+}
+
+/* Return a stream that reads 'text'. */
+static FILE *stream(const char *text) {
+    FILE *fp = tmpfile();
+    ck_assert_ptr_nonnull(fp);
+    fputs(text, fp);
+    rewind(fp);
+    return fp;
+}
+
+START_TEST(test_workspace_load) {
+    struct solver_workspace w;
+    struct maze *m = read_maze(9);
+
+    solver_workspace_init(&w);
+    ck_assert_int_eq(solver_workspace_bytes(&w), 0);
+    ck_assert_int_eq(solver_workspace_load(&w, m), 0);
+    ck_assert_int_eq(w.grows, 1);
+    ck_assert_int_eq(w.flat.n, 9);
+    ck_assert_int_eq(w.pred.n, 9);
+    ck_assert_int_eq(solver_workspace_bytes(&w),
+                     maze_flat_bytes(9) + maze_pred_bytes(9));
+
+    /* The copy is that of maze_flat_load(). */
+    ck_assert_int_eq(maze_flat_get(&w.flat, maze_flat_index(&w.flat, 0, 4)),
+                     WALL);
+    ck_assert_int_eq(maze_flat_get(&w.flat, maze_flat_index(&w.flat, 4, 4)),
+                     FLOOR);
+    ck_assert_int_eq(maze_flat_get(&w.flat, -1), WALL);
+    ck_assert_int_eq(maze_flat_get(&w.flat, 9 * 9), WALL);
+
+    solver_workspace_cleanup(&w);
+    ck_assert_ptr_null(w.cells);
+    ck_assert_int_eq(solver_workspace_bytes(&w), 0);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_workspace_reuse) {
+    struct solver_workspace w;
+    struct maze *small = read_maze(7);
+    struct maze *large = read_maze(21);
+
+    solver_workspace_init(&w);
+    ck_assert_int_eq(solver_workspace_load(&w, small), 0);
+    ck_assert_int_eq(solver_workspace_load(&w, large), 0);
+    ck_assert_int_eq(w.grows, 2);
+    size_t bytes = solver_workspace_bytes(&w);
+    char *cells = w.cells;
+
+    /* Marks of the last search do not survive the next load. */
+    maze_flat_set(&w.flat, maze_flat_index(&w.flat, 3, 3), VISITED);
+    maze_pred_set(&w.pred, maze_flat_index(&w.flat, 3, 3), 2);
+
+    /* A smaller maze fits in the memory that is already there. */
+    ck_assert_int_eq(solver_workspace_load(&w, small), 0);
+    ck_assert_int_eq(solver_workspace_load(&w, large), 0);
+    ck_assert_int_eq(w.grows, 2);
+    ck_assert_int_eq(solver_workspace_bytes(&w), bytes);
+    ck_assert_ptr_eq(w.cells, cells);
+    ck_assert_int_eq(w.flat.n, 21);
+    ck_assert_int_eq(maze_flat_get(&w.flat, maze_flat_index(&w.flat, 3, 3)),
+                     FLOOR);
+
+    solver_workspace_cleanup(&w);
+    maze_cleanup(small);
+    maze_cleanup(large);
+}
+END_TEST
+
+START_TEST(test_workspace_reserve) {
+    struct solver_workspace w;
+    struct maze *m = read_maze(21);
+
+    /* Only the predecessors, no copy of the maze. */
+    solver_workspace_init(&w);
+    ck_assert_int_eq(solver_workspace_reserve(&w, m), 0);
+    ck_assert_ptr_null(w.cells);
+    ck_assert_ptr_nonnull(w.pred.bits);
+    ck_assert_int_eq(w.pred.n, 21);
+    ck_assert_int_eq(solver_workspace_bytes(&w), maze_pred_bytes(21));
+    ck_assert_int_eq(solver_workspace_reserve(&w, m), 0);
+    ck_assert_int_eq(w.grows, 1);
+    solver_workspace_cleanup(&w);
+
+    /* Growing the predecessors leaves the loaded cells alone. */
+    struct maze *small = read_maze(7);
+    solver_workspace_init(&w);
+    ck_assert_int_eq(solver_workspace_load(&w, small), 0);
+    const void *cells = w.cells;
+    size_t cells_size = w.cells_size;
+    ck_assert_int_eq(solver_workspace_reserve(&w, m), 0);
+    ck_assert_ptr_eq(w.cells, cells);
+    ck_assert_int_eq(w.flat.n, 7);
+    ck_assert_int_eq(w.cells_size, cells_size);
+    ck_assert_int_eq(w.pred_size, maze_pred_bytes(21));
+    ck_assert_int_eq(w.grows, 2);
+
+    /* A smaller maze never shrinks either size. */
+    ck_assert_int_eq(solver_workspace_reserve(&w, small), 0);
+    ck_assert_int_eq(w.cells_size, cells_size);
+    ck_assert_int_eq(w.pred_size, maze_pred_bytes(21));
+    ck_assert_int_eq(w.pred.n, 7);
+    ck_assert_int_eq(w.grows, 2);
+    maze_cleanup(small);
+
+    ck_assert_int_eq(solver_workspace_reserve(NULL, m), 1);
+    ck_assert_int_eq(solver_workspace_reserve(&w, NULL), 1);
+    solver_workspace_cleanup(&w);
+    maze_cleanup(m);
+}
+END_TEST
+
+START_TEST(test_batch_next) {
+    FILE *fp = stream("\n\n#S#\n");
+    ck_assert(solver_batch_next(fp));
+    ck_assert_int_eq(getc(fp), '#');
+    fclose(fp);
+
+    fp = stream("#");
+    ck_assert(solver_batch_next(fp));
+    fclose(fp);
+
+    fp = stream("\n\n");
+    ck_assert(!solver_batch_next(fp));
+    fclose(fp);
+
+    fp = stream("");
+    ck_assert(!solver_batch_next(fp));
+    fclose(fp);
+}
+END_TEST
+
+START_TEST(test_workspace_null) {
+    struct solver_workspace w;
+    struct maze *m = read_maze(7);
+
+    solver_workspace_init(&w);
+    solver_workspace_init(NULL);
+    ck_assert_int_eq(solver_workspace_load(NULL, m), 1);
+    ck_assert_int_eq(solver_workspace_load(&w, NULL), 1);
+    ck_assert_int_eq(solver_workspace_bytes(NULL), 0);
+    ck_assert(!solver_batch_next(NULL));
+    solver_workspace_cleanup(&w);
+    solver_workspace_cleanup(&w);
+    solver_workspace_cleanup(NULL);
+    maze_cleanup(m);
+}
+END_TEST
+
+Suite *solver_workspace_suite(void) {
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("solver workspace");
+
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_workspace_load);
+    tcase_add_test(tc_core, test_workspace_reuse);
+    tcase_add_test(tc_core, test_workspace_reserve);
+    tcase_add_test(tc_core, test_batch_next);
+    tcase_add_test(tc_core, test_workspace_null);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = solver_workspace_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,160 @@
+#include <check.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "spsc_queue.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+#ifndef ck_assert_ptr_null
+#define ck_assert_ptr_null(X) _ck_assert_ptr(X, ==, NULL)
+#endif
+
+#define THREADED_ITEMS 1000000
+
+START_TEST(test_spsc_queue_init_cleanup) {
+    struct spsc_queue *q = spsc_queue_init(10);
+    ck_assert_ptr_nonnull(q);
+    spsc_queue_cleanup(q);
+}
+END_TEST
+
+START_TEST(test_spsc_queue_init_huge) {
+    /* No power of two this large fits in a size_t. */
+    ck_assert_ptr_null(spsc_queue_init(SIZE_MAX / 2 + 2));
+    ck_assert_ptr_null(spsc_queue_init(SIZE_MAX));
+
+    /* A power of two, but too many items for a size_t of bytes. */
+    ck_assert_ptr_null(spsc_queue_init(SIZE_MAX / 4));
+}
+END_TEST
+
+START_TEST(test_spsc_queue_order) {
+    struct spsc_queue *q = spsc_queue_init(10);
+    ck_assert_int_eq(spsc_queue_push(q, 'x'), 0);
+    ck_assert_int_eq(spsc_queue_push(q, 'y'), 0);
+    ck_assert_int_eq(spsc_queue_push(q, 'z'), 0);
+
+    ck_assert_int_eq(spsc_queue_peek(q), 'x');
+    ck_assert_int_eq(spsc_queue_pop(q), 'x');
+    ck_assert_int_eq(spsc_queue_pop(q), 'y');
+    ck_assert_int_eq(spsc_queue_size(q), 1);
+    ck_assert_int_eq(spsc_queue_pop(q), 'z');
+    ck_assert_int_eq(spsc_queue_empty(q), 1);
+    spsc_queue_cleanup(q);
+}
+END_TEST
+
+START_TEST(test_spsc_queue_full) {
+    struct spsc_queue *q = spsc_queue_init(5); /* Rounded up to 8. */
+    for (int i = 0; i < 8; i++) {
+        ck_assert_int_eq(spsc_queue_push(q, i), 0);
+    }
+    ck_assert_int_eq(spsc_queue_push(q, 8), 1);
+
+    ck_assert_int_eq(spsc_queue_pop(q), 0);
+    ck_assert_int_eq(spsc_queue_push(q, 8), 0);
+
+    for (int i = 1; i <= 8; i++) {
+        ck_assert_int_eq(spsc_queue_pop(q), i);
+    }
+    ck_assert_int_eq(spsc_queue_pop(q), -1);
+    ck_assert_int_eq(spsc_queue_peek(q), -1);
+    spsc_queue_cleanup(q);
+}
+END_TEST
+
+START_TEST(test_spsc_queue_wrap_around) {
+    struct spsc_queue *q = spsc_queue_init(4);
+    for (int i = 0; i < 1000; i++) {
+        ck_assert_int_eq(spsc_queue_push(q, i), 0);
+        ck_assert_int_eq(spsc_queue_push(q, -i), 0);
+        ck_assert_int_eq(spsc_queue_pop(q), i);
+        ck_assert_int_eq(spsc_queue_pop(q), -i);
+    }
+    ck_assert_int_eq(spsc_queue_empty(q), 1);
+    spsc_queue_cleanup(q);
+}
+END_TEST
+
+static void *producer(void *arg) {
+    struct spsc_queue *q = arg;
+    for (int i = 0; i < THREADED_ITEMS; i++) {
+        while (spsc_queue_push(q, i)) {
+            sched_yield(); /* Queue full, wait for the consumer. */
+        }
+    }
+    return NULL;
+}
+
+START_TEST(test_spsc_queue_threads) {
+    struct spsc_queue *q = spsc_queue_init(64);
+    pthread_t thread;
+    ck_assert_int_eq(pthread_create(&thread, NULL, producer, q), 0);
+
+    for (int i = 0; i < THREADED_ITEMS; i++) {
+        int value;
+        while ((value = spsc_queue_pop(q)) == -1) {
+            sched_yield(); /* Queue empty, wait for the producer. */
+        }
+        ck_assert_int_eq(value, i);
+    }
+
+    pthread_join(thread, NULL);
+    ck_assert_int_eq(spsc_queue_empty(q), 1);
+    spsc_queue_cleanup(q);
+}
+END_TEST
+
+START_TEST(test_spsc_queue_null_ptr) {
+    spsc_queue_cleanup(NULL);
+    spsc_queue_stats(NULL);
+    ck_assert_int_eq(spsc_queue_push(NULL, 'x'), 1);
+    ck_assert_int_eq(spsc_queue_pop(NULL), -1);
+    ck_assert_int_eq(spsc_queue_peek(NULL), -1);
+    ck_assert_int_eq(spsc_queue_empty(NULL), -1);
+}
+END_TEST
+
+Suite *spsc_queue_suite(void) {
+    Suite *s;
+    TCase *tc_core;
+    TCase *tc_threads;
+    s = suite_create("spsc queue");
+
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_spsc_queue_init_cleanup);
+    tcase_add_test(tc_core, test_spsc_queue_init_huge);
+    tcase_add_test(tc_core, test_spsc_queue_order);
+    tcase_add_test(tc_core, test_spsc_queue_full);
+    tcase_add_test(tc_core, test_spsc_queue_wrap_around);
+    tcase_add_test(tc_core, test_spsc_queue_null_ptr);
+
+    tc_threads = tcase_create("Threads");
+    tcase_set_timeout(tc_threads, 30);
+    tcase_add_test(tc_threads, test_spsc_queue_threads);
+
+    suite_add_tcase(s, tc_core);
+    suite_add_tcase(s, tc_threads);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = spsc_queue_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,162 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "terrain.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+#ifndef ck_assert_ptr_null
+#define ck_assert_ptr_null(X) _ck_assert_ptr(X, ==, NULL)
+#endif
+
+static const char *weighted = "#####\n"
+                              "#S3 #\n"
+                              "# #9#\n"
+                              "#1 D#\n"
+                              "##7##\n";
+
+static const char *conveyor = "#####\n"
+                              "#S00#\n"
+                              "# #0#\n"
+                              "#  D#\n"
+                              "#####\n";
+
+/* Return a stream that reads 'text'. */
+static FILE *stream(const char *text) {
+    FILE *fp = tmpfile();
+    ck_assert_ptr_nonnull(fp);
+    fputs(text, fp);
+    rewind(fp);
+    return fp;
+}
+
+static struct terrain *read_text(const char *text) {
+    FILE *fp = stream(text);
+    struct terrain *t = terrain_read(fp);
+    fclose(fp);
+    return t;
+}
+
+START_TEST(test_terrain_cost) {
+    ck_assert_int_eq(terrain_cost(WALL), TERRAIN_WALL);
+    ck_assert_int_eq(terrain_cost(FLOOR), 1);
+    ck_assert_int_eq(terrain_cost('1'), 1);
+    ck_assert_int_eq(terrain_cost('5'), 5);
+    ck_assert_int_eq(terrain_cost('9'), TERRAIN_MAX_COST);
+    ck_assert_int_eq(terrain_cost('0'), 0);
+    ck_assert_int_eq(terrain_cost('S'), 1);
+}
+END_TEST
+
+START_TEST(test_terrain_read) {
+    struct terrain *t = read_text(weighted);
+    ck_assert_ptr_nonnull(t);
+
+    ck_assert_int_eq(t->n, 5);
+    ck_assert_int_eq(t->start, 1 * 5 + 1);
+    ck_assert_int_eq(t->destination, 3 * 5 + 3);
+    ck_assert_int_eq(t->max_cost, 9);
+    ck_assert_int_eq(t->cost[t->start], 1);
+    ck_assert_int_eq(t->cost[t->destination], 1);
+    ck_assert_int_eq(t->cost[1 * 5 + 2], 3);
+    ck_assert_int_eq(t->cost[1 * 5 + 3], 1);
+    ck_assert_int_eq(t->cost[2 * 5 + 2], TERRAIN_WALL);
+    ck_assert_int_eq(t->cost[2 * 5 + 3], 9);
+    ck_assert_int_eq(t->cells[t->start], FLOOR);
+    ck_assert_int_eq(t->cells[1 * 5 + 2], '3');
+
+    /* The border cannot be entered. */
+    ck_assert_int_eq(t->cost[4 * 5 + 2], TERRAIN_WALL);
+    ck_assert_int_eq(t->cells[4 * 5 + 2], '7');
+
+    terrain_cleanup(t);
+}
+END_TEST
+
+START_TEST(test_terrain_zero_cost) {
+    struct terrain *t = read_text(conveyor);
+    ck_assert_ptr_nonnull(t);
+
+    /* Walls do not count towards the highest cost. */
+    ck_assert_int_eq(t->max_cost, 1);
+    ck_assert_int_eq(t->cost[1 * 5 + 2], 0);
+    ck_assert_int_eq(t->cost[2 * 5 + 3], 0);
+    ck_assert_int_eq(t->cost[3 * 5 + 1], 1);
+    ck_assert_int_eq(t->cost[2 * 5 + 2], TERRAIN_WALL);
+    terrain_cleanup(t);
+}
+END_TEST
+
+START_TEST(test_terrain_print) {
+    struct terrain *t = read_text(weighted);
+    char buf[64];
+    ck_assert_ptr_nonnull(t);
+
+    t->cells[1 * 5 + 2] = PATH;
+    FILE *fp = tmpfile();
+    ck_assert_ptr_nonnull(fp);
+    ck_assert_int_eq(terrain_print(t, fp), 0);
+    rewind(fp);
+    size_t n = fread(buf, 1, sizeof(buf) - 1, fp);
+    buf[n] = '\0';
+    fclose(fp);
+
+    ck_assert_str_eq(buf, "#####\n"
+                          "#Sx #\n"
+                          "# #9#\n"
+                          "#1 D#\n"
+                          "##7##\n"
+                          "\n");
+    terrain_cleanup(t);
+}
+END_TEST
+
+START_TEST(test_terrain_errors) {
+    /* More rows than columns, fewer rows, a short row, two starts, no
+     * destination and an empty file. */
+    ck_assert_ptr_null(read_text("###\n#SD\n###\n###\n"));
+    ck_assert_ptr_null(read_text("####\n#SD#\n####\n"));
+    ck_assert_ptr_null(read_text("###\n#S\n#D#\n"));
+    ck_assert_ptr_null(read_text("####\n#SS#\n#D #\n####\n"));
+    ck_assert_ptr_null(read_text("###\n#S#\n###\n"));
+    ck_assert_ptr_null(read_text(""));
+    ck_assert_ptr_null(terrain_read(NULL));
+    ck_assert_int_eq(terrain_print(NULL, stdout), 1);
+    terrain_cleanup(NULL);
+}
+END_TEST
+
+Suite *terrain_suite(void) {
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("terrain");
+
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_terrain_cost);
+    tcase_add_test(tc_core, test_terrain_read);
+    tcase_add_test(tc_core, test_terrain_zero_cost);
+    tcase_add_test(tc_core, test_terrain_print);
+    tcase_add_test(tc_core, test_terrain_errors);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = terrain_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
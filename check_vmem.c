@@ -0,0 +1,203 @@
+// Needed for mincore()
+#define _DEFAULT_SOURCE
+
+#include <check.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "queue_ext.h"
+#include "stack_ext.h"
+#include "vmem.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+#ifndef ck_assert_ptr_null
+#define ck_assert_ptr_null(X) _ck_assert_ptr(X, ==, NULL)
+#endif
+
+/* Far more than ever gets touched, to check that reserving is cheap. */
+#define HUGE_CAPACITY ((size_t) 1 << 30)
+
+START_TEST(test_vmem_reserve) {
+    size_t size = 3 * vmem_page_size() + 1;
+    unsigned char *p = vmem_reserve(size, false);
+    ck_assert_ptr_nonnull(p);
+
+    for (size_t i = 0; i < size; i++) {
+        ck_assert_int_eq(p[i], 0);
+    }
+    memset(p, 0xab, size);
+    ck_assert_int_eq(p[size - 1], 0xab);
+
+    /* Discarded pages read as zeros again. */
+    vmem_discard(p, size);
+    ck_assert_int_eq(p[0], 0);
+    ck_assert_int_eq(p[2 * vmem_page_size()], 0);
+    vmem_release(p, size, false);
+}
+END_TEST
+
+START_TEST(test_vmem_huge) {
+    size_t size = (size_t) 4 << 20;
+    unsigned char *p = vmem_reserve(size, true);
+    ck_assert_ptr_nonnull(p);
+    ck_assert_int_eq((size_t) p % ((size_t) 2 << 20), 0);
+
+    p[0] = 1;
+    p[size - 1] = 2;
+    ck_assert_int_eq(p[0] + p[size - 1], 3);
+    vmem_release(p, size, true);
+}
+END_TEST
+
+START_TEST(test_vmem_huge_release) {
+    /* Rounded up to one whole huge page by vmem_reserve(). */
+    size_t huge = (size_t) 2 << 20;
+    size_t size = (huge >> 1) + 3;
+    unsigned char *p = vmem_reserve(size, true);
+    ck_assert_ptr_nonnull(p);
+    p[size - 1] = 1;
+    vmem_release(p, size, true);
+
+    /* The last page of the huge page is gone too. */
+    unsigned char vec;
+    errno = 0;
+    ck_assert_int_eq(mincore(p + huge - vmem_page_size(), vmem_page_size(),
+                             &vec), -1);
+    ck_assert_int_eq(errno, ENOMEM);
+}
+END_TEST
+
+START_TEST(test_vmem_zero) {
+    ck_assert_ptr_null(vmem_reserve(0, false));
+    vmem_release(NULL, 0, false);
+}
+END_TEST
+
+START_TEST(test_stack_mapped) {
+    struct stack *s = stack_init_mapped(HUGE_CAPACITY, false);
+    ck_assert_ptr_nonnull(s);
+
+    for (int i = 0; i < 100000; i++) {
+        ck_assert_int_eq(stack_push(s, i), 0);
+    }
+    ck_assert_int_eq(stack_peek(s), 99999);
+    for (int i = 99999; i >= 0; i--) {
+        ck_assert_int_eq(stack_pop(s), i);
+    }
+    ck_assert_int_eq(stack_empty(s), 1);
+    stack_cleanup(s);
+}
+END_TEST
+
+START_TEST(test_stack_mapped_full) {
+    struct stack *s = stack_init_mapped(3, true);
+    ck_assert_ptr_nonnull(s);
+
+    ck_assert_int_eq(stack_push(s, 1), 0);
+    ck_assert_int_eq(stack_push(s, 2), 0);
+    ck_assert_int_eq(stack_push(s, 3), 0);
+    ck_assert_int_eq(stack_push(s, 4), 1);
+    ck_assert_int_eq(stack_size(s), 3);
+    ck_assert_int_eq(stack_pop(s), 3);
+    stack_cleanup(s);
+}
+END_TEST
+
+START_TEST(test_queue_mapped) {
+    struct queue *q = queue_init_mapped(HUGE_CAPACITY, false);
+    ck_assert_ptr_nonnull(q);
+
+    for (int i = 0; i < 100000; i++) {
+        ck_assert_int_eq(queue_push(q, i), 0);
+    }
+    ck_assert_int_eq(queue_peek(q), 0);
+    for (int i = 0; i < 100000; i++) {
+        ck_assert_int_eq(queue_pop(q), i);
+    }
+    ck_assert_int_eq(queue_empty(q), 1);
+    queue_cleanup(q);
+}
+END_TEST
+
+START_TEST(test_queue_mapped_wrap) {
+    /* A small queue is rounded up to one discard span. */
+    struct queue *q = queue_init_mapped(1, true);
+    ck_assert_ptr_nonnull(q);
+
+    int pushed = 0;
+    while (queue_push(q, pushed) == 0) {
+        pushed++;
+    }
+    ck_assert_int_gt(pushed, 1);
+    ck_assert_int_eq(queue_size(q), (size_t) pushed);
+
+    /* Slide a window of half the ring around it several times, so spans
+     * are discarded behind the tail while the rest still holds items. */
+    int popped = 0;
+    for (int i = 0; i < pushed / 2; i++) {
+        ck_assert_int_eq(queue_pop(q), popped++);
+    }
+    for (int i = 0; i < pushed * 3; i++) {
+        ck_assert_int_eq(queue_pop(q), popped++);
+        ck_assert_int_eq(queue_push(q, pushed++), 0);
+    }
+    while (!queue_empty(q)) {
+        ck_assert_int_eq(queue_pop(q), popped++);
+    }
+    ck_assert_int_eq(popped, pushed);
+    queue_cleanup(q);
+}
+END_TEST
+
+START_TEST(test_mapped_errors) {
+    ck_assert_ptr_null(stack_init_mapped(0, false));
+    ck_assert_ptr_null(queue_init_mapped(0, false));
+    ck_assert_ptr_null(stack_init_mapped((size_t) -1, false));
+    ck_assert_ptr_null(queue_init_mapped((size_t) -1, false));
+}
+END_TEST
+
+Suite *vmem_suite(void) {
+    Suite *s;
+    TCase *tc_vmem;
+    TCase *tc_mapped;
+    s = suite_create("vmem");
+
+    tc_vmem = tcase_create("Vmem");
+    tcase_add_test(tc_vmem, test_vmem_reserve);
+    tcase_add_test(tc_vmem, test_vmem_huge);
+    tcase_add_test(tc_vmem, test_vmem_huge_release);
+    tcase_add_test(tc_vmem, test_vmem_zero);
+
+    tc_mapped = tcase_create("Mapped");
+    tcase_add_test(tc_mapped, test_stack_mapped);
+    tcase_add_test(tc_mapped, test_stack_mapped_full);
+    tcase_add_test(tc_mapped, test_queue_mapped);
+    tcase_add_test(tc_mapped, test_queue_mapped_wrap);
+    tcase_add_test(tc_mapped, test_mapped_errors);
+
+    suite_add_tcase(s, tc_vmem);
+    suite_add_tcase(s, tc_mapped);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = vmem_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,221 @@
+#include <check.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "wsdeque.h"
+
+/* For older versions of the check library */
+#ifndef ck_assert_ptr_nonnull
+#define ck_assert_ptr_nonnull(X) _ck_assert_ptr(X, !=, NULL)
+#endif
+#ifndef ck_assert_ptr_null
+#define ck_assert_ptr_null(X) _ck_assert_ptr(X, ==, NULL)
+#endif
+
+#define THIEVES 3
+#define ITEMS 200000
+
+START_TEST(test_wsdeque_init_cleanup) {
+    struct wsdeque *d = wsdeque_init(10);
+    ck_assert_ptr_nonnull(d);
+    wsdeque_cleanup(d);
+}
+END_TEST
+
+START_TEST(test_wsdeque_owner_lifo) {
+    struct wsdeque *d = wsdeque_init(10);
+    ck_assert_int_eq(wsdeque_push(d, 'x'), 0);
+    ck_assert_int_eq(wsdeque_push(d, 'y'), 0);
+    ck_assert_int_eq(wsdeque_push(d, 'z'), 0);
+    ck_assert_int_eq(wsdeque_size(d), 3);
+
+    ck_assert_int_eq(wsdeque_pop(d), 'z');
+    ck_assert_int_eq(wsdeque_pop(d), 'y');
+    ck_assert_int_eq(wsdeque_pop(d), 'x');
+    ck_assert_int_eq(wsdeque_pop(d), -1);
+    ck_assert_int_eq(wsdeque_empty(d), 1);
+    wsdeque_cleanup(d);
+}
+END_TEST
+
+START_TEST(test_wsdeque_steal_fifo) {
+    struct wsdeque *d = wsdeque_init(10);
+    ck_assert_int_eq(wsdeque_push(d, 'x'), 0);
+    ck_assert_int_eq(wsdeque_push(d, 'y'), 0);
+    ck_assert_int_eq(wsdeque_push(d, 'z'), 0);
+
+    ck_assert_int_eq(wsdeque_steal(d), 'x');
+    ck_assert_int_eq(wsdeque_pop(d), 'z');
+    ck_assert_int_eq(wsdeque_steal(d), 'y');
+    ck_assert_int_eq(wsdeque_steal(d), -1);
+    ck_assert_int_eq(wsdeque_pop(d), -1);
+    wsdeque_cleanup(d);
+}
+END_TEST
+
+START_TEST(test_wsdeque_grow) {
+    struct wsdeque *d = wsdeque_init(2);
+    for (int i = 0; i < 1000; i++) {
+        ck_assert_int_eq(wsdeque_push(d, i), 0);
+    }
+    for (int i = 0; i < 500; i++) {
+        ck_assert_int_eq(wsdeque_steal(d), i);
+    }
+    for (int i = 999; i >= 500; i--) {
+        ck_assert_int_eq(wsdeque_pop(d), i);
+    }
+    ck_assert_int_eq(wsdeque_empty(d), 1);
+    wsdeque_cleanup(d);
+}
+END_TEST
+
+static struct wsdeque *shared;
+static atomic_int taken[ITEMS];
+static atomic_int remaining;
+
+static void *thief(void *arg) {
+    (void) arg;
+    while (atomic_load(&remaining) > 0) {
+        int item = wsdeque_steal(shared);
+        if (item == -1) {
+            sched_yield();
+            continue;
+        }
+        atomic_fetch_add(&taken[item], 1);
+        atomic_fetch_sub(&remaining, 1);
+    }
+    return NULL;
+}
+
+START_TEST(test_wsdeque_get_stats) {
+    struct wsdeque *d = wsdeque_init(2);
+    struct container_stats stats;
+
+    for (int i = 0; i < 5; i++) {
+        ck_assert_int_eq(wsdeque_push(d, i), 0);
+    }
+    ck_assert_int_eq(wsdeque_steal(d), 0);
+    ck_assert_int_eq(wsdeque_pop(d), 4);
+    ck_assert_int_eq(wsdeque_get_stats(d, &stats), 0);
+    ck_assert_int_eq(stats.push, 5);
+    ck_assert_int_eq(stats.pop, 2);
+    ck_assert_int_eq(stats.max, 5);
+
+    /* Grown from 2 to 4 to 8, keeping the old rings. */
+    ck_assert_int_eq(stats.resizes, 2);
+    ck_assert_int_eq(stats.bytes_copied, (2 + 4) * sizeof(int));
+    ck_assert_int_eq(stats.capacity, 8);
+    ck_assert_int_eq(stats.peak_capacity, 8);
+    ck_assert_int_eq(stats.bytes, (2 + 4 + 8) * sizeof(int));
+    ck_assert_int_eq(stats.peak_bytes, stats.bytes);
+    ck_assert_int_eq(stats.failed, 0);
+    ck_assert_int_eq(stats.empty_pops, 0);
+
+    while (wsdeque_pop(d) != -1) {
+        continue;
+    }
+    ck_assert_int_eq(wsdeque_get_stats(d, &stats), 0);
+    ck_assert_int_eq(stats.pop, 5);
+    ck_assert_int_eq(stats.empty_pops, 1);
+
+    ck_assert_int_eq(wsdeque_get_stats(NULL, &stats), 1);
+    ck_assert_int_eq(wsdeque_get_stats(d, NULL), 1);
+    wsdeque_cleanup(d);
+}
+END_TEST
+
+START_TEST(test_wsdeque_threads) {
+    pthread_t thieves[THIEVES];
+
+    shared = wsdeque_init(16);
+    atomic_store(&remaining, ITEMS);
+    for (int i = 0; i < THIEVES; i++) {
+        ck_assert_int_eq(pthread_create(&thieves[i], NULL, thief, NULL), 0);
+    }
+
+    /* The owner pushes two items and pops one, so the deque keeps growing
+     * while the thieves take from the other end. */
+    int next = 0;
+    while (next < ITEMS) {
+        ck_assert_int_eq(wsdeque_push(shared, next++), 0);
+        if (next < ITEMS) {
+            ck_assert_int_eq(wsdeque_push(shared, next++), 0);
+        }
+        int item = wsdeque_pop(shared);
+        if (item != -1) {
+            atomic_fetch_add(&taken[item], 1);
+            atomic_fetch_sub(&remaining, 1);
+        }
+    }
+    while (atomic_load(&remaining) > 0) {
+        int item = wsdeque_pop(shared);
+        if (item == -1) {
+            sched_yield();
+            continue;
+        }
+        atomic_fetch_add(&taken[item], 1);
+        atomic_fetch_sub(&remaining, 1);
+    }
+
+    for (int i = 0; i < THIEVES; i++) {
+        pthread_join(thieves[i], NULL);
+    }
+
+    /* Every item must have been taken exactly once. */
+    for (int i = 0; i < ITEMS; i++) {
+        ck_assert_int_eq(atomic_load(&taken[i]), 1);
+    }
+    wsdeque_cleanup(shared);
+}
+END_TEST
+
+START_TEST(test_wsdeque_null_ptr) {
+    wsdeque_cleanup(NULL);
+    wsdeque_stats(NULL);
+    ck_assert_int_eq(wsdeque_push(NULL, 'x'), 1);
+    ck_assert_int_eq(wsdeque_pop(NULL), -1);
+    ck_assert_int_eq(wsdeque_steal(NULL), -1);
+    ck_assert_int_eq(wsdeque_empty(NULL), -1);
+}
+END_TEST
+
+Suite *wsdeque_suite(void) {
+    Suite *s;
+    TCase *tc_core;
+    TCase *tc_threads;
+    s = suite_create("work-stealing deque");
+
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_wsdeque_init_cleanup);
+    tcase_add_test(tc_core, test_wsdeque_owner_lifo);
+    tcase_add_test(tc_core, test_wsdeque_steal_fifo);
+    tcase_add_test(tc_core, test_wsdeque_grow);
+    tcase_add_test(tc_core, test_wsdeque_get_stats);
+    tcase_add_test(tc_core, test_wsdeque_null_ptr);
+
+    tc_threads = tcase_create("Threads");
+    tcase_set_timeout(tc_threads, 30);
+    tcase_add_test(tc_threads, test_wsdeque_threads);
+
+    suite_add_tcase(s, tc_core);
+    suite_add_tcase(s, tc_threads);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = wsdeque_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,108 @@
+/*
+ * container_stats.c -- writing container statistics as JSON or CSV
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+#include <stdio.h>
+
+#include "container_stats.h"
+
+/* Number of fields in a struct container_stats. */
+#define N_FIELDS 11
+
+static const char *field_names[N_FIELDS] = {
+    "push", "pop", "max", "resizes", "bytes_copied", "capacity",
+    "peak_capacity", "bytes", "peak_bytes", "failed", "empty_pops",
+};
+
+/* Put the fields of 'stats' in 'values', in the order of field_names. */
+static void field_values(const struct container_stats *stats,
+                         size_t values[N_FIELDS]) {
+    values[0] = stats->push;
+    values[1] = stats->pop;
+    values[2] = stats->max;
+    values[3] = stats->resizes;
+    values[4] = stats->bytes_copied;
+    values[5] = stats->capacity;
+    values[6] = stats->peak_capacity;
+    values[7] = stats->bytes;
+    values[8] = stats->peak_bytes;
+    values[9] = stats->failed;
+    values[10] = stats->empty_pops;
+}
+
+/* Write 'name' as a JSON string. */
+static void json_string(FILE *fp, const char *name) {
+    fputc('"', fp);
+    for (const unsigned char *p = (const unsigned char *) name; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fprintf(fp, "\\%c", *p);
+        } else if (*p < 0x20) {
+            fprintf(fp, "\\u%04x", *p);
+        } else {
+            fputc(*p, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+int container_stats_write_json(FILE *fp, const char *name,
+                               const struct container_stats *stats) {
+    if (fp == NULL || name == NULL || stats == NULL) {
+        return 1;
+    }
+
+    size_t values[N_FIELDS];
+    field_values(stats, values);
+
+    fputs("{\"name\":", fp);
+    json_string(fp, name);
+    for (size_t i = 0; i < N_FIELDS; i++) {
+        fprintf(fp, ",\"%s\":%zu", field_names[i], values[i]);
+    }
+    fputs("}\n", fp);
+
+    return ferror(fp) != 0;
+}
+
+int container_stats_write_csv_header(FILE *fp) {
+    if (fp == NULL) {
+        return 1;
+    }
+
+    fputs("name", fp);
+    for (size_t i = 0; i < N_FIELDS; i++) {
+        fprintf(fp, ",%s", field_names[i]);
+    }
+    fputc('\n', fp);
+
+    return ferror(fp) != 0;
+}
+
+int container_stats_write_csv(FILE *fp, const char *name,
+                              const struct container_stats *stats) {
+    if (fp == NULL || name == NULL || stats == NULL) {
+        return 1;
+    }
+
+    size_t values[N_FIELDS];
+    field_values(stats, values);
+
+    /* Quote the name, doubling any quotes in it, as RFC 4180 does. */
+    fputc('"', fp);
+    for (const char *p = name; *p; p++) {
+        if (*p == '"') {
+            fputc('"', fp);
+        }
+        fputc(*p, fp);
+    }
+    fputc('"', fp);
+    for (size_t i = 0; i < N_FIELDS; i++) {
+        fprintf(fp, ",%zu", values[i]);
+    }
+    fputc('\n', fp);
+
+    return ferror(fp) != 0;
+}
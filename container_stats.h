@@ -0,0 +1,52 @@
+#ifndef _CONTAINER_STATS_H_
+#define _CONTAINER_STATS_H_
+
+#include <stdio.h>
+
+/**
+ * struct container_stats -- what a stack or queue has been doing
+ * @push: the number of successful pushes
+ * @pop: the number of successful pops
+ * @max: the maximum number of items that were stored at the same time
+ * @resizes: the number of times the storage for the items grew
+ * @bytes_copied: the number of bytes of items copied while growing
+ * @capacity: the number of items that fit in the current storage
+ * @peak_capacity: the maximum @capacity that has been reached
+ * @bytes: the number of bytes of storage currently held for the items
+ * @peak_bytes: the maximum @bytes that has been reached
+ * @failed: the number of pushes that failed
+ * @empty_pops: the number of pops on an empty container
+ *
+ * Containers that reserve their storage up front report the size of the
+ * reservation in @bytes, even if not all of it is in memory yet.
+ */
+struct container_stats {
+    size_t push;
+    size_t pop;
+    size_t max;
+    size_t resizes;
+    size_t bytes_copied;
+    size_t capacity;
+    size_t peak_capacity;
+    size_t bytes;
+    size_t peak_bytes;
+    size_t failed;
+    size_t empty_pops;
+};
+
+/* Write 'stats' to 'fp' as a JSON object on a single line, with 'name'
+ * as the value of its "name" member. One line per container makes the
+ * output a JSON Lines file. Return 0 if successful, 1 otherwise. */
+int container_stats_write_json(FILE *fp, const char *name,
+                               const struct container_stats *stats);
+
+/* Write the header line for container_stats_write_csv() to 'fp'. Return 0
+ * if successful, 1 otherwise. */
+int container_stats_write_csv_header(FILE *fp);
+
+/* Write 'stats' to 'fp' as a CSV line starting with 'name'. Return 0 if
+ * successful, 1 otherwise. */
+int container_stats_write_csv(FILE *fp, const char *name,
+                              const struct container_stats *stats);
+
+#endif
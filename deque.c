@@ -0,0 +1,258 @@
+/*
+ * deque.c -- the implementation of deque.h
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "deque.h"
+
+/**
+ * struct deque -- the struct where the deque is stored
+ * @length: the number of items currently in the deque
+ * @capacity: the number of items that fit in @data
+ * @first: the index of the first item
+ * @push: the number of times the deque has been pushed to, at either end
+ * @pop: the number of times the deque has been popped, at either end
+ * @max: the maximum @length that has been reached
+ * @data: a pointer to the items in the deque
+ * @resizes: the number of times @data grew
+ * @copied: the number of bytes copied while @data grew
+ * @peak_capacity: the maximum @capacity that has been reached
+ * @failed: the number of pushes that failed
+ * @empty_pops: the number of pops on an empty deque
+ *
+ * The items form a ring in @data that starts at @first and wraps around
+ * at @capacity. Pushing at the front moves @first back by one, pushing at
+ * the back writes just after the last item, so neither end ever moves the
+ * other items. When the ring is full it is copied to a larger array,
+ * starting at index 0.
+ */
+struct deque {
+    size_t length;
+    size_t capacity;
+    size_t first;
+    size_t push;
+    size_t pop;
+    size_t max;
+    int *data;
+    size_t resizes;
+    size_t copied;
+    size_t peak_capacity;
+    size_t failed;
+    size_t empty_pops;
+};
+
+struct deque *deque_init(size_t capacity) {
+    struct deque *d = malloc(sizeof(struct deque));
+    if (d == NULL) {
+        return NULL;
+    }
+
+    d->data = malloc(capacity * sizeof(int));
+    if (d->data == NULL && capacity > 0) {
+        free(d);
+        return NULL;
+    }
+
+    d->length = 0;
+    d->capacity = capacity;
+    d->first = 0;
+    d->push = 0;
+    d->pop = 0;
+    d->max = 0;
+    d->resizes = 0;
+    d->copied = 0;
+    d->peak_capacity = capacity;
+    d->failed = 0;
+    d->empty_pops = 0;
+
+    return d;
+}
+
+void deque_cleanup(struct deque *d) {
+    if (d == NULL) {
+        return;
+    }
+
+    free(d->data);
+    free(d);
+}
+
+void deque_stats(const struct deque *d) {
+    if (d == NULL) {
+        return;
+    }
+
+    fprintf(stderr, "stats %zu %zu %zu\n", d->push, d->pop, d->max);
+}
+
+int deque_get_stats(const struct deque *d, struct container_stats *stats) {
+    if (d == NULL || stats == NULL) {
+        return 1;
+    }
+
+    stats->push = d->push;
+    stats->pop = d->pop;
+    stats->max = d->max;
+    stats->resizes = d->resizes;
+    stats->bytes_copied = d->copied;
+    stats->capacity = d->capacity;
+    stats->peak_capacity = d->peak_capacity;
+    stats->bytes = d->capacity * sizeof(int);
+    stats->peak_bytes = d->peak_capacity * sizeof(int);
+    stats->failed = d->failed;
+    stats->empty_pops = d->empty_pops;
+
+    return 0;
+}
+
+/* Return the index in @data of the item 'i' places after the first. */
+static size_t slot(const struct deque *d, size_t i) {
+    size_t index = d->first + i;
+    if (index >= d->capacity) {
+        index -= d->capacity;
+    }
+    return index;
+}
+
+/* Make room for one more item. Return 0 if successful, 1 otherwise. */
+static int reserve(struct deque *d) {
+    if (d->length < d->capacity) {
+        return 0;
+    }
+
+    size_t new_capacity = d->capacity * 2 + 1;
+    int *new = malloc(new_capacity * sizeof(int));
+    if (new == NULL) {
+        d->failed++;
+        return 1;
+    }
+
+    /* Unwrap the ring: the part from @first to the end of @data, then the
+     * part that wrapped around to the start. */
+    size_t upper = d->capacity - d->first;
+    if (upper > d->length) {
+        upper = d->length;
+    }
+    if (d->length > 0) {
+        memcpy(new, d->data + d->first, upper * sizeof(int));
+        memcpy(new + upper, d->data, (d->length - upper) * sizeof(int));
+    }
+    free(d->data);
+
+    d->data = new;
+    d->first = 0;
+    d->capacity = new_capacity;
+    d->resizes++;
+    d->copied += d->length * sizeof(int);
+    if (new_capacity > d->peak_capacity) {
+        d->peak_capacity = new_capacity;
+    }
+
+    return 0;
+}
+
+/* Count an item that was just added. */
+static void pushed(struct deque *d) {
+    d->length++;
+    d->push++;
+
+    if (d->length >= d->max) {
+        d->max = d->length;
+    }
+}
+
+int deque_push_front(struct deque *d, int e) {
+    if (d == NULL || reserve(d)) {
+        return 1;
+    }
+
+    d->first = d->first == 0 ? d->capacity - 1 : d->first - 1;
+    d->data[d->first] = e;
+    pushed(d);
+
+    return 0;
+}
+
+int deque_push_back(struct deque *d, int e) {
+    if (d == NULL || reserve(d)) {
+        return 1;
+    }
+
+    d->data[slot(d, d->length)] = e;
+    pushed(d);
+
+    return 0;
+}
+
+int deque_pop_front(struct deque *d) {
+    if (d == NULL) {
+        return -1;
+    }
+
+    if (d->length == 0) {
+        d->empty_pops++;
+        return -1;
+    }
+
+    int value = d->data[d->first];
+    d->first = slot(d, 1);
+    d->length--;
+    d->pop++;
+
+    return value;
+}
+
+int deque_pop_back(struct deque *d) {
+    if (d == NULL) {
+        return -1;
+    }
+
+    if (d->length == 0) {
+        d->empty_pops++;
+        return -1;
+    }
+
+    int value = d->data[slot(d, d->length - 1)];
+    d->length--;
+    d->pop++;
+
+    return value;
+}
+
+int deque_peek_front(const struct deque *d) {
+    if (d == NULL || d->length == 0) {
+        return -1;
+    }
+
+    return d->data[d->first];
+}
+
+int deque_peek_back(const struct deque *d) {
+    if (d == NULL || d->length == 0) {
+        return -1;
+    }
+
+    return d->data[slot(d, d->length - 1)];
+}
+
+int deque_empty(const struct deque *d) {
+    if (d == NULL) {
+        return -1;
+    }
+
+    return d->length == 0;
+}
+
+size_t deque_size(const struct deque *d) {
+    if (d == NULL) {
+        return 0;
+    }
+
+    return d->length;
+}
@@ -0,0 +1,62 @@
+#ifndef _DEQUE_H_
+#define _DEQUE_H_
+
+/* A double-ended queue of ints for a single thread. Items can be pushed
+ * and popped at both ends, so the deque can be used as a stack, as a queue
+ * or as both at once. The statistics follow those of queue.h. */
+
+#include <stddef.h>
+
+#include "container_stats.h"
+
+/* Handle to deque */
+struct deque;
+
+/* Return a pointer to a deque data structure with an initial capacity of
+ * 'capacity' if successful, otherwise return NULL. The deque grows when it
+ * is full. */
+struct deque *deque_init(size_t capacity);
+
+/* Cleanup deque. */
+void deque_cleanup(struct deque *d);
+
+/* Print deque statistics to stderr.
+ * The format is: 'stats' num_of_pushes num_of_pops max_elements */
+void deque_stats(const struct deque *d);
+
+/* Fill in 'stats' with the statistics of 'd'. Return 0 if successful, 1
+ * otherwise. */
+int deque_get_stats(const struct deque *d, struct container_stats *stats);
+
+/* Push item onto the front of the deque.
+ * Return 0 if successful, 1 otherwise. */
+int deque_push_front(struct deque *d, int e);
+
+/* Push item onto the back of the deque.
+ * Return 0 if successful, 1 otherwise. */
+int deque_push_back(struct deque *d, int e);
+
+/* Remove the first item from the deque and return it.
+ * Return the first item if successful, -1 otherwise. */
+int deque_pop_front(struct deque *d);
+
+/* Remove the last item from the deque and return it.
+ * Return the last item if successful, -1 otherwise. */
+int deque_pop_back(struct deque *d);
+
+/* Return the first item from the deque. Leave the deque unchanged.
+ * Return the first item if successful, -1 otherwise. */
+int deque_peek_front(const struct deque *d);
+
+/* Return the last item from the deque. Leave the deque unchanged.
+ * Return the last item if successful, -1 otherwise. */
+int deque_peek_back(const struct deque *d);
+
+/* Return 1 if deque is empty, 0 if the deque contains any elements and
+ * return -1 if the operation fails. */
+int deque_empty(const struct deque *d);
+
+/* Return the number of elements stored in the deque. */
+size_t deque_size(const struct deque *d);
+
+#endif
@@ -0,0 +1,300 @@
+/*
+ * lfstack.c -- a lock-free (Treiber) stack for sharing between threads
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lfstack.h"
+
+#define CACHE_LINE 64
+
+/* Index that marks the end of a list. */
+#define NIL UINT32_MAX
+
+/* Number of counter shards, threads are spread over them round-robin. */
+#define SHARDS 64
+
+/* Every MAX_SAMPLE pushes (a power of two) a thread samples the size of the
+ * stack to update the maximum. */
+#define MAX_SAMPLE 64
+
+/**
+ * struct node -- a slot that can hold one item
+ * @next: the index of the next node in the list this node is on
+ * @value: the item stored in the node
+ */
+struct node {
+    atomic_uint_least32_t next;
+    atomic_int value;
+};
+
+/**
+ * struct shard -- the statistics of the threads assigned to this shard
+ * @push: the number of pushes done by these threads
+ * @pop: the number of pops done by these threads
+ */
+struct shard {
+    _Alignas(CACHE_LINE) atomic_size_t push;
+    atomic_size_t pop;
+};
+
+/**
+ * struct lfstack -- the structure where the stack is stored
+ * @top: the tagged index of the top node of the stack
+ * @free: the tagged index of the first unused node
+ * @max: the maximum sampled size of the stack
+ * @capacity: the number of nodes
+ * @nodes: all nodes, both those on the stack and the unused ones
+ * @shards: per-thread statistics
+ *
+ * The items live in nodes that are taken from one preallocated array, and
+ * every node is always on exactly one of two Treiber stacks: @top holds the
+ * items and @free holds the unused nodes. A push moves a node from @free to
+ * @top and a pop moves it back.
+ *
+ * The lists refer to nodes by 32-bit index instead of by pointer, which
+ * leaves room for a 32-bit tag next to the index in a single 64-bit word.
+ * The tag is incremented on every change, so a compare-and-swap fails if the
+ * list changed in between even when the same node is back on top. This is
+ * what prevents the ABA problem. Nodes are only freed by lfstack_cleanup(),
+ * so a thread that reads the @next of a node that was just popped by another
+ * thread still reads valid memory; its compare-and-swap then fails on the
+ * tag and it retries.
+ *
+ * The statistics are spread over cache-line-sized shards so that threads
+ * don't all write the same counter. They are summed when they are needed.
+ */
+struct lfstack {
+    _Alignas(CACHE_LINE) atomic_uint_least64_t top;
+    _Alignas(CACHE_LINE) atomic_uint_least64_t free;
+    _Alignas(CACHE_LINE) atomic_size_t max;
+    size_t capacity;
+    struct node *nodes;
+    struct shard shards[SHARDS];
+};
+
+/* The shard of the calling thread, assigned on first use. */
+static atomic_uint next_shard;
+static _Thread_local unsigned int shard_id = UINT_MAX;
+
+static struct shard *my_shard(struct lfstack *s) {
+    if (shard_id == UINT_MAX) {
+        shard_id = atomic_fetch_add(&next_shard, 1) % SHARDS;
+    }
+
+    return &s->shards[shard_id];
+}
+
+static uint_least64_t tagged(uint32_t index, uint_least64_t old) {
+    uint32_t tag = (uint32_t) (old >> 32) + 1;
+    return ((uint_least64_t) tag << 32) | index;
+}
+
+/* Take the first node off 'list'. Return its index or NIL if it is empty. */
+static uint32_t list_take(struct lfstack *s, atomic_uint_least64_t *list) {
+    uint_least64_t old = atomic_load_explicit(list, memory_order_acquire);
+
+    while (1) {
+        uint32_t index = (uint32_t) old;
+        if (index == NIL) {
+            return NIL;
+        }
+
+        uint32_t next = (uint32_t) atomic_load_explicit(&s->nodes[index].next,
+                                                        memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(list, &old,
+                                                  tagged(next, old),
+                                                  memory_order_acquire,
+                                                  memory_order_acquire)) {
+            return index;
+        }
+    }
+}
+
+/* Put the node at 'index' on top of 'list'. */
+static void list_put(struct lfstack *s, atomic_uint_least64_t *list,
+                     uint32_t index) {
+    uint_least64_t old = atomic_load_explicit(list, memory_order_relaxed);
+
+    do {
+        atomic_store_explicit(&s->nodes[index].next, (uint32_t) old,
+                              memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(list, &old,
+                                                    tagged(index, old),
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+struct lfstack *lfstack_init(size_t capacity) {
+    if (capacity >= NIL) {
+        return NULL;
+    }
+
+    struct lfstack *s = aligned_alloc(CACHE_LINE, sizeof(struct lfstack));
+    if (s == NULL) {
+        return NULL;
+    }
+
+    s->nodes = malloc((capacity ? capacity : 1) * sizeof(struct node));
+    if (s->nodes == NULL) {
+        free(s);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < capacity; i++) {
+        atomic_init(&s->nodes[i].next, i + 1 < capacity ? (uint32_t) (i + 1) : NIL);
+        atomic_init(&s->nodes[i].value, 0);
+    }
+
+    for (size_t i = 0; i < SHARDS; i++) {
+        atomic_init(&s->shards[i].push, 0);
+        atomic_init(&s->shards[i].pop, 0);
+    }
+
+    atomic_init(&s->top, NIL);
+    atomic_init(&s->free, capacity ? 0 : NIL);
+    atomic_init(&s->max, 0);
+    s->capacity = capacity;
+
+    return s;
+}
+
+void lfstack_cleanup(struct lfstack *s) {
+    if (s == NULL) {
+        return;
+    }
+
+    free(s->nodes);
+    free(s);
+}
+
+/* Sum the statistics of all shards. */
+static void sum_shards(const struct lfstack *s, size_t *push, size_t *pop) {
+    *push = 0;
+    *pop = 0;
+
+    /* Sum the pops first, so a concurrent pop can't make pop > push. */
+    for (size_t i = 0; i < SHARDS; i++) {
+        *pop += atomic_load_explicit(&s->shards[i].pop, memory_order_relaxed);
+    }
+    for (size_t i = 0; i < SHARDS; i++) {
+        *push += atomic_load_explicit(&s->shards[i].push, memory_order_relaxed);
+    }
+}
+
+void lfstack_stats(const struct lfstack *s) {
+    if (s == NULL) {
+        return;
+    }
+
+    size_t push;
+    size_t pop;
+    sum_shards(s, &push, &pop);
+
+    fprintf(stderr, "stats %zu %zu %zu\n", push, pop,
+            atomic_load_explicit(&s->max, memory_order_relaxed));
+}
+
+int lfstack_push(struct lfstack *s, int c) {
+    if (s == NULL) {
+        return 1;
+    }
+
+    uint32_t index = list_take(s, &s->free);
+    if (index == NIL) {
+        return 1;
+    }
+
+    atomic_store_explicit(&s->nodes[index].value, c, memory_order_relaxed);
+    list_put(s, &s->top, index);
+
+    struct shard *shard = my_shard(s);
+    size_t pushes = atomic_fetch_add_explicit(&shard->push, 1,
+                                              memory_order_relaxed);
+    if ((pushes & (MAX_SAMPLE - 1)) == 0) {
+        size_t length = lfstack_size(s);
+        size_t max = atomic_load_explicit(&s->max, memory_order_relaxed);
+        while (length > max &&
+               !atomic_compare_exchange_weak_explicit(&s->max, &max, length,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+            /* 'max' was reloaded by the failed exchange. */
+        }
+    }
+
+    return 0;
+}
+
+int lfstack_pop(struct lfstack *s) {
+    if (s == NULL) {
+        return -1;
+    }
+
+    uint32_t index = list_take(s, &s->top);
+    if (index == NIL) {
+        return -1;
+    }
+
+    int value = atomic_load_explicit(&s->nodes[index].value,
+                                     memory_order_relaxed);
+    list_put(s, &s->free, index);
+
+    atomic_fetch_add_explicit(&my_shard(s)->pop, 1, memory_order_relaxed);
+
+    return value;
+}
+
+int lfstack_peek(const struct lfstack *s) {
+    if (s == NULL) {
+        return -1;
+    }
+
+    uint_least64_t top = atomic_load_explicit(&s->top, memory_order_acquire);
+    for (;;) {
+        uint32_t index = (uint32_t) top;
+        if (index == NIL) {
+            return -1;
+        }
+
+        int value = atomic_load_explicit(&s->nodes[index].value,
+                                         memory_order_relaxed);
+
+        /* The node may have been popped and reused while its value was
+         * read. Every change bumps the tag, so an unchanged top means the
+         * value belongs to the node that was on top. */
+        atomic_thread_fence(memory_order_acquire);
+        uint_least64_t now = atomic_load_explicit(&s->top,
+                                                  memory_order_acquire);
+        if (now == top) {
+            return value;
+        }
+        top = now;
+    }
+}
+
+int lfstack_empty(const struct lfstack *s) {
+    if (s == NULL) {
+        return -1;
+    }
+
+    return (uint32_t) atomic_load_explicit(&s->top, memory_order_acquire) == NIL;
+}
+
+size_t lfstack_size(const struct lfstack *s) {
+    if (s == NULL) {
+        return 1;
+    }
+
+    size_t push;
+    size_t pop;
+    sum_shards(s, &push, &pop);
+
+    return push > pop ? push - pop : 0;
+}
@@ -0,0 +1,47 @@
+#ifndef _LFSTACK_H_
+#define _LFSTACK_H_
+
+#include <stddef.h>
+
+/* Handle to a lock-free stack that can be shared between threads.
+ *
+ * All operations may be called from any number of threads at the same
+ * time. The stack has a fixed capacity, which makes it suitable as a
+ * shared free list or as a LIFO pool of work items. */
+struct lfstack;
+
+/* Return a pointer to a stack that can hold 'capacity' items if successful,
+ * otherwise return NULL. The stack does not grow. */
+struct lfstack *lfstack_init(size_t capacity);
+
+/* Cleanup stack. No thread may use the stack anymore. */
+void lfstack_cleanup(struct lfstack *s);
+
+/* Print stack statistics to stderr.
+ * The format is: 'stats' num_of_pushes num_of_pops max_elements
+ * The maximum is sampled and may be lower than the true maximum. */
+void lfstack_stats(const struct lfstack *s);
+
+/* Push item onto the stack.
+ * Return 0 if successful, 1 if the stack is full or on error. */
+int lfstack_push(struct lfstack *s, int c);
+
+/* Pop item from stack and return it.
+ * Return top item if successful, -1 otherwise. */
+int lfstack_pop(struct lfstack *s);
+
+/* Return top of item from stack. Leave stack unchanged. The item was on
+ * top at some point during the call, but may be popped by another thread
+ * right after this returns.
+ * Return top item if successful, -1 otherwise. */
+int lfstack_peek(const struct lfstack *s);
+
+/* Return 1 if stack is empty, 0 if the stack contains any elements and
+ * return -1 if the operation fails. */
+int lfstack_empty(const struct lfstack *s);
+
+/* Return the number of elements stored in the stack. While other threads
+ * are using the stack this is only a snapshot. */
+size_t lfstack_size(const struct lfstack *s);
+
+#endif
@@ -0,0 +1,281 @@
+/*
+ * maze_cache.c -- mapped files of the parsed and preprocessed maze
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+// Needed for fileno(), fstat() and mmap()
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "maze_cache.h"
+
+#define MAGIC "MAZECACH"
+#define VERSION 1
+
+#define FNV_OFFSET 14695981039346656037ull
+#define FNV_PRIME 1099511628211ull
+
+#define START 'S'
+#define FINISH 'D'
+
+/**
+ * struct header -- the start of a cache file
+ * @magic: MAGIC, without the terminating null byte
+ * @version: VERSION
+ * @n: the number of rows and columns of the maze
+ * @start: the index of the start
+ * @finish: the index of the destination
+ * @key: the key given to maze_cache_save()
+ * @reached: the number of cells with a distance
+ *
+ * The header is followed by the n * n cells, padded to a multiple of eight
+ * bytes, and then by n * n distances of type int32_t.
+ */
+struct header {
+    char magic[8];
+    uint32_t version;
+    int32_t n;
+    int32_t start;
+    int32_t finish;
+    uint64_t key;
+    int64_t reached;
+};
+
+/* Return the number of bytes of the cells of a maze of size 'n' in a
+ * file. */
+static size_t cells_bytes(int n)
+{
+    return ((size_t) n * (size_t) n + 7) & ~(size_t) 7;
+}
+
+/* Return the size of a file for a maze of size 'n'. */
+static size_t file_bytes(int n)
+{
+    return sizeof(struct header) + cells_bytes(n)
+           + (size_t) n * (size_t) n * sizeof(int32_t);
+}
+
+int maze_cache_key_file(FILE *fp, uint64_t *key)
+{
+    if (fp == NULL || key == NULL) {
+        return 1;
+    }
+
+    /* The stream is at the same offset as its file only if it has nothing
+     * in its buffer. */
+    int fd = fileno(fp);
+    long offset = ftell(fp);
+    struct stat st;
+    if (fd == -1 || offset < 0 || lseek(fd, 0, SEEK_CUR) != (off_t) offset
+        || fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)
+        || st.st_size <= (off_t) offset) {
+        return 1;
+    }
+
+    size_t size = (size_t) st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        return 1;
+    }
+
+    const unsigned char *bytes = map;
+    uint64_t hash = FNV_OFFSET;
+    for (size_t i = (size_t) offset; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    munmap(map, size);
+
+    *key = hash;
+    return 0;
+}
+
+int maze_cache_save(const struct maze *m, const struct maze_distance *field,
+                    const char *filename, uint64_t key)
+{
+    if (m == NULL || field == NULL || field->dist == NULL || filename == NULL
+        || field->n != maze_size(m)) {
+        return 1;
+    }
+
+    int n = maze_size(m);
+    char *cells = calloc(cells_bytes(n), 1);
+    size_t length = strlen(filename) + 32;
+    char *tmp = malloc(length);
+    if (cells == NULL || tmp == NULL) {
+        free(cells);
+        free(tmp);
+        return 1;
+    }
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            cells[r * n + c] = maze_get(m, r, c) == WALL ? WALL : FLOOR;
+        }
+    }
+
+    struct header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MAGIC, sizeof(h.magic));
+    h.version = VERSION;
+    h.n = n;
+    int r, c;
+    maze_start(m, &r, &c);
+    h.start = maze_index(m, r, c);
+    maze_destination(m, &r, &c);
+    h.finish = maze_index(m, r, c);
+    h.key = key;
+    h.reached = field->reached;
+
+    /* Write a file of our own and rename it over the old one. */
+    snprintf(tmp, length, "%s.%ld", filename, (long) getpid());
+    FILE *fp = fopen(tmp, "wb");
+    int failed = fp == NULL;
+    if (fp != NULL) {
+        size_t dists = (size_t) n * (size_t) n;
+        failed = fwrite(&h, sizeof(h), 1, fp) != 1
+                 || fwrite(cells, 1, cells_bytes(n), fp) != cells_bytes(n)
+                 || fwrite(field->dist, sizeof(int32_t), dists, fp) != dists;
+        if (fclose(fp) != 0) {
+            failed = 1;
+        }
+        if (!failed && rename(tmp, filename) != 0) {
+            failed = 1;
+        }
+        if (failed) {
+            remove(tmp);
+        }
+    }
+
+    free(cells);
+    free(tmp);
+    return failed;
+}
+
+int maze_cache_load(struct maze_cache *c, const char *filename, uint64_t key)
+{
+    if (c == NULL || filename == NULL) {
+        return 1;
+    }
+
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        return 1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t) st.st_size < sizeof(struct header)) {
+        close(fd);
+        return 1;
+    }
+
+    size_t size = (size_t) st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return 1;
+    }
+
+    const struct header *h = map;
+    long cells = (long) h->n * h->n;
+    if (memcmp(h->magic, MAGIC, sizeof(h->magic)) != 0
+        || h->version != VERSION || h->key != key || h->n <= 0
+        || h->n > 46340 || h->start < 0 || h->start >= cells
+        || h->finish < 0 || h->finish >= cells || size != file_bytes(h->n)) {
+        munmap(map, size);
+        return 1;
+    }
+
+    c->n = h->n;
+    c->start = h->start;
+    c->finish = h->finish;
+    c->cells = (const char *) map + sizeof(*h);
+    c->field.n = h->n;
+    c->field.dist = (int32_t *) ((char *) map + sizeof(*h)
+                                 + cells_bytes(h->n));
+    c->field.reached = (long) h->reached;
+    c->field.map = NULL;
+    c->field.map_size = 0;
+    c->map = map;
+    c->map_size = size;
+    return 0;
+}
+
+int maze_cache_descend(const struct maze_cache *c, char *cells)
+{
+    if (c == NULL || c->map == NULL || cells == NULL) {
+        return MAZE_DISTANCE_UNREACHABLE;
+    }
+
+    memcpy(cells, c->cells, (size_t) c->n * (size_t) c->n);
+
+    int index = c->start;
+    int length = maze_distance_get(&c->field, index);
+    if (length == MAZE_DISTANCE_UNREACHABLE) {
+        return MAZE_DISTANCE_UNREACHABLE;
+    }
+
+    for (int k = length; k > 0; k--) {
+        index = maze_distance_next(&c->field, index);
+        if (index == MAZE_DISTANCE_UNREACHABLE) {
+            return MAZE_DISTANCE_UNREACHABLE;
+        }
+        cells[index] = PATH;
+    }
+
+    return length;
+}
+
+int maze_cache_render_text(const struct maze_cache *c, const char *cells,
+                           FILE *fp)
+{
+    if (c == NULL || c->map == NULL || cells == NULL || fp == NULL) {
+        return 1;
+    }
+
+    char *row = malloc((size_t) c->n + 1);
+    if (row == NULL) {
+        return 1;
+    }
+
+    /* The start wins if it is the destination as well, as in
+     * maze_print(). */
+    int status = 0;
+    for (int r = 0; r < c->n && !status; r++) {
+        memcpy(row, cells + (size_t) r * (size_t) c->n, (size_t) c->n);
+        if (c->finish / c->n == r) {
+            row[c->finish % c->n] = FINISH;
+        }
+        if (c->start / c->n == r) {
+            row[c->start % c->n] = START;
+        }
+        row[c->n] = '\n';
+        if (fwrite(row, 1, (size_t) c->n + 1, fp) != (size_t) c->n + 1) {
+            status = 1;
+        }
+    }
+
+    free(row);
+    fputc('\n', fp);
+    return status || ferror(fp) != 0;
+}
+
+void maze_cache_cleanup(struct maze_cache *c)
+{
+    if (c == NULL || c->map == NULL) {
+        return;
+    }
+
+    munmap(c->map, c->map_size);
+    c->map = NULL;
+    c->cells = NULL;
+    c->field.dist = NULL;
+}
@@ -0,0 +1,74 @@
+#ifndef _MAZE_CACHE_H_
+#define _MAZE_CACHE_H_
+
+/* A file with everything a solver derives from a map that does not change:
+ * the parsed cells and the distance field to the destination.
+ *
+ * The file is keyed by a hash of the bytes of the map file itself, which
+ * maze_cache_key_file() takes from a mapping of it without reading the
+ * stream, so a run on a known map neither parses it with maze_read() nor
+ * searches it. The cache is mapped read-only and shared, so processes that
+ * solve the same map at the same time share its pages. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "maze.h"
+#include "maze_distance.h"
+
+/**
+ * struct maze_cache -- a mapped cache file
+ * @n: the number of rows and columns of the maze
+ * @start: the index of the start, as maze_index()
+ * @finish: the index of the destination, as maze_index()
+ * @cells: the n * n cells of the maze, WALL or FLOOR
+ * @field: the distances to the destination, which live in @map and must
+ *         not be passed to maze_distance_cleanup()
+ * @map: the mapping of the file
+ * @map_size: the size of @map in bytes
+ */
+struct maze_cache {
+    int n;
+    int start;
+    int finish;
+    const char *cells;
+    struct maze_distance field;
+    void *map;
+    size_t map_size;
+};
+
+/* Set 'key' to the 64-bit FNV-1a hash of what is left of 'fp', from its
+ * file offset to the end, without reading from 'fp'. Return 0 if
+ * successful, 1 if 'fp' is not a regular file or nothing of it was read
+ * into its buffer yet. */
+int maze_cache_key_file(FILE *fp, uint64_t *key);
+
+/* Write 'm' and the distance field 'field' to its destination to
+ * 'filename' with 'key'. The file is replaced at once, so a process that
+ * maps it at the same time sees the old or the new one. Return 0 if
+ * successful, 1 otherwise. */
+int maze_cache_save(const struct maze *m, const struct maze_distance *field,
+                    const char *filename, uint64_t key);
+
+/* Map the cache in 'filename' into 'c' read-only. Return 0 if successful, 1
+ * if it could not be read or was saved with another key. */
+int maze_cache_load(struct maze_cache *c, const char *filename, uint64_t key);
+
+/* Copy the cells of 'c' to the n * n bytes at 'cells' and mark a shortest
+ * path from the start to the destination in them as PATH, leaving out the
+ * start. Return the length of the path, or MAZE_DISTANCE_UNREACHABLE if
+ * there is none. */
+int maze_cache_descend(const struct maze_cache *c, char *cells);
+
+/* Write the n * n 'cells' of the maze of 'c' to 'fp' exactly as
+ * maze_render_text() writes the maze without blocks. Return 0 if
+ * successful, 1 otherwise. */
+int maze_cache_render_text(const struct maze_cache *c, const char *cells,
+                           FILE *fp);
+
+/* Unmap 'c'. */
+void maze_cache_cleanup(struct maze_cache *c);
+
+#endif
@@ -0,0 +1,290 @@
+/*
+ * maze_distance.c -- distance fields of a maze
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+// Needed for fstat() and mmap()
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "maze_distance.h"
+#include "maze_neighbors.h"
+
+#define MAGIC "MAZEDIST"
+#define VERSION 1
+
+#define FNV_OFFSET 14695981039346656037ull
+#define FNV_PRIME 1099511628211ull
+
+/**
+ * struct header -- the start of a saved distance field
+ * @magic: MAGIC, without the terminating null byte
+ * @version: VERSION
+ * @n: the number of rows and columns of the maze
+ * @key: the key given to maze_distance_save()
+ * @reached: the number of cells with a distance
+ *
+ * The header is followed by n * n distances of type int32_t.
+ */
+struct header {
+    char magic[8];
+    uint32_t version;
+    int32_t n;
+    uint64_t key;
+    int64_t reached;
+};
+
+int maze_distance_compute(struct maze_distance *d, const struct maze *m,
+                          const int *sources, size_t n_sources)
+{
+    if (d == NULL || m == NULL || (sources == NULL && n_sources > 0)) {
+        return 1;
+    }
+
+    struct maze_flat flat;
+    if (maze_flat_load(&flat, m)) {
+        return 1;
+    }
+
+    size_t cells = (size_t) flat.n * (size_t) flat.n;
+    int32_t *dist = malloc(cells * sizeof(int32_t));
+    int *queue = malloc(cells * sizeof(int));
+    if (dist == NULL || queue == NULL) {
+        free(dist);
+        free(queue);
+        maze_flat_cleanup(&flat);
+        return 1;
+    }
+
+    /* Cells marked by a solver are floor as well. Every cell is queued at
+     * most once, as it is marked VISITED when its distance is set. */
+    for (size_t i = 0; i < cells; i++) {
+        dist[i] = MAZE_DISTANCE_UNREACHABLE;
+        if (flat.cells[i] != WALL) {
+            flat.cells[i] = FLOOR;
+        }
+    }
+
+    size_t head = 0;
+    size_t tail = 0;
+    for (size_t i = 0; i < n_sources; i++) {
+        int s = sources[i];
+        if (s < 0 || (size_t) s >= cells || flat.cells[s] != FLOOR) {
+            continue;
+        }
+        flat.cells[s] = VISITED;
+        dist[s] = 0;
+        queue[tail++] = s;
+    }
+
+    while (head < tail) {
+        int cell = queue[head++];
+        unsigned int open = maze_flat_neighbors(&flat, cell, FLOOR);
+
+        for (int direction = 0; direction < N_MOVES; direction++) {
+            if (open & (1u << direction)) {
+                int next = cell + flat.offsets[direction];
+                flat.cells[next] = VISITED;
+                dist[next] = dist[cell] + 1;
+                queue[tail++] = next;
+            }
+        }
+    }
+
+    free(queue);
+    maze_flat_cleanup(&flat);
+
+    d->n = flat.n;
+    d->dist = dist;
+    d->reached = (long) tail;
+    d->map = NULL;
+    d->map_size = 0;
+    return 0;
+}
+
+int maze_distance_get(const struct maze_distance *d, int index)
+{
+    if (d == NULL || d->dist == NULL || index < 0
+        || (size_t) index >= (size_t) d->n * (size_t) d->n) {
+        return MAZE_DISTANCE_UNREACHABLE;
+    }
+    return d->dist[index];
+}
+
+int maze_distance_next(const struct maze_distance *d, int index)
+{
+    int k = maze_distance_get(d, index);
+    if (k == MAZE_DISTANCE_UNREACHABLE || k == 0) {
+        return MAZE_DISTANCE_UNREACHABLE;
+    }
+
+    /* Some neighbour of every cell at distance k > 0 is at distance
+     * k - 1, take the first one in the order of m_offsets. */
+    int r = index / d->n;
+    int c = index % d->n;
+    for (int direction = 0; direction < N_MOVES; direction++) {
+        int nr = r + m_offsets[direction][0];
+        int nc = c + m_offsets[direction][1];
+        if (nr >= 0 && nc >= 0 && nr < d->n && nc < d->n
+            && maze_distance_get(d, nr * d->n + nc) == k - 1) {
+            return nr * d->n + nc;
+        }
+    }
+    return MAZE_DISTANCE_UNREACHABLE;
+}
+
+int maze_distance_descend(const struct maze_distance *d, struct maze *m,
+                          int r, int c)
+{
+    if (d == NULL || m == NULL || maze_size(m) != d->n || r < 0 || c < 0
+        || r >= d->n || c >= d->n) {
+        return MAZE_DISTANCE_UNREACHABLE;
+    }
+
+    int index = r * d->n + c;
+    int length = maze_distance_get(d, index);
+    if (length == MAZE_DISTANCE_UNREACHABLE) {
+        return MAZE_DISTANCE_UNREACHABLE;
+    }
+
+    for (int k = length; k > 0; k--) {
+        index = maze_distance_next(d, index);
+        if (index == MAZE_DISTANCE_UNREACHABLE) {
+            return MAZE_DISTANCE_UNREACHABLE;
+        }
+        maze_set(m, index / d->n, index % d->n, PATH);
+    }
+
+    return length;
+}
+
+/* Add the 'size' bytes at 'data' to the FNV-1a hash 'hash'. */
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+uint64_t maze_distance_key(const struct maze *m, const int *sources,
+                           size_t n_sources)
+{
+    uint64_t hash = FNV_OFFSET;
+    if (m == NULL) {
+        return hash;
+    }
+
+    int n = maze_size(m);
+    hash = fnv1a(hash, &n, sizeof(n));
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            unsigned char wall = maze_get(m, r, c) == WALL;
+            hash = fnv1a(hash, &wall, 1);
+        }
+    }
+    if (sources != NULL) {
+        hash = fnv1a(hash, sources, n_sources * sizeof(int));
+    }
+    return hash;
+}
+
+int maze_distance_save(const struct maze_distance *d, const char *filename,
+                       uint64_t key)
+{
+    if (d == NULL || d->dist == NULL || filename == NULL) {
+        return 1;
+    }
+
+    FILE *fp = fopen(filename, "wb");
+    if (fp == NULL) {
+        return 1;
+    }
+
+    struct header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MAGIC, sizeof(h.magic));
+    h.version = VERSION;
+    h.n = d->n;
+    h.key = key;
+    h.reached = d->reached;
+
+    size_t cells = (size_t) d->n * (size_t) d->n;
+    int failed = fwrite(&h, sizeof(h), 1, fp) != 1
+                 || fwrite(d->dist, sizeof(int32_t), cells, fp) != cells;
+    if (fclose(fp) != 0) {
+        failed = 1;
+    }
+    if (failed) {
+        remove(filename);
+    }
+    return failed;
+}
+
+int maze_distance_load(struct maze_distance *d, const char *filename,
+                       uint64_t key)
+{
+    if (d == NULL || filename == NULL) {
+        return 1;
+    }
+
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        return 1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t) st.st_size < sizeof(struct header)) {
+        close(fd);
+        return 1;
+    }
+
+    size_t size = (size_t) st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return 1;
+    }
+
+    const struct header *h = map;
+    if (memcmp(h->magic, MAGIC, sizeof(h->magic)) != 0
+        || h->version != VERSION || h->key != key || h->n <= 0
+        || size != sizeof(*h) + (size_t) h->n * (size_t) h->n
+                                * sizeof(int32_t)) {
+        munmap(map, size);
+        return 1;
+    }
+
+    d->n = h->n;
+    d->dist = (int32_t *) ((char *) map + sizeof(*h));
+    d->reached = (long) h->reached;
+    d->map = map;
+    d->map_size = size;
+    return 0;
+}
+
+void maze_distance_cleanup(struct maze_distance *d)
+{
+    if (d == NULL || d->dist == NULL) {
+        return;
+    }
+
+    if (d->map != NULL) {
+        munmap(d->map, d->map_size);
+    } else {
+        free(d->dist);
+    }
+    d->dist = NULL;
+    d->map = NULL;
+}
@@ -0,0 +1,78 @@
+#ifndef _MAZE_DISTANCE_H_
+#define _MAZE_DISTANCE_H_
+
+/* Distance fields: the length of the shortest path from every cell of a
+ * maze to the nearest of a set of sources, such as the destination.
+ *
+ * One breadth-first search from all sources at once fills the field, after
+ * which the shortest path length from any cell is a single lookup and the
+ * path itself follows by always stepping to a neighbour one closer. A
+ * field can be saved to a file and mapped back in by a later run. The file
+ * holds a key chosen by the caller, usually maze_distance_key() of the
+ * maze and the sources, so a field is never used for another maze. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "maze.h"
+
+/* The distance of a cell from which no source can be reached. */
+#define MAZE_DISTANCE_UNREACHABLE -1
+
+/**
+ * struct maze_distance -- a distance field
+ * @n: the number of rows and columns of the maze
+ * @dist: the distance of each cell by maze_index(), or
+ *        MAZE_DISTANCE_UNREACHABLE
+ * @reached: the number of cells with a distance
+ * @map: the mapping of the file @dist lives in, or NULL if it is on the heap
+ * @map_size: the size of @map in bytes
+ */
+struct maze_distance {
+    int n;
+    int32_t *dist;
+    long reached;
+    void *map;
+    size_t map_size;
+};
+
+/* Fill 'd' with the distances of the cells of 'm' to the nearest of the
+ * 'n_sources' cells whose indices are in 'sources'. Sources on a wall or
+ * on the border are left out. Return 0 if successful, 1 otherwise. */
+int maze_distance_compute(struct maze_distance *d, const struct maze *m,
+                          const int *sources, size_t n_sources);
+
+/* Return the distance of the cell at 'index', or MAZE_DISTANCE_UNREACHABLE
+ * if it is unreachable or out of range. */
+int maze_distance_get(const struct maze_distance *d, int index);
+
+/* Return the index of the first neighbour, in the order of m_offsets, of
+ * the cell at 'index' that is one step closer to a source, or
+ * MAZE_DISTANCE_UNREACHABLE if the cell is a source or unreachable. */
+int maze_distance_next(const struct maze_distance *d, int index);
+
+/* Mark a shortest path from row 'r', column 'c' to the nearest source in
+ * 'm' as PATH, leaving out the first cell. Return the length of the path,
+ * or MAZE_DISTANCE_UNREACHABLE if there is none. */
+int maze_distance_descend(const struct maze_distance *d, struct maze *m,
+                          int r, int c);
+
+/* Return a 64-bit FNV-1a hash of the walls of 'm' and 'sources'. */
+uint64_t maze_distance_key(const struct maze *m, const int *sources,
+                           size_t n_sources);
+
+/* Write 'd' to 'filename' with 'key'. Return 0 if successful, 1
+ * otherwise. */
+int maze_distance_save(const struct maze_distance *d, const char *filename,
+                       uint64_t key);
+
+/* Map the field in 'filename' into 'd' read-only. Return 0 if successful,
+ * 1 if it could not be read or was saved with another key. */
+int maze_distance_load(struct maze_distance *d, const char *filename,
+                       uint64_t key);
+
+/* Release the distances of 'd'. */
+void maze_distance_cleanup(struct maze_distance *d);
+
+#endif
@@ -0,0 +1,623 @@
+/*
+ * maze_gen.c -- generates mazes in the format read by maze_read()
+ *
+ * Usage: maze_gen [-a algorithm] [-s seed] [-p fraction] [-w max] [-o file]
+ *                 size
+ *
+ * Algorithms:
+ *   backtracker  a perfect maze with long corridors (the default)
+ *   prim         a perfect maze with many short dead ends
+ *   eller        a perfect maze built one row at a time, like Kruskal's
+ *                algorithm but without holding the maze in memory
+ *   braid        a backtracker maze where a 'fraction' of the dead ends is
+ *                opened up, which creates loops (the default fraction is 1)
+ *   rooms        a backtracker maze with open rectangular rooms carved in
+ *   impossible   a backtracker maze where the destination is walled off
+ *
+ * The same size, algorithm and seed always give the same maze. The start
+ * is in the upper left corner and the destination in the lower right one.
+ * With -w every floor cell gets a random cost from 1 to 'max', at most 9,
+ * written as a digit for costs other than 1 (see terrain.h). With -w 0 the
+ * cost is 0 or 1 instead, as for a maze with conveyors. The costs do not
+ * change the layout of the maze.
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "maze.h"
+
+#define START 'S'
+#define FINISH 'D'
+
+/* Marks a cell that is waiting to be added to a maze by Prim's algorithm. */
+#define FRONTIER 'f'
+
+/* Number of cells per room carved by the rooms algorithm. */
+#define CELLS_PER_ROOM 256
+
+/* Largest width and height of a room, in cells. */
+#define ROOM_MAX 7
+
+/**
+ * struct grid -- a maze being generated
+ * @n: the number of rows and columns
+ * @w: the number of cells per row and column, cells are at odd positions
+ *     with the walls between them at even positions
+ * @stride: the number of bytes per row, including the newline
+ * @data: the rows, exactly as they are written out
+ */
+struct grid {
+    int n;
+    int w;
+    size_t stride;
+    char *data;
+};
+
+/* Offsets in cells of the four neighbours of a cell. */
+static const int dr[N_MOVES] = { -1, 0, 1, 0 };
+static const int dc[N_MOVES] = { 0, 1, 0, -1 };
+
+/* Highest cost given to a floor cell by -w, 1 leaves the maze unweighted
+ * and 0 gives costs of 0 and 1. */
+static int max_cost = 1;
+static uint64_t cost_seed;
+
+static uint64_t rng_state;
+
+static void rng_seed(uint64_t seed)
+{
+    rng_state = seed * 0x9e3779b97f4a7c15u + 1;
+    if (rng_state == 0) {
+        rng_state = 1;
+    }
+}
+
+/* xorshift64*, fast and plenty random for mazes. */
+static uint64_t rng_next(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1du;
+}
+
+static uint64_t rng_bits;
+static int rng_n_bits;
+
+/* Return a random bit, taken from the pool of one 64-bit number. */
+static unsigned rng_bit(void)
+{
+    if (rng_n_bits == 0) {
+        rng_bits = rng_next();
+        rng_n_bits = 64;
+    }
+    unsigned bit = (unsigned) (rng_bits & 1);
+    rng_bits >>= 1;
+    rng_n_bits--;
+    return bit;
+}
+
+/* Return a random number in [0, bound). */
+static uint32_t rng_below(uint32_t bound)
+{
+    return (uint32_t) (((rng_next() >> 32) * bound) >> 32);
+}
+
+/* Return the cost of the floor at row 'r', column 'c'. It is a hash of the
+ * position rather than the next random number, so that the generator
+ * draws the same numbers with and without -w. */
+static int floor_cost(int r, int c)
+{
+    uint64_t h = cost_seed ^ ((uint64_t) (uint32_t) r << 32 | (uint32_t) c);
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9u;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebu;
+    h ^= h >> 31;
+    if (max_cost == 0) {
+        return (int) (h & 1);
+    }
+    return 1 + (int) (h % (uint64_t) max_cost);
+}
+
+/* Write the costs of the floor cells of 'row', row 'r' of the maze. */
+static void weigh(char *row, int r, int n)
+{
+    if (max_cost == 1) {
+        return;
+    }
+
+    for (int c = 0; c < n; c++) {
+        if (row[c] == FLOOR) {
+            int cost = floor_cost(r, c);
+            if (cost != 1) {
+                row[c] = (char) ('0' + cost);
+            }
+        }
+    }
+}
+
+static char *at(const struct grid *g, int r, int c)
+{
+    return &g->data[(size_t) r * g->stride + (size_t) c];
+}
+
+/* The character at cell ('y', 'x') in cell coordinates. */
+static char *cell(const struct grid *g, int y, int x)
+{
+    return at(g, 2 * y + 1, 2 * x + 1);
+}
+
+/* The wall between cell ('y', 'x') and its neighbour in 'direction'. */
+static char *wall(const struct grid *g, int y, int x, int direction)
+{
+    return at(g, 2 * y + 1 + dr[direction], 2 * x + 1 + dc[direction]);
+}
+
+static bool in_cells(const struct grid *g, int y, int x)
+{
+    return y >= 0 && y < g->w && x >= 0 && x < g->w;
+}
+
+static int grid_init(struct grid *g, int n)
+{
+    g->n = n;
+    g->w = (n - 1) / 2;
+    g->stride = (size_t) n + 1;
+    g->data = malloc(g->stride * (size_t) n);
+    if (g->data == NULL) {
+        return 1;
+    }
+
+    for (int r = 0; r < n; r++) {
+        memset(at(g, r, 0), WALL, (size_t) n);
+        *at(g, r, n) = '\n';
+    }
+    return 0;
+}
+
+/* Carve a perfect maze with an iterative depth-first search. */
+static int backtracker(struct grid *g)
+{
+    size_t cells = (size_t) g->w * (size_t) g->w;
+    uint32_t *stack = malloc(cells * sizeof(uint32_t));
+    if (stack == NULL) {
+        return 1;
+    }
+
+    size_t top = 0;
+    *cell(g, 0, 0) = FLOOR;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        uint32_t current = stack[top - 1];
+        int y = (int) (current / (uint32_t) g->w);
+        int x = (int) (current % (uint32_t) g->w);
+
+        int options[N_MOVES];
+        int n_options = 0;
+        for (int d = 0; d < N_MOVES; d++) {
+            int ny = y + dr[d];
+            int nx = x + dc[d];
+            if (in_cells(g, ny, nx) && *cell(g, ny, nx) == WALL) {
+                options[n_options++] = d;
+            }
+        }
+
+        if (n_options == 0) {
+            top--;
+            continue;
+        }
+
+        int d = options[rng_below((uint32_t) n_options)];
+        int ny = y + dr[d];
+        int nx = x + dc[d];
+        *wall(g, y, x, d) = FLOOR;
+        *cell(g, ny, nx) = FLOOR;
+        stack[top++] = (uint32_t) ny * (uint32_t) g->w + (uint32_t) nx;
+    }
+
+    free(stack);
+    return 0;
+}
+
+/* Carve a perfect maze with the randomized version of Prim's algorithm:
+ * repeatedly connect a random frontier cell to a random neighbour that is
+ * already part of the maze. */
+static int prim(struct grid *g)
+{
+    size_t cells = (size_t) g->w * (size_t) g->w;
+    uint32_t *frontier = malloc(cells * sizeof(uint32_t));
+    if (frontier == NULL) {
+        return 1;
+    }
+
+    size_t size = 0;
+    int y = 0;
+    int x = 0;
+    *cell(g, 0, 0) = FLOOR;
+
+    while (1) {
+        /* Add the unvisited neighbours of the cell that was just added. */
+        for (int d = 0; d < N_MOVES; d++) {
+            int ny = y + dr[d];
+            int nx = x + dc[d];
+            if (in_cells(g, ny, nx) && *cell(g, ny, nx) == WALL) {
+                *cell(g, ny, nx) = FRONTIER;
+                frontier[size++] = (uint32_t) ny * (uint32_t) g->w
+                                   + (uint32_t) nx;
+            }
+        }
+
+        if (size == 0) {
+            break;
+        }
+
+        size_t i = rng_below((uint32_t) size);
+        uint32_t next = frontier[i];
+        frontier[i] = frontier[--size];
+        y = (int) (next / (uint32_t) g->w);
+        x = (int) (next % (uint32_t) g->w);
+
+        int options[N_MOVES];
+        int n_options = 0;
+        for (int d = 0; d < N_MOVES; d++) {
+            int ny = y + dr[d];
+            int nx = x + dc[d];
+            if (in_cells(g, ny, nx) && *cell(g, ny, nx) == FLOOR) {
+                options[n_options++] = d;
+            }
+        }
+
+        *wall(g, y, x, options[rng_below((uint32_t) n_options)]) = FLOOR;
+        *cell(g, y, x) = FLOOR;
+    }
+
+    free(frontier);
+    return 0;
+}
+
+/* Open up a 'fraction' of the dead ends of a perfect maze, each by removing
+ * a random wall that leads to another cell. */
+static void braid(struct grid *g, double fraction)
+{
+    for (int y = 0; y < g->w; y++) {
+        for (int x = 0; x < g->w; x++) {
+            int open = 0;
+            int closed[N_MOVES];
+            int n_closed = 0;
+            for (int d = 0; d < N_MOVES; d++) {
+                if (!in_cells(g, y + dr[d], x + dc[d])) {
+                    continue;
+                }
+                if (*wall(g, y, x, d) == FLOOR) {
+                    open++;
+                } else {
+                    closed[n_closed++] = d;
+                }
+            }
+
+            if (open == 1 && n_closed > 0
+                && (double) rng_below(1u << 30) < fraction * (1u << 30)) {
+                *wall(g, y, x, closed[rng_below((uint32_t) n_closed)]) = FLOOR;
+            }
+        }
+    }
+}
+
+/* Carve open rectangular rooms into a maze. */
+static void rooms(struct grid *g)
+{
+    size_t n_rooms = (size_t) g->w * (size_t) g->w / CELLS_PER_ROOM + 1;
+
+    for (size_t i = 0; i < n_rooms; i++) {
+        int h = 2 + (int) rng_below(ROOM_MAX - 1);
+        int w = 2 + (int) rng_below(ROOM_MAX - 1);
+        if (h > g->w) {
+            h = g->w;
+        }
+        if (w > g->w) {
+            w = g->w;
+        }
+
+        int y = (int) rng_below((uint32_t) (g->w - h + 1));
+        int x = (int) rng_below((uint32_t) (g->w - w + 1));
+        for (int r = 2 * y + 1; r <= 2 * (y + h) - 1; r++) {
+            memset(at(g, r, 2 * x + 1), FLOOR, (size_t) (2 * w - 1));
+        }
+    }
+}
+
+/* Wall in the destination cell, so that no path can reach it. */
+static void wall_off(struct grid *g, int y, int x)
+{
+    for (int d = 0; d < N_MOVES; d++) {
+        if (in_cells(g, y + dr[d], x + dc[d])) {
+            *wall(g, y, x, d) = WALL;
+        }
+    }
+}
+
+/* Union-find over the set labels of one row of Eller's algorithm. */
+static uint32_t set_find(uint32_t *parent, uint32_t s)
+{
+    while (parent[s] != s) {
+        parent[s] = parent[parent[s]];
+        s = parent[s];
+    }
+    return s;
+}
+
+/* Write a perfect maze to 'out' with Eller's algorithm. Each row of cells
+ * joins random neighbours that are in different sets, like Kruskal's
+ * algorithm does, and then every set gets at least one passage down. Only
+ * two rows of text are in memory at a time. */
+static int eller(int n, FILE *out)
+{
+    int w = (n - 1) / 2;
+    size_t stride = (size_t) n + 1;
+    char *cells = malloc(stride);
+    char *below = malloc(stride);
+    uint32_t *label = malloc((size_t) w * sizeof(uint32_t));
+    uint32_t *next_label = malloc((size_t) w * sizeof(uint32_t));
+    uint32_t *parent = malloc(2 * (size_t) w * sizeof(uint32_t));
+    uint32_t *renamed = malloc(2 * (size_t) w * sizeof(uint32_t));
+    int32_t *last = malloc(2 * (size_t) w * sizeof(int32_t));
+    bool *down = malloc(2 * (size_t) w * sizeof(bool));
+    int status = 1;
+
+    if (!cells || !below || !label || !next_label || !parent || !renamed
+        || !last || !down) {
+        goto out;
+    }
+
+    memset(cells, WALL, (size_t) n);
+    cells[n] = '\n';
+    memcpy(below, cells, stride);
+    fwrite(cells, 1, stride, out);
+
+    /* Labels are below 2 * w: at most w are carried down from the previous
+     * row and at most w are new. */
+    for (int x = 0; x < w; x++) {
+        label[x] = (uint32_t) x;
+    }
+
+    for (int y = 0; y < w; y++) {
+        bool last_row = y == w - 1;
+
+        for (uint32_t s = 0; s < 2 * (uint32_t) w; s++) {
+            parent[s] = s;
+        }
+
+        /* Join neighbours in different sets, always in the last row. The
+         * set of the left neighbour is carried along, as it stays a root. */
+        memset(cells, WALL, (size_t) n);
+        uint32_t a = label[0];
+        for (int x = 0; x < w; x++) {
+            cells[2 * x + 1] = FLOOR;
+            if (x + 1 == w) {
+                continue;
+            }
+
+            uint32_t b = set_find(parent, label[x + 1]);
+            if (a != b && (last_row || rng_bit())) {
+                parent[b] = a;
+                cells[2 * x + 2] = FLOOR;
+            } else {
+                a = b;
+            }
+        }
+
+        /* Later joins may have moved the sets of earlier cells, so look
+         * every set up once more and keep the result. */
+        for (int x = 0; x < w; x++) {
+            label[x] = set_find(parent, label[x]);
+        }
+        if (y == 0) {
+            cells[1] = START;
+        }
+        if (last_row) {
+            cells[2 * w - 1] = FINISH;
+        }
+        weigh(cells, 2 * y + 1, n);
+        fwrite(cells, 1, stride, out);
+
+        if (last_row) {
+            break;
+        }
+
+        /* Go down at random, and at least once for every set. */
+        for (uint32_t s = 0; s < 2 * (uint32_t) w; s++) {
+            down[s] = false;
+            renamed[s] = UINT32_MAX;
+        }
+        memset(below, WALL, (size_t) n);
+        for (int x = 0; x < w; x++) {
+            uint32_t s = label[x];
+            unsigned bit = rng_bit();
+            last[s] = x;
+            below[2 * x + 1] = bit ? FLOOR : WALL;
+            down[s] |= bit;
+        }
+        for (int x = 0; x < w; x++) {
+            uint32_t s = label[x];
+            if (!down[s] && last[s] == x) {
+                below[2 * x + 1] = FLOOR;
+                down[s] = true;
+            }
+        }
+
+        /* Cells with a passage down keep their set, renamed to a small
+         * label; the others start a new set. */
+        uint32_t fresh = 0;
+        for (int x = 0; x < w; x++) {
+            if (below[2 * x + 1] == FLOOR) {
+                uint32_t s = label[x];
+                if (renamed[s] == UINT32_MAX) {
+                    renamed[s] = fresh++;
+                }
+                next_label[x] = renamed[s];
+            } else {
+                next_label[x] = UINT32_MAX;
+            }
+        }
+        for (int x = 0; x < w; x++) {
+            if (next_label[x] == UINT32_MAX) {
+                next_label[x] = fresh++;
+            }
+        }
+        weigh(below, 2 * y + 2, n);
+        fwrite(below, 1, stride, out);
+
+        uint32_t *tmp = label;
+        label = next_label;
+        next_label = tmp;
+    }
+
+    /* Walls below the last row of cells, two rows if 'n' is even. */
+    memset(cells, WALL, (size_t) n);
+    for (int r = 2 * w; r < n; r++) {
+        fwrite(cells, 1, stride, out);
+    }
+    status = ferror(out) != 0;
+
+out:
+    free(cells);
+    free(below);
+    free(label);
+    free(next_label);
+    free(parent);
+    free(renamed);
+    free(last);
+    free(down);
+    return status;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-a backtracker|prim|eller|braid|rooms|"
+                    "impossible] [-s seed] [-p fraction] [-w max] "
+                    "[-o file] size\n",
+            prog);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *algorithm = "backtracker";
+    const char *filename = NULL;
+    uint64_t seed = 1;
+    double fraction = 1.0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "a:s:p:w:o:")) != -1) {
+        switch (opt) {
+        case 'a':
+            algorithm = optarg;
+            break;
+        case 's':
+            seed = strtoull(optarg, NULL, 0);
+            break;
+        case 'p':
+            fraction = atof(optarg);
+            break;
+        case 'w':
+            max_cost = atoi(optarg);
+            if (max_cost < 0 || max_cost > 9) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'o':
+            filename = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (optind + 1 != argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    long size = atol(argv[optind]);
+    if (size < 5 || size > 46340) {
+        /* maze_index() has to fit in an int. */
+        fprintf(stderr, "%s: size must be between 5 and 46340\n", argv[0]);
+        return 1;
+    }
+    int n = (int) size;
+
+    FILE *out = stdout;
+    if (filename != NULL) {
+        out = fopen(filename, "wb");
+        if (out == NULL) {
+            perror(filename);
+            return 1;
+        }
+    }
+
+    rng_seed(seed);
+    cost_seed = seed * 0xd1b54a32d192ed03u;
+
+    int status;
+    if (strcmp(algorithm, "eller") == 0) {
+        status = eller(n, out);
+    } else {
+        struct grid g;
+        if (grid_init(&g, n)) {
+            fprintf(stderr, "%s: out of memory\n", argv[0]);
+            return 1;
+        }
+
+        if (strcmp(algorithm, "prim") == 0) {
+            status = prim(&g);
+        } else if (strcmp(algorithm, "backtracker") == 0
+                   || strcmp(algorithm, "braid") == 0
+                   || strcmp(algorithm, "rooms") == 0
+                   || strcmp(algorithm, "impossible") == 0) {
+            status = backtracker(&g);
+            if (strcmp(algorithm, "braid") == 0) {
+                braid(&g, fraction);
+            } else if (strcmp(algorithm, "rooms") == 0) {
+                rooms(&g);
+            } else if (strcmp(algorithm, "impossible") == 0) {
+                wall_off(&g, g.w - 1, g.w - 1);
+            }
+        } else {
+            usage(argv[0]);
+            free(g.data);
+            return 1;
+        }
+
+        *cell(&g, 0, 0) = START;
+        *cell(&g, g.w - 1, g.w - 1) = FINISH;
+        if (status == 0) {
+            for (int r = 0; r < n; r++) {
+                weigh(at(&g, r, 0), r, n);
+            }
+            fwrite(g.data, 1, g.stride * (size_t) n, out);
+            status = ferror(out) != 0;
+        }
+        free(g.data);
+    }
+
+    if (out != stdout) {
+        status |= fclose(out) != 0;
+    }
+    if (status) {
+        fprintf(stderr, "%s: failed to generate the maze\n", argv[0]);
+    }
+    return status;
+}
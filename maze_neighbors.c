@@ -0,0 +1,82 @@
+/*
+ * maze_neighbors.c -- the flat copy of a maze used by the solvers
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "maze_neighbors.h"
+
+int maze_flat_load(struct maze_flat *f, const struct maze *m)
+{
+    if (f == NULL || m == NULL) {
+        return 1;
+    }
+
+    size_t size = maze_flat_bytes(maze_size(m));
+    char *base = malloc(size);
+    if (base == NULL) {
+        return 1;
+    }
+
+    return maze_flat_load_at(f, m, base, size);
+}
+
+int maze_flat_load_at(struct maze_flat *f, const struct maze *m, char *base,
+                      size_t size)
+{
+    if (f == NULL || m == NULL || base == NULL) {
+        return 1;
+    }
+
+    int n = maze_size(m);
+    if (size < maze_flat_bytes(n)) {
+        return 1;
+    }
+    memset(base, WALL, maze_flat_bytes(n));
+
+    f->n = n;
+    f->cells = base + n;
+    for (int d = 0; d < N_MOVES; d++) {
+        f->offsets[d] = m_offsets[d][0] * n + m_offsets[d][1];
+    }
+
+    for (int r = 1; r < n - 1; r++) {
+        char *row = f->cells + (size_t) r * (size_t) n;
+        for (int c = 1; c < n - 1; c++) {
+            row[c] = maze_get(m, r, c);
+        }
+    }
+
+    return 0;
+}
+
+void maze_flat_store(const struct maze_flat *f, struct maze *m)
+{
+    if (f == NULL || f->cells == NULL || m == NULL) {
+        return;
+    }
+
+    for (int r = 0; r < f->n; r++) {
+        const char *row = f->cells + (size_t) r * (size_t) f->n;
+        for (int c = 0; c < f->n; c++) {
+            if (row[c] != WALL && row[c] != FLOOR) {
+                maze_set(m, r, c, row[c]);
+            }
+        }
+    }
+}
+
+void maze_flat_cleanup(struct maze_flat *f)
+{
+    if (f == NULL || f->cells == NULL) {
+        return;
+    }
+
+    free(f->cells - f->n);
+    f->cells = NULL;
+}
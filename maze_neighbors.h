@@ -0,0 +1,98 @@
+#ifndef _MAZE_NEIGHBORS_H_
+#define _MAZE_NEIGHBORS_H_
+
+/* A flat copy of a maze for the inner loops of the solvers.
+ *
+ * maze_get() checks its bounds and computes r * n + c on every call, four
+ * times for each cell a solver expands. A struct maze_flat holds the cells
+ * in one array with a row of walls before and after it and walls on the
+ * border, so the neighbours of every cell, even one on the border, are
+ * found at the fixed index offsets {-n, +1, +n, -1} without any checks.
+ * maze_flat_neighbors() compares all four of them with a single word
+ * operation. Only the interface in maze.h is used to fill the copy and to
+ * write the marks of the solver back, so this works with every
+ * implementation of it. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "maze.h"
+
+/**
+ * struct maze_flat -- the cells of a maze in one array
+ * @n: the number of rows and columns
+ * @offsets: the index offset of the neighbour in each of the m_offsets
+ *           directions
+ * @cells: row-major cells, with n walls before and after them
+ */
+struct maze_flat {
+    int n;
+    int offsets[N_MOVES];
+    char *cells;
+};
+
+/* Fill 'f' with a copy of 'm' in which the border cells are walls. Return
+ * 0 if successful, 1 otherwise. */
+int maze_flat_load(struct maze_flat *f, const struct maze *m);
+
+/* Fill 'f' like maze_flat_load(), but in the 'size' bytes at 'base'
+ * instead of new memory, so that the memory can be used again for the
+ * next maze. Return 0 if successful, 1 if 'size' is less than
+ * maze_flat_bytes() of 'm'. maze_flat_cleanup() must not be called on 'f'
+ * then, 'base' stays with the caller. */
+int maze_flat_load_at(struct maze_flat *f, const struct maze *m, char *base,
+                      size_t size);
+
+/* Write every cell of 'f' that is neither a WALL nor a FLOOR to 'm'. */
+void maze_flat_store(const struct maze_flat *f, struct maze *m);
+
+/* Free the cells of 'f'. */
+void maze_flat_cleanup(struct maze_flat *f);
+
+/* Return the number of bytes allocated for the cells of a maze of size
+ * 'n'. */
+static inline size_t maze_flat_bytes(int n)
+{
+    return (size_t) n * (size_t) n + 2 * (size_t) n;
+}
+
+/* Return the index of row 'r', column 'c', as maze_index() does. */
+static inline int maze_flat_index(const struct maze_flat *f, int r, int c)
+{
+    return r * f->n + c;
+}
+
+static inline char maze_flat_get(const struct maze_flat *f, int index)
+{
+    return f->cells[index];
+}
+
+static inline void maze_flat_set(struct maze_flat *f, int index, char value)
+{
+    f->cells[index] = value;
+}
+
+/* Return a mask with bit d set if the neighbour of the cell at 'index' in
+ * direction d of m_offsets holds 'value'.
+ *
+ * The four neighbours are packed into one 32-bit word and compared with
+ * 'value' in every byte at once: a byte of the exclusive or is zero
+ * exactly where they match, and the carry-free test below sets the top
+ * bit of those bytes only. The multiplication then gathers the four top
+ * bits into bits 21 to 24. */
+static inline unsigned int maze_flat_neighbors(const struct maze_flat *f,
+                                               int index, char value)
+{
+    const unsigned char *cell = (const unsigned char *) f->cells + index;
+    uint32_t x = (uint32_t) cell[f->offsets[0]]
+                 | (uint32_t) cell[f->offsets[1]] << 8
+                 | (uint32_t) cell[f->offsets[2]] << 16
+                 | (uint32_t) cell[f->offsets[3]] << 24;
+
+    x ^= 0x01010101u * (unsigned char) value;
+    uint32_t zero = ~(((x & 0x7f7f7f7fu) + 0x7f7f7f7fu) | x | 0x7f7f7f7fu);
+    return (unsigned int) ((((zero >> 7) * 0x00204081u) >> 21) & 0xfu);
+}
+
+#endif
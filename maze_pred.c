@@ -0,0 +1,53 @@
+/*
+ * maze_pred.c -- the packed way back to the start of a search
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+#include <stdlib.h>
+
+#include "maze_pred.h"
+
+int maze_pred_init(struct maze_pred *p, int n)
+{
+    if (p == NULL || n < 0) {
+        return 1;
+    }
+
+    /* Every cell is set before it is read, so the bits need no clearing. */
+    p->bits = malloc(maze_pred_bytes(n));
+    if (p->bits == NULL) {
+        return 1;
+    }
+    p->n = n;
+
+    return 0;
+}
+
+void maze_pred_cleanup(struct maze_pred *p)
+{
+    if (p == NULL) {
+        return;
+    }
+
+    free(p->bits);
+    p->bits = NULL;
+}
+
+int maze_pred_mark(const struct maze_pred *p, struct maze_flat *f,
+                   int index, int start, char value)
+{
+    if (p == NULL || f == NULL) {
+        return 0;
+    }
+
+    int length = 0;
+    while (index != start) {
+        maze_flat_set(f, index, value);
+        index -= f->offsets[maze_pred_get(p, index)];
+        length++;
+    }
+
+    return length;
+}
@@ -0,0 +1,61 @@
+#ifndef _MAZE_PRED_H_
+#define _MAZE_PRED_H_
+
+/* The way back to the start of a search, at two bits per cell.
+ *
+ * A search that reaches a cell only needs to remember from which of the
+ * four m_offsets directions it came, not the row and column it came from.
+ * The directions are packed four to a byte and indexed like the cells of a
+ * struct maze_flat, so a maze of 30000 by 30000 cells needs 225 MB. The
+ * path is found again by stepping back against the recorded directions. */
+
+#include <stddef.h>
+
+#include "maze_neighbors.h"
+
+/**
+ * struct maze_pred -- the direction each cell was reached in
+ * @n: the number of rows and columns
+ * @bits: two bits per cell, the cell at index i in bits 2 * (i % 4) and up
+ *        of byte i / 4
+ */
+struct maze_pred {
+    int n;
+    unsigned char *bits;
+};
+
+/* Set up 'p' for a maze of size 'n'. Return 0 if successful, 1 otherwise. */
+int maze_pred_init(struct maze_pred *p, int n);
+
+/* Free the directions of 'p'. */
+void maze_pred_cleanup(struct maze_pred *p);
+
+/* Mark the cells on the way back from 'index' to 'start' in 'f' with
+ * 'value', leaving out 'start', and return the number of steps. */
+int maze_pred_mark(const struct maze_pred *p, struct maze_flat *f,
+                   int index, int start, char value);
+
+/* Return the number of bytes allocated for a maze of size 'n'. */
+static inline size_t maze_pred_bytes(int n)
+{
+    return ((size_t) n * (size_t) n + 3) / 4;
+}
+
+/* Record that the cell at 'index' was reached in direction 'direction'. */
+static inline void maze_pred_set(struct maze_pred *p, int index,
+                                 unsigned int direction)
+{
+    unsigned char *byte = p->bits + (size_t) index / 4;
+    unsigned int shift = ((unsigned int) index % 4) * 2;
+    *byte = (unsigned char) ((*byte & ~(3u << shift)) | direction << shift);
+}
+
+/* Return the direction the cell at 'index' was reached in. */
+static inline unsigned int maze_pred_get(const struct maze_pred *p,
+                                         int index)
+{
+    unsigned int shift = ((unsigned int) index % 4) * 2;
+    return (p->bits[(size_t) index / 4] >> shift) & 3u;
+}
+
+#endif
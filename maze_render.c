@@ -0,0 +1,498 @@
+/*
+ * maze_render.c -- row-buffered text and image output of a maze
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+// Needed for sysconf()
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "maze_render.h"
+
+#define START 'S'
+#define FINISH 'D'
+
+/* Number of output bytes a thread renders before the block is written. */
+#define BAND_BYTES (1 << 20)
+
+/* Every character is copied as three bytes, so buffers need two spare
+ * bytes after the last character. */
+#define SLACK 2
+
+enum render_kind { RENDER_TEXT, RENDER_PPM, RENDER_PGM };
+
+/**
+ * struct lut -- the output bytes of every maze character
+ * @bytes: the output bytes of each character, up to three
+ * @len: the number of bytes used in @bytes for each character
+ * @start: the output bytes of the start
+ * @start_len: the number of bytes used in @start
+ * @finish: the output bytes of the destination
+ * @finish_len: the number of bytes used in @finish
+ * @sr: the row of the start
+ * @sc: the column of the start
+ * @dr: the row of the destination
+ * @dc: the column of the destination
+ */
+struct lut {
+    unsigned char bytes[256][3];
+    unsigned char len[256];
+    unsigned char start[3];
+    unsigned char start_len;
+    unsigned char finish[3];
+    unsigned char finish_len;
+    int sr, sc, dr, dc;
+};
+
+/**
+ * struct band -- consecutive rows rendered by one thread
+ * @lut: the lookup table for the output format
+ * @n: the number of columns of the maze
+ * @cells: the characters of the rows of the band, @n per row
+ * @first: the first row of the band
+ * @rows: the number of rows in the band
+ * @newline: whether each row ends with a newline
+ * @buf: the rendered rows
+ * @size: the number of bytes used in @buf
+ * @thread: the thread rendering the band
+ *
+ * The threads only see @cells, which the calling thread reads from the
+ * maze, so the maze itself is never used by more than one thread.
+ */
+struct band {
+    const struct lut *lut;
+    int n;
+    const char *cells;
+    int first;
+    int rows;
+    bool newline;
+    unsigned char *buf;
+    size_t size;
+    pthread_t thread;
+};
+
+static void set3(unsigned char out[3], unsigned char a, unsigned char b,
+                 unsigned char c)
+{
+    out[0] = a;
+    out[1] = b;
+    out[2] = c;
+}
+
+/* Fill in 'lut' for 'kind' output of 'm'. The colours are the ones of
+ * maze_output_ppm(). */
+static void lut_init(struct lut *lut, const struct maze *m,
+                     enum render_kind kind, bool blocks)
+{
+    for (int ch = 0; ch < 256; ch++) {
+        switch (kind) {
+        case RENDER_TEXT:
+            set3(lut->bytes[ch], (unsigned char) ch, 0, 0);
+            lut->len[ch] = 1;
+            break;
+        case RENDER_PPM:
+            set3(lut->bytes[ch], 0, 0, 0);
+            lut->len[ch] = 3;
+            break;
+        case RENDER_PGM:
+            set3(lut->bytes[ch], MAZE_RENDER_GREY_FLOOR, 0, 0);
+            lut->len[ch] = 1;
+            break;
+        }
+    }
+
+    maze_start(m, &lut->sr, &lut->sc);
+    maze_destination(m, &lut->dr, &lut->dc);
+    bool start_is_wall = maze_get(m, lut->sr, lut->sc) == WALL;
+
+    switch (kind) {
+    case RENDER_TEXT:
+        if (blocks) {
+            /* U+2588 FULL BLOCK */
+            set3(lut->bytes[(unsigned char) WALL], 0xe2, 0x96, 0x88);
+            lut->len[(unsigned char) WALL] = 3;
+        }
+        if (blocks && start_is_wall) {
+            memcpy(lut->start, lut->bytes[(unsigned char) WALL], 3);
+            lut->start_len = 3;
+        } else {
+            set3(lut->start, START, 0, 0);
+            lut->start_len = 1;
+        }
+        set3(lut->finish, FINISH, 0, 0);
+        lut->finish_len = 1;
+        break;
+    case RENDER_PPM:
+        set3(lut->bytes[(unsigned char) WALL], 255, 255, 255);
+        set3(lut->bytes[(unsigned char) PATH], 255, 0, 0);
+        set3(lut->bytes[(unsigned char) VISITED], 128, 128, 128);
+        set3(lut->start, 0, 255, 0);
+        set3(lut->finish, 255, 165, 0);
+        lut->start_len = 3;
+        lut->finish_len = 3;
+        break;
+    case RENDER_PGM:
+        lut->bytes[(unsigned char) WALL][0] = MAZE_RENDER_GREY_WALL;
+        lut->bytes[(unsigned char) PATH][0] = MAZE_RENDER_GREY_PATH;
+        lut->bytes[(unsigned char) VISITED][0] = MAZE_RENDER_GREY_VISITED;
+        set3(lut->start, MAZE_RENDER_GREY_START, 0, 0);
+        set3(lut->finish, MAZE_RENDER_GREY_DESTINATION, 0, 0);
+        lut->start_len = 1;
+        lut->finish_len = 1;
+        break;
+    }
+
+    /* The destination on a wall is drawn as a wall by maze_print(). */
+    if (kind == RENDER_TEXT && blocks
+        && maze_get(m, lut->dr, lut->dc) == WALL) {
+        memcpy(lut->finish, lut->bytes[(unsigned char) WALL], 3);
+        lut->finish_len = 3;
+    }
+}
+
+/* Render columns [c0, c1) of 'row' to 'out'. Return the end of the
+ * output. */
+static unsigned char *render_span(const struct lut *lut, const char *row,
+                                  int c0, int c1, unsigned char *out)
+{
+    for (int c = c0; c < c1; c++) {
+        unsigned char ch = (unsigned char) row[c];
+        memcpy(out, lut->bytes[ch], 3);
+        out += lut->len[ch];
+    }
+    return out;
+}
+
+/* Render 'row', row 'r' of 'n' columns, to 'out'. The start and
+ * destination are drawn between spans, so the inner loop has no per-cell
+ * checks. Return the end of the output. */
+static unsigned char *render_row(const struct lut *lut, int n, int r,
+                                 const char *row, unsigned char *out)
+{
+    int sr = lut->sr, sc = lut->sc, dr = lut->dr, dc = lut->dc;
+
+    /* At most two special columns, in order. The start wins if both are
+     * the same cell, as in maze_print(). */
+    int cols[2];
+    const unsigned char *bytes[2];
+    int lens[2];
+    int n_special = 0;
+    if (r == sr) {
+        cols[n_special] = sc;
+        bytes[n_special] = lut->start;
+        lens[n_special++] = lut->start_len;
+    }
+    if (r == dr && !(dr == sr && dc == sc)) {
+        cols[n_special] = dc;
+        bytes[n_special] = lut->finish;
+        lens[n_special++] = lut->finish_len;
+        if (n_special == 2 && cols[0] > cols[1]) {
+            int col = cols[0];
+            const unsigned char *b = bytes[0];
+            int len = lens[0];
+            cols[0] = cols[1];
+            bytes[0] = bytes[1];
+            lens[0] = lens[1];
+            cols[1] = col;
+            bytes[1] = b;
+            lens[1] = len;
+        }
+    }
+
+    int c = 0;
+    for (int i = 0; i < n_special; i++) {
+        out = render_span(lut, row, c, cols[i], out);
+        memcpy(out, bytes[i], 3);
+        out += lens[i];
+        c = cols[i] + 1;
+    }
+    return render_span(lut, row, c, n, out);
+}
+
+static void *band_run(void *arg)
+{
+    struct band *band = arg;
+    unsigned char *out = band->buf;
+
+    const char *row = band->cells;
+
+    for (int r = band->first; r < band->first + band->rows; r++) {
+        out = render_row(band->lut, band->n, r, row, out);
+        row += band->n;
+        if (band->newline) {
+            *out++ = '\n';
+        }
+    }
+    band->size = (size_t) (out - band->buf);
+    return NULL;
+}
+
+/* Return the number of threads to use for 'threads' on 'm'. */
+static int thread_count(const struct maze *m, int threads)
+{
+    if (threads <= 0) {
+        long cells = (long) maze_size(m) * maze_size(m);
+        threads = 1;
+        if (cells >= MAZE_RENDER_PARALLEL_CELLS) {
+            long online = sysconf(_SC_NPROCESSORS_ONLN);
+            threads = online > 0 ? (int) (online < MAZE_RENDER_MAX_THREADS
+                                          ? online : MAZE_RENDER_MAX_THREADS)
+                                 : 1;
+        }
+    }
+    return threads > MAZE_RENDER_MAX_THREADS ? MAZE_RENDER_MAX_THREADS
+                                             : threads;
+}
+
+/* Render all rows of 'm' to 'fp'. Each round reads the rows of one band
+ * per thread from the maze on the calling thread, as maze.h promises
+ * nothing about calls from several threads, renders the bands in
+ * parallel and then writes them in order. */
+static int render_rows(const struct maze *m, FILE *fp, enum render_kind kind,
+                       bool blocks, int threads)
+{
+    int n = maze_size(m);
+    struct lut lut;
+    struct band bands[MAZE_RENDER_MAX_THREADS];
+    int status = 0;
+
+    lut_init(&lut, m, kind, blocks);
+    threads = thread_count(m, threads);
+
+    size_t stride = (size_t) n;
+    if (kind == RENDER_PPM || (kind == RENDER_TEXT && blocks)) {
+        stride *= 3;
+    }
+    if (kind == RENDER_TEXT) {
+        stride += 1;
+    }
+    int band_rows = (int) (BAND_BYTES / stride);
+    if (band_rows < 1) {
+        band_rows = 1;
+    }
+    if (band_rows * threads > n) {
+        band_rows = (n + threads - 1) / threads;
+    }
+
+    size_t band_cells = (size_t) n * (size_t) band_rows;
+    char *cells = malloc(band_cells * (size_t) threads);
+    if (cells == NULL) {
+        return 1;
+    }
+
+    for (int t = 0; t < threads; t++) {
+        bands[t].lut = &lut;
+        bands[t].n = n;
+        bands[t].cells = cells + band_cells * (size_t) t;
+        bands[t].newline = kind == RENDER_TEXT;
+        bands[t].buf = malloc(stride * (size_t) band_rows + SLACK);
+        if (bands[t].buf == NULL) {
+            for (int i = 0; i < t; i++) {
+                free(bands[i].buf);
+            }
+            free(cells);
+            return 1;
+        }
+    }
+
+    for (int first = 0; first < n; first += band_rows * threads) {
+        bool started[MAZE_RENDER_MAX_THREADS] = { false };
+        int last = first + band_rows * threads;
+        if (last > n) {
+            last = n;
+        }
+
+        char *cell = cells;
+        for (int r = first; r < last; r++) {
+            for (int c = 0; c < n; c++) {
+                *cell++ = maze_get(m, r, c);
+            }
+        }
+
+        for (int t = 0; t < threads; t++) {
+            bands[t].first = first + t * band_rows;
+            bands[t].rows = n - bands[t].first;
+            if (bands[t].rows > band_rows) {
+                bands[t].rows = band_rows;
+            }
+            if (bands[t].rows < 0) {
+                bands[t].rows = 0;
+            }
+            if (t > 0 && bands[t].rows > 0) {
+                started[t] = pthread_create(&bands[t].thread, NULL, band_run,
+                                            &bands[t]) == 0;
+            }
+        }
+
+        band_run(&bands[0]);
+        for (int t = 1; t < threads; t++) {
+            if (started[t]) {
+                pthread_join(bands[t].thread, NULL);
+            } else {
+                band_run(&bands[t]);
+            }
+        }
+
+        for (int t = 0; t < threads; t++) {
+            if (fwrite(bands[t].buf, 1, bands[t].size, fp) != bands[t].size) {
+                status = 1;
+            }
+        }
+        if (status) {
+            break;
+        }
+    }
+
+    for (int t = 0; t < threads; t++) {
+        free(bands[t].buf);
+    }
+    free(cells);
+    return status;
+}
+
+int maze_render_text(const struct maze *m, FILE *fp, bool blocks,
+                     int threads)
+{
+    if (m == NULL || fp == NULL) {
+        return 1;
+    }
+
+    if (render_rows(m, fp, RENDER_TEXT, blocks, threads)) {
+        return 1;
+    }
+    fputc('\n', fp);
+    return ferror(fp) != 0;
+}
+
+/* Write an image of 'kind' with the header 'magic'. */
+static int render_image(const struct maze *m, const char *filename,
+                        enum render_kind kind, const char *magic, int threads)
+{
+    if (m == NULL || filename == NULL) {
+        return 1;
+    }
+
+    FILE *fp = fopen(filename, "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "Cannot open file %s\n", filename);
+        return 1;
+    }
+
+    fprintf(fp, "%s\n%d %d\n255\n", magic, maze_size(m), maze_size(m));
+    int status = render_rows(m, fp, kind, false, threads);
+    if (fclose(fp) != 0) {
+        status = 1;
+    }
+    return status;
+}
+
+int maze_render_ppm(const struct maze *m, const char *filename, int threads)
+{
+    return render_image(m, filename, RENDER_PPM, "P6", threads);
+}
+
+int maze_render_pgm(const struct maze *m, const char *filename, int threads)
+{
+    return render_image(m, filename, RENDER_PGM, "P5", threads);
+}
+
+int maze_render_overview(const struct maze *m, const char *filename,
+                         int size)
+{
+    if (m == NULL || filename == NULL || size < 0) {
+        return 1;
+    }
+    if (size == 0) {
+        size = MAZE_RENDER_OVERVIEW_SIZE;
+    }
+
+    int n = maze_size(m);
+    int k = (n + size - 1) / size;
+    int w = (n + k - 1) / k;
+    struct lut lut;
+    lut_init(&lut, m, RENDER_PPM, false);
+
+    int sr, sc, dr, dc;
+    maze_start(m, &sr, &sc);
+    maze_destination(m, &dr, &dc);
+
+    uint64_t *sums = malloc(3 * (size_t) w * sizeof(uint64_t));
+    uint32_t *counts = malloc((size_t) w * sizeof(uint32_t));
+    const unsigned char **marks = malloc((size_t) w * sizeof(*marks));
+    unsigned char *row = malloc(3 * (size_t) w);
+    FILE *fp = NULL;
+    int status = 1;
+
+    if (sums == NULL || counts == NULL || marks == NULL || row == NULL) {
+        goto out;
+    }
+
+    fp = fopen(filename, "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "Cannot open file %s\n", filename);
+        goto out;
+    }
+    fprintf(fp, "P6\n%d %d\n255\n", w, w);
+
+    for (int y = 0; y < w; y++) {
+        memset(sums, 0, 3 * (size_t) w * sizeof(uint64_t));
+        memset(counts, 0, (size_t) w * sizeof(uint32_t));
+        memset(marks, 0, (size_t) w * sizeof(*marks));
+
+        int last = (y + 1) * k < n ? (y + 1) * k : n;
+        for (int r = y * k; r < last; r++) {
+            for (int c = 0; c < n; c++) {
+                unsigned char ch = (unsigned char) maze_get(m, r, c);
+                const unsigned char *rgb = lut.bytes[ch];
+                int x = c / k;
+                sums[3 * x] += rgb[0];
+                sums[3 * x + 1] += rgb[1];
+                sums[3 * x + 2] += rgb[2];
+                counts[x]++;
+                if (ch == PATH && marks[x] == NULL) {
+                    marks[x] = lut.bytes[(unsigned char) PATH];
+                }
+            }
+
+            /* The start is drawn over the destination over the path. */
+            if (r == dr && marks[dc / k] != lut.start) {
+                marks[dc / k] = lut.finish;
+            }
+            if (r == sr) {
+                marks[sc / k] = lut.start;
+            }
+        }
+
+        for (int x = 0; x < w; x++) {
+            if (marks[x] != NULL) {
+                memcpy(&row[3 * x], marks[x], 3);
+            } else {
+                for (int i = 0; i < 3; i++) {
+                    row[3 * x + i] = (unsigned char) (sums[3 * x + i]
+                                                      / counts[x]);
+                }
+            }
+        }
+        fwrite(row, 1, 3 * (size_t) w, fp);
+    }
+
+    status = ferror(fp) != 0;
+
+out:
+    if (fp != NULL && fclose(fp) != 0) {
+        status = 1;
+    }
+    free(sums);
+    free(counts);
+    free(marks);
+    free(row);
+    return status;
+}
@@ -0,0 +1,63 @@
+#ifndef _MAZE_RENDER_H_
+#define _MAZE_RENDER_H_
+
+/* Fast output of a maze, as text like maze_print() or as an image like
+ * maze_output_ppm(), which it replaces for large mazes.
+ *
+ * Rows are translated into a buffer through a lookup table from the maze
+ * character to its output bytes and written in blocks of many rows. The
+ * cells of a block are read with maze_get() on the calling thread and only
+ * their translation is split over several threads, so this works with
+ * every implementation of maze.h, also ones that change state on reads
+ * like maze_tiled.c.
+ *
+ * A 'threads' argument of 0 uses one thread per online processor for
+ * mazes of at least MAZE_RENDER_PARALLEL_CELLS cells and one otherwise. */
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "maze.h"
+
+/* Smallest number of cells for which 0 threads means more than one. */
+#define MAZE_RENDER_PARALLEL_CELLS (1 << 22)
+
+/* Largest number of threads used to render. */
+#define MAZE_RENDER_MAX_THREADS 16
+
+/* Largest width and height of an overview when a size of 0 is given. */
+#define MAZE_RENDER_OVERVIEW_SIZE 1024
+
+/* Grey levels of the cells in maze_render_pgm(). */
+#define MAZE_RENDER_GREY_FLOOR 0
+#define MAZE_RENDER_GREY_PATH 64
+#define MAZE_RENDER_GREY_VISITED 128
+#define MAZE_RENDER_GREY_DESTINATION 160
+#define MAZE_RENDER_GREY_START 192
+#define MAZE_RENDER_GREY_WALL 255
+
+/* Write 'm' to 'fp' exactly as maze_print() writes it to stdout. Return 0
+ * if successful, 1 otherwise. */
+int maze_render_text(const struct maze *m, FILE *fp, bool blocks,
+                     int threads);
+
+/* Write 'm' to 'filename' as a colour image exactly as maze_output_ppm()
+ * does. Return 0 if successful, 1 otherwise. */
+int maze_render_ppm(const struct maze *m, const char *filename, int threads);
+
+/* Write 'm' to 'filename' as a greyscale (P5) image with one byte per cell,
+ * a third of the size of the colour image. Every kind of cell has its own
+ * MAZE_RENDER_GREY_ level, so the image can also be read as a palette
+ * image. Return 0 if successful, 1 otherwise. */
+int maze_render_pgm(const struct maze *m, const char *filename, int threads);
+
+/* Write a colour image of at most 'size' by 'size' pixels of 'm' to
+ * 'filename', or of at most MAZE_RENDER_OVERVIEW_SIZE if 'size' is 0. Each
+ * pixel covers a square of cells and has their average colour, unless the
+ * square holds the start, the destination or a part of the path, which
+ * are always shown in their own colour. Return 0 if successful, 1
+ * otherwise. */
+int maze_render_overview(const struct maze *m, const char *filename,
+                         int size);
+
+#endif
@@ -0,0 +1,436 @@
+/*
+ * maze_simd.c -- an implementation of maze.h with a vectorized maze_read()
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+// Needed for getline()
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86 1
+#include <immintrin.h>
+#else
+#define HAVE_X86 0
+#endif
+
+#include "maze_simd.h"
+
+#define START 'S'
+#define FINISH 'D'
+
+struct maze {
+    int n;
+    int start_index;
+    int finish_index;
+    char *data;
+};
+
+/* Move offsets: (row, column) We can only move in four directions.
+ *
+ *           (-1,0)
+ *    (0, -1)      (0, 1)
+ *           (1, 0)
+ */
+int m_offsets[N_MOVES][2] = { { -1, 0 }, { 0, 1 }, { 1, 0 }, { 0, -1 } };
+
+/**
+ * struct markers -- the last start and destination found in a row
+ * @start: the column of the last START, or -1
+ * @finish: the column of the last FINISH, or -1
+ */
+struct markers {
+    long start;
+    long finish;
+};
+
+/* Converts the 'len' characters at 'in' to WALL or FLOOR at 'out' and
+ * records the markers among them. */
+typedef void (*convert_fn)(const char *in, char *out, size_t len,
+                           struct markers *found);
+
+/* The level maze_read() uses, -1 until it is chosen. */
+static int level = -1;
+
+/* Convert characters [i, len) one at a time. A wall is told apart without
+ * a branch, which would be mispredicted on every other cell of a random
+ * maze, only the rare markers are branched on. */
+static void convert_scalar_from(const char *in, char *out, size_t i,
+                                size_t len, struct markers *found)
+{
+    long start = found->start;
+    long finish = found->finish;
+
+    for (; i < len; i++) {
+        char ch = in[i];
+        unsigned int is_wall = ch == WALL;
+        out[i] = (char) (FLOOR ^ (-is_wall & (WALL ^ FLOOR)));
+        if (ch == START) {
+            start = (long) i;
+        } else if (ch == FINISH) {
+            finish = (long) i;
+        }
+    }
+    found->start = start;
+    found->finish = finish;
+}
+
+static void convert_scalar(const char *in, char *out, size_t len,
+                           struct markers *found)
+{
+    convert_scalar_from(in, out, 0, len, found);
+}
+
+#if HAVE_X86
+/* Record the highest bit of 'mask' as a column of the block at 'i'. */
+static inline void last_bit(unsigned int mask, size_t i, long *column)
+{
+    if (mask != 0) {
+        *column = (long) i + 31 - __builtin_clz(mask);
+    }
+}
+
+/* A WALL stays a WALL and every other character becomes a FLOOR, which is
+ * FLOOR ^ ((is WALL) & (WALL ^ FLOOR)) in each byte. The markers are rare,
+ * so one test of both masks skips them in almost every block. */
+__attribute__((target("sse2")))
+static void convert_sse2_from(const char *in, char *out, size_t i,
+                              size_t len, struct markers *found)
+{
+    const __m128i walls = _mm_set1_epi8(WALL);
+    const __m128i floors = _mm_set1_epi8(FLOOR);
+    const __m128i flip = _mm_set1_epi8(WALL ^ FLOOR);
+    const __m128i starts = _mm_set1_epi8(START);
+    const __m128i finishes = _mm_set1_epi8(FINISH);
+
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (const void *) (in + i));
+        __m128i is_wall = _mm_cmpeq_epi8(v, walls);
+        _mm_storeu_si128((__m128i *) (void *) (out + i),
+                         _mm_xor_si128(floors, _mm_and_si128(is_wall, flip)));
+
+        __m128i is_start = _mm_cmpeq_epi8(v, starts);
+        __m128i is_finish = _mm_cmpeq_epi8(v, finishes);
+        if (_mm_movemask_epi8(_mm_or_si128(is_start, is_finish)) != 0) {
+            last_bit((unsigned int) _mm_movemask_epi8(is_start), i,
+                     &found->start);
+            last_bit((unsigned int) _mm_movemask_epi8(is_finish), i,
+                     &found->finish);
+        }
+    }
+    convert_scalar_from(in, out, i, len, found);
+}
+
+static void convert_sse2(const char *in, char *out, size_t len,
+                         struct markers *found)
+{
+    convert_sse2_from(in, out, 0, len, found);
+}
+
+/* The same with 32 characters at a time, and SSE2 for the rest of the
+ * row. */
+__attribute__((target("avx2")))
+static void convert_avx2(const char *in, char *out, size_t len,
+                         struct markers *found)
+{
+    const __m256i walls = _mm256_set1_epi8(WALL);
+    const __m256i floors = _mm256_set1_epi8(FLOOR);
+    const __m256i flip = _mm256_set1_epi8(WALL ^ FLOOR);
+    const __m256i starts = _mm256_set1_epi8(START);
+    const __m256i finishes = _mm256_set1_epi8(FINISH);
+    size_t i = 0;
+
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) (const void *)
+                                       (in + i));
+        __m256i is_wall = _mm256_cmpeq_epi8(v, walls);
+        _mm256_storeu_si256((__m256i *) (void *) (out + i),
+                            _mm256_xor_si256(floors,
+                                             _mm256_and_si256(is_wall, flip)));
+
+        __m256i is_start = _mm256_cmpeq_epi8(v, starts);
+        __m256i is_finish = _mm256_cmpeq_epi8(v, finishes);
+        __m256i is_marker = _mm256_or_si256(is_start, is_finish);
+        if (!_mm256_testz_si256(is_marker, is_marker)) {
+            last_bit((unsigned int) _mm256_movemask_epi8(is_start), i,
+                     &found->start);
+            last_bit((unsigned int) _mm256_movemask_epi8(is_finish), i,
+                     &found->finish);
+        }
+    }
+    convert_sse2_from(in, out, i, len, found);
+}
+#endif
+
+enum maze_simd_level maze_simd_best(void)
+{
+#if HAVE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return MAZE_SIMD_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return MAZE_SIMD_SSE2;
+    }
+#endif
+    return MAZE_SIMD_SCALAR;
+}
+
+enum maze_simd_level maze_simd_use(enum maze_simd_level wanted)
+{
+    enum maze_simd_level best = maze_simd_best();
+    level = (int) (wanted < best ? wanted : best);
+    return (enum maze_simd_level) level;
+}
+
+enum maze_simd_level maze_simd_level(void)
+{
+    if (level < 0) {
+        enum maze_simd_level wanted = MAZE_SIMD_AVX2;
+        const char *env = getenv("MAZE_SIMD");
+        if (env != NULL && strcmp(env, "scalar") == 0) {
+            wanted = MAZE_SIMD_SCALAR;
+        } else if (env != NULL && strcmp(env, "sse2") == 0) {
+            wanted = MAZE_SIMD_SSE2;
+        }
+        maze_simd_use(wanted);
+    }
+    return (enum maze_simd_level) level;
+}
+
+const char *maze_simd_name(enum maze_simd_level l)
+{
+    switch (l) {
+    case MAZE_SIMD_SCALAR:
+        return "scalar";
+    case MAZE_SIMD_SSE2:
+        return "sse2";
+    case MAZE_SIMD_AVX2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+/* Return the row converter of the level maze_read() uses. */
+static convert_fn converter(void)
+{
+    switch (maze_simd_level()) {
+    case MAZE_SIMD_SCALAR:
+        return convert_scalar;
+#if HAVE_X86
+    case MAZE_SIMD_SSE2:
+        return convert_sse2;
+    case MAZE_SIMD_AVX2:
+        return convert_avx2;
+#else
+    case MAZE_SIMD_SSE2:
+    case MAZE_SIMD_AVX2:
+        break;
+#endif
+    }
+    return convert_scalar;
+}
+
+/* Allocate a maze of 'n' rows by 'n' columns whose cells are not set. */
+static struct maze *maze_alloc(int n) {
+    if (n <= 0) {
+        return NULL;
+    }
+    struct maze *m = malloc(sizeof(struct maze));
+    if (!m) {
+        return NULL;
+    }
+    m->n = n;
+    m->data = malloc((size_t) n * (size_t) n);
+    if (!m->data) {
+        free(m);
+        return NULL;
+    }
+
+    // And finally set the default start and finish locations.
+    m->start_index = maze_index(m, 1, 1); // upper left
+    m->finish_index = maze_index(m, maze_size(m) - 2,
+                                 maze_size(m) - 2); // lower right
+    return m;
+}
+
+/* Creates a square maze structure of 'n' rows by 'n' columns filled with
+ * walls. maze_init() is not part of the maze interface, maze_read() fills
+ * every cell itself and uses maze_alloc().
+ * Returns a pointer to the initialized maze or NULL if an error occured. */
+struct maze *maze_init(int n) {
+    struct maze *m = maze_alloc(n);
+    if (m) {
+        memset(m->data, WALL, (size_t) n * (size_t) n);
+    }
+    return m;
+}
+
+void maze_cleanup(struct maze *m) {
+    free(m->data);
+    free(m);
+}
+
+char maze_get(const struct maze *m, int r, int c) {
+    assert(r >= 0 && r < m->n && c >= 0 && c < m->n);
+    return m->data[r * m->n + c];
+}
+
+void maze_set(struct maze *m, int r, int c, char value) {
+    assert(r >= 0 && r < m->n && c >= 0 && c < m->n);
+    m->data[r * m->n + c] = value;
+}
+
+void maze_print(const struct maze *m, bool blocks) {
+    for (int r = 0; r < m->n; r++) {
+        for (int c = 0; c < m->n; c++) {
+            if (blocks && maze_get(m, r, c) == WALL) {
+                printf("\u2588");
+            } else if (maze_at_start(m, r, c)) {
+                putchar(START);
+            } else if (maze_at_destination(m, r, c)) {
+                putchar(FINISH);
+            } else {
+                putchar(maze_get(m, r, c));
+            }
+        }
+        printf("\n");
+    }
+    printf("\n");
+}
+
+/* Set RGB values in color array */
+static void set_rgb(unsigned char color[], unsigned char r, unsigned char g,
+                    unsigned char b) {
+    color[0] = r;
+    color[1] = g;
+    color[2] = b;
+}
+
+/* The colors are the same as those of maze_output_ppm() in maze.c. */
+int maze_output_ppm(const struct maze *m, const char *filename) {
+    FILE *fp = fopen(filename, "wb");
+    if (!fp) {
+        fprintf(stderr, "Cannot open file %s\n", filename);
+        return 1;
+    }
+
+    /* Write header */
+    fprintf(fp, "P6\n%d %d\n255\n", (int) m->n, (int) m->n);
+
+    /* Write RGB color data for every cell location. */
+    for (int r = 0; r < m->n; r++) {
+        for (int c = 0; c < m->n; c++) {
+            unsigned char color[3] = { 0, 0, 0 }; // black
+            if (maze_at_start(m, r, c)) {
+                set_rgb(color, 0, 255, 0); // green
+            } else if (maze_at_destination(m, r, c)) {
+                set_rgb(color, 255, 165, 0); // orange
+            } else if (maze_get(m, r, c) == WALL) {
+                set_rgb(color, 255, 255, 255); // white
+            } else if (maze_get(m, r, c) == PATH) {
+                set_rgb(color, 255, 0, 0); // red
+            } else if (maze_get(m, r, c) == VISITED) {
+                set_rgb(color, 128, 128, 128); // gray
+            }
+            fwrite(color, 1, 3, fp);
+        }
+    }
+    fclose(fp);
+    return 0;
+}
+
+/* Reads the maze like maze_read() in maze.c: the first line sets the
+ * number of columns, rows follow as long as they have that length, and
+ * the line that ends the maze is read as well. The rows are converted
+ * whole by the converter of maze_simd_level(), and the last start and
+ * destination of each row are kept, so the last ones in the maze win. */
+struct maze *maze_read(void) {
+    char *buf = NULL;
+    size_t bufsize = 0;
+
+    /* Read one line to get number of columns so we can allocate the maze. */
+    int ncols = (int) getline(&buf, &bufsize, stdin) - 1;
+    struct maze *m = maze_alloc(ncols);
+    if (!m) {
+        free(buf);
+        return NULL;
+    }
+
+    convert_fn convert = converter();
+    size_t width = (size_t) ncols;
+    int row = 0;
+    do {
+        if (row == ncols) { /* Error: more rows than columns */
+            maze_cleanup(m);
+            free(buf);
+            return NULL;
+        }
+
+        struct markers found = { -1, -1 };
+        convert(buf, m->data + (size_t) row * width, width, &found);
+        if (found.start >= 0) {
+            m->start_index = maze_index(m, row, (int) found.start);
+        }
+        if (found.finish >= 0) {
+            m->finish_index = maze_index(m, row, (int) found.finish);
+        }
+        row++;
+    } while (getline(&buf, &bufsize, stdin) == ncols + 1); // ncols + \n
+
+    if (row < ncols) { /* Error: more columns than rows */
+        maze_cleanup(m);
+        m = NULL;
+    }
+
+    free(buf);
+    return m;
+}
+
+void maze_start(const struct maze *m, int *r, int *c) {
+    *r = maze_row(m, m->start_index);
+    *c = maze_col(m, m->start_index);
+}
+
+void maze_destination(const struct maze *m, int *r, int *c) {
+    *r = maze_row(m, m->finish_index);
+    *c = maze_col(m, m->finish_index);
+}
+
+bool maze_at_start(const struct maze *m, int r, int c) {
+    return maze_index(m, r, c) == m->start_index;
+}
+
+bool maze_at_destination(const struct maze *m, int r, int c) {
+    return maze_index(m, r, c) == m->finish_index;
+}
+
+bool maze_valid_move(const struct maze *m, int r, int c) {
+    if (r > 0 && r < (m->n - 1) && c > 0 && c < (m->n - 1)) {
+        return true;
+    }
+    return false;
+}
+
+int maze_size(const struct maze *m) {
+    return m->n;
+}
+
+int maze_index(const struct maze *m, int r, int c) {
+    return m->n * r + c;
+}
+
+int maze_row(const struct maze *m, int index) {
+    return index / m->n;
+}
+
+int maze_col(const struct maze *m, int index) {
+    return index % m->n;
+}
@@ -0,0 +1,39 @@
+#ifndef _MAZE_SIMD_H_
+#define _MAZE_SIMD_H_
+
+/* Extensions to maze.h for the vectorized parser in maze_simd.c.
+ *
+ * maze_simd.c implements maze.h with the same grid as maze.c, but its
+ * maze_read() converts each row with vector compares instead of one
+ * maze_set() per character: 16 (SSE2) or 32 (AVX2) characters at a time
+ * are turned into WALL or FLOOR and searched for the start and the
+ * destination. Which kind of vectors is used is chosen once, as the best
+ * the processor supports, unless the MAZE_SIMD environment variable names
+ * a lesser one ("scalar", "sse2" or "avx2") or maze_simd_use() is
+ * called. Mazes and errors are exactly those of maze.c. */
+
+#include <stdbool.h>
+
+#include "maze.h"
+
+/* The kinds of vectors maze_read() can convert rows with. */
+enum maze_simd_level {
+    MAZE_SIMD_SCALAR,
+    MAZE_SIMD_SSE2,
+    MAZE_SIMD_AVX2
+};
+
+/* Return the best level this processor supports. */
+enum maze_simd_level maze_simd_best(void);
+
+/* Make maze_read() use 'level', or the best supported level below it.
+ * Return the level that is used. */
+enum maze_simd_level maze_simd_use(enum maze_simd_level level);
+
+/* Return the level maze_read() uses. */
+enum maze_simd_level maze_simd_level(void);
+
+/* Return the name of 'level', as MAZE_SIMD takes it. */
+const char *maze_simd_name(enum maze_simd_level level);
+
+#endif
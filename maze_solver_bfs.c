@@ -5,51 +5,212 @@
  * Universiteit van Amsterdam
  */
 
+// Needed for getopt()
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "maze.h"
+#include "maze_cache.h"
+#include "maze_distance.h"
+#include "maze_neighbors.h"
+#include "maze_pred.h"
+#include "maze_render.h"
 #include "queue.h"
+#include "queue_ext.h"
+#include "solver_pipeline.h"
+#include "solver_report.h"
+#include "solver_workspace.h"
 
 #define NOT_FOUND -1
 #define ERROR -2
 #define QUEUE_SIZE 4000
 
-static int ***new_graph(int maze_size)
+/* Number of mazes in the pipeline of -B: one being read, one being solved,
+ * one being written and one waiting. */
+#define PIPELINE_DEPTH 4
+
+/* maze_solver_bfs_tiled is built with BFS_MAZE_GET, so that the search
+ * reads and marks the cells in the maze itself. A flat copy would take
+ * n * n bytes of memory, which maze_tiled.c exists to avoid; only the
+ * predecessors, at two bits per cell, are kept in memory. */
+#ifdef BFS_MAZE_GET
+#define USE_FLAT false
+#else
+#define USE_FLAT true
+#endif
+
+/* Set by -q, keeps ulog() from tracing every cell. */
+static bool quiet;
+
+/* Filled in while solving, printed by -s. */
+static struct solver_report report;
+
+/**
+ * struct bfs_workspace -- what bfs_solve_helper() keeps between mazes
+ * @grid: the flat copy of the maze and the predecessors of its cells
+ * @rqueue: the rows of the cells to expand
+ * @cqueue: the columns of the cells to expand
+ *
+ * The queues are made by the first search and emptied by every later one,
+ * so they keep the capacity they grew to.
+ */
+static struct bfs_workspace {
+    struct solver_workspace grid;
+    struct queue *rqueue;
+    struct queue *cqueue;
+} workspace;
+
+static void ulog(const char *fmt, ...)
 {
-    int ***graph = malloc(maze_size * sizeof(int **));
+    if (quiet) {
+        return;
+    }
 
-    for (int i = 0; i < maze_size; i++) {
-        graph[i] = malloc(maze_size * sizeof(int *));
+    va_list va;
+    va_start(va, fmt);
+    fprintf(stderr, "bfs_solve_helper: ");
+    vfprintf(stderr, fmt, va);
+    va_end(va);
+}
 
-        for (int j = 0; j < maze_size; j++) {
-            graph[i][j] = malloc(sizeof(int) * 2);
-        }
+/* Keep the statistics of both queues and the memory of the workspace for
+ * the report. */
+static void record_stats(const struct bfs_workspace *w)
+{
+    struct container_stats stats;
+
+    report.extra_bytes += solver_workspace_bytes(&w->grid);
+    if (queue_get_stats(w->rqueue, &stats) == 0) {
+        solver_report_add(&report, "rqueue", &stats);
+        report.extra_bytes += stats.peak_bytes;
+    }
+    if (queue_get_stats(w->cqueue, &stats) == 0) {
+        solver_report_add(&report, "cqueue", &stats);
+        report.extra_bytes += stats.peak_bytes;
+    }
+}
+
+/* Get 'w' ready for a search in 'm'. Return 0 if successful, 1 otherwise. */
+static int workspace_reset(struct bfs_workspace *w, const struct maze *m)
+{
+    if (w->rqueue == NULL) {
+        w->rqueue = queue_init(QUEUE_SIZE);
+    }
+    if (w->cqueue == NULL) {
+        w->cqueue = queue_init(QUEUE_SIZE);
+    }
+    if (w->rqueue == NULL || w->cqueue == NULL) {
+        return 1;
+    }
+
+    /* A search that found the destination leaves its frontier behind. */
+    while (!queue_empty(w->rqueue)) {
+        queue_pop(w->rqueue);
+    }
+    while (!queue_empty(w->cqueue)) {
+        queue_pop(w->cqueue);
+    }
+
+    if (!USE_FLAT) {
+        return solver_workspace_reserve(&w->grid, m);
     }
+    return solver_workspace_load(&w->grid, m);
+}
 
-    return graph;
+static void workspace_cleanup(struct bfs_workspace *w)
+{
+    queue_cleanup(w->rqueue);
+    queue_cleanup(w->cqueue);
+    solver_workspace_cleanup(&w->grid);
+    w->rqueue = NULL;
+    w->cqueue = NULL;
 }
 
-static void free_graph(int ***graph, int maze_size)
+/* Return the cell at row 'r', column 'c' and index 'index' of 'm'. Border
+ * cells and cells outside 'm' are walls, as in the flat copy. */
+static char cell_get(const struct maze *m, const struct maze_flat *flat,
+                     int r, int c, int index)
 {
-    for (int i = 0; i < maze_size; i++) {
-        for (int j = 0; j < maze_size; j++) {
-            free(graph[i][j]);
+    if (USE_FLAT) {
+        return maze_flat_get(flat, index);
+    }
+
+    int n = maze_size(m);
+    if (r <= 0 || r >= n - 1 || c <= 0 || c >= n - 1) {
+        return WALL;
+    }
+    return maze_get(m, r, c);
+}
+
+static void cell_set(struct maze *m, struct maze_flat *flat, int r, int c,
+                     int index, char value)
+{
+    if (USE_FLAT) {
+        maze_flat_set(flat, index, value);
+    } else {
+        maze_set(m, r, c, value);
+    }
+}
+
+/* Return the mask of the directions in which the cell at row 'r', column
+ * 'c' and index 'index' of 'm' has a FLOOR neighbour. Border cells count
+ * as walls, as they do in the flat copy. */
+static unsigned int open_neighbors(const struct maze *m,
+                                   const struct maze_flat *flat, int r, int c,
+                                   int index)
+{
+    if (USE_FLAT) {
+        return maze_flat_neighbors(flat, index, FLOOR);
+    }
+
+    unsigned int open = 0;
+    for (unsigned int direction = 0; direction < N_MOVES; direction++) {
+        int nr = r + m_offsets[direction][0];
+        int nc = c + m_offsets[direction][1];
+        if (cell_get(m, flat, nr, nc, index) == FLOOR) {
+            open |= 1u << direction;
         }
-        free(graph[i]);
     }
-    free(graph);
+    return open;
 }
 
-static void ulog(const char *fmt, ...)
+/* Mark the way back from row 'r', column 'c' to the start at row 'sr',
+ * column 'sc' as PATH, leaving out the start. Return the number of
+ * steps. */
+static int mark_path(struct maze *m, struct bfs_workspace *w, int r, int c,
+                     int sr, int sc)
 {
-    va_list va;
-    va_start(va, fmt);
-    fprintf(stderr, "bfs_solve_helper: ");
-    vfprintf(stderr, fmt, va);
-    va_end(va);
+    struct maze_flat *flat = &w->grid.flat;
+    int n = maze_size(m);
+
+    if (USE_FLAT) {
+        return maze_pred_mark(&w->grid.pred, flat, maze_flat_index(flat, r, c),
+                              maze_flat_index(flat, sr, sc), PATH);
+    }
+
+    int length = 0;
+    while (r != sr || c != sc) {
+        maze_set(m, r, c, PATH);
+        unsigned int direction = maze_pred_get(&w->grid.pred, r * n + c);
+        r -= m_offsets[direction][0];
+        c -= m_offsets[direction][1];
+        length++;
+    }
+    return length;
+}
+
+/* Write the marks of the flat copy, if there is one, back to 'm'. */
+static void store_marks(struct bfs_workspace *w, struct maze *m)
+{
+    if (USE_FLAT) {
+        maze_flat_store(&w->grid.flat, m);
+    }
 }
 
 /**
@@ -60,6 +221,9 @@ static void ulog(const char *fmt, ...)
  * @dr: destination row
  * @dc: destination column
  *
+ * The queues, the flat copy of the maze and the predecessors come from the
+ * workspace, which keeps them for the next maze.
+ *
  * Return: the length of the path, if found; otherwise, NOT_FOUND if
  *         or ERROR if an error occured.
  */
@@ -68,68 +232,60 @@ int bfs_solve_helper(struct maze *m, int sr, int sc, int dr, int dc)
     ulog("start           = (%d, %d).\n", sr, sc);
     ulog("destination     = (%d, %d).\n", dr, dc);
 
-    struct queue *rqueue = queue_init(QUEUE_SIZE);
-    if (rqueue == NULL) {
-        return ERROR;
-    }
-
-    struct queue *cqueue = queue_init(QUEUE_SIZE);
-    if (cqueue == NULL) {
-        queue_cleanup(rqueue);
-        return ERROR;
-    }
-
-    int ***graph = new_graph(maze_size(m));
-    if (graph == NULL) {
-        queue_cleanup(rqueue);
-        queue_cleanup(cqueue);
+    if (workspace_reset(&workspace, m)) {
         return ERROR;
     }
+    struct queue *rqueue = workspace.rqueue;
+    struct queue *cqueue = workspace.cqueue;
+    struct maze_flat *flat = &workspace.grid.flat;
+    struct maze_pred *pred = &workspace.grid.pred;
+    int n = maze_size(m);
 
     queue_push(rqueue, sr);
     queue_push(cqueue, sc);
 
     while (1) {
+        if (queue_empty(rqueue)) {
+            ulog("nothing found, every reachable cell was visited.\n");
+            store_marks(&workspace, m);
+            return NOT_FOUND;
+        }
+
         int r = queue_peek(rqueue);
         int c = queue_peek(cqueue);
+        int index = r * n + c;
 
-        maze_set(m, r, c, VISITED);
+        cell_set(m, flat, r, c, index, VISITED);
 
         if (r == dr && c == dc) {
-            int path_length = 0;
-            while (1) {
-                if (r == sr && c == sc) {
-                    free_graph(graph, maze_size(m));
-                    queue_cleanup(rqueue);
-                    queue_cleanup(cqueue);
-                    return path_length;
-                }
-
-                maze_set(m, r, c, PATH);
-                int tmp = r;
-                r = graph[tmp][c][0];
-                c = graph[tmp][c][1];
-                path_length++;
-            }
+            report.expanded++;
+            int path_length = mark_path(m, &workspace, r, c, sr, sc);
+            store_marks(&workspace, m);
+            return path_length;
         }
 
         bool dead_end = true;
+        unsigned int open = open_neighbors(m, flat, r, c, index);
 
         for (size_t direction = 0; direction < N_MOVES; direction++) {
             int nr = r + m_offsets[direction][0];
             int nc = c + m_offsets[direction][1];
+            int next = nr * n + nc;
 
-            if (maze_get(m, nr, nc) == FLOOR) {
+            if (open & (1u << direction)) {
                 dead_end = false;
-                queue_push(rqueue, nr);
-                queue_push(cqueue, nc);
-                maze_set(m, nr, nc, VISITED);
-                graph[nr][nc][0] = r;
-                graph[nr][nc][1] = c;
-                ulog("next found at     (%d, %d).\n", nr, nc);
-            } else {
+                if (queue_push(rqueue, nr) || queue_push(cqueue, nc)) {
+                    ulog("queue_push failed at (%d, %d).\n", nr, nc);
+                    return ERROR;
+                }
+                cell_set(m, flat, nr, nc, next, VISITED);
+                maze_pred_set(pred, next, (unsigned int) direction);
+                if (!quiet) {
+                    ulog("next found at     (%d, %d).\n", nr, nc);
+                }
+            } else if (!quiet) {
                 ulog("blocking found at (%d, %d) is '%c'.\n",
-                     nr, nc, maze_get(m, nr, nc));
+                     nr, nc, cell_get(m, flat, nr, nc, next));
             }
         }
 
@@ -139,14 +295,12 @@ int bfs_solve_helper(struct maze *m, int sr, int sc, int dr, int dc)
                      "    queue_size(rqueue) == %zu;\n",
                      "    queue_size(cqueue) == %zu;\n",
                      queue_size(rqueue), queue_size(cqueue));
-                queue_cleanup(rqueue);
-                queue_cleanup(cqueue);
-                free_graph(graph, maze_size(m));
                 return ERROR;
             }
 
             queue_pop(rqueue);
             queue_pop(cqueue);
+            report.expanded++;
         }
     }
 }
@@ -200,31 +354,379 @@ int bfs_solve(struct maze *m) {
 }
 
 
-int main(void) {
-    /* read maze */
-    struct maze *m = maze_read();
-    if (!m) {
-        printf("Error reading maze\n");
+/* Compute the distance field 'field' to the destination of 'm'. Return 0
+ * if successful, 1 otherwise. */
+static int field_compute(struct maze_distance *field, const struct maze *m)
+{
+    int dr, dc;
+    maze_destination(m, &dr, &dc);
+    int destination = maze_index(m, dr, dc);
+
+    if (maze_distance_compute(field, m, &destination, 1)) {
         return 1;
     }
+    report.expanded += field->reached;
+    return 0;
+}
+
+/* Count the memory of 'field' in the report. */
+static void record_field(const struct maze_distance *field)
+{
+    size_t bytes = (size_t) field->n * (size_t) field->n * sizeof(int32_t);
+    if (bytes > report.extra_bytes) {
+        report.extra_bytes = bytes;
+    }
+}
+
+/* Mark the path from the start of 'm' down 'field' to the destination.
+ * Return the length of the path or NOT_FOUND. */
+static int field_descend(const struct maze_distance *field, struct maze *m)
+{
+    int sr, sc;
+    maze_start(m, &sr, &sc);
+
+    record_field(field);
+    int path_length = maze_distance_descend(field, m, sr, sc);
+    return path_length == MAZE_DISTANCE_UNREACHABLE ? NOT_FOUND : path_length;
+}
+
+/**
+ * field_solve -- solves a maze by a lookup in a distance field
+ * @m: the maze to solve
+ * @filename: the file the distance field is kept in
+ *
+ * Maps in the distance field to the destination that an earlier run on the
+ * same maze saved in 'filename'. If there is none, the field is computed
+ * with one breadth-first search from the destination and saved there. The
+ * path is then found by stepping from the start to a neighbour one closer
+ * to the destination, so every later run with another start costs no
+ * search at all.
+ *
+ * Return: the length of the path, if found; otherwise, NOT_FOUND if there
+ *         is none or ERROR if an error occured.
+ */
+static int field_solve(struct maze *m, const char *filename)
+{
+    int dr, dc;
+    maze_destination(m, &dr, &dc);
+    int destination = maze_index(m, dr, dc);
+    uint64_t key = maze_distance_key(m, &destination, 1);
+
+    struct maze_distance field;
+    if (maze_distance_load(&field, filename, key) == 0) {
+        ulog("distance field mapped from %s.\n", filename);
+    } else {
+        if (field_compute(&field, m)) {
+            return ERROR;
+        }
+        if (maze_distance_save(&field, filename, key)) {
+            ulog("could not save the distance field to %s.\n", filename);
+        }
+    }
+
+    int path_length = field_descend(&field, m);
+    maze_distance_cleanup(&field);
+    return path_length;
+}
+
+/* Write the image 'format' of the solved maze: "ppm" to out.ppm, "pgm" to
+ * out.pgm, "overview" to out_overview.ppm or nothing for "none". Return 0
+ * if successful, 1 otherwise. */
+static int write_image(const struct maze *m, const char *format)
+{
+    if (strcmp(format, "ppm") == 0) {
+        return maze_render_ppm(m, "out.ppm", 0);
+    } else if (strcmp(format, "pgm") == 0) {
+        return maze_render_pgm(m, "out.pgm", 0);
+    } else if (strcmp(format, "overview") == 0) {
+        return maze_render_overview(m, "out_overview.ppm", 0);
+    }
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-q] [-s] [-b|-B] [-i image] "
+            "[-f field|-c cache]\n"
+            "    -q        do not trace the search on stderr\n"
+            "    -s        report timings, memory and container statistics "
+            "on stderr\n"
+            "    -b        solve every maze on stdin, separated by blank "
+            "lines, without\n"
+            "              images; -s then reports the totals\n"
+            "    -B        like -b, but read the next maze and write the "
+            "last one on\n"
+            "              their own threads while solving\n"
+            "    -i image  ppm (default), pgm, overview or none\n"
+            "    -f field  look the path up in the distance field to the "
+            "destination\n"
+            "              kept in the file field, computing it first if "
+            "needed\n"
+            "    -c cache  like -f, but keep the parsed maze in the file "
+            "cache too, for\n"
+            "              the map file on stdin; a known map is then not "
+            "read at all\n"
+            "              unless an image is written\n", prog);
+}
+
+/**
+ * struct options -- how every maze is solved and written
+ * @image: the kind of image to write
+ * @field: the file of the distance field for -f, or NULL
+ * @cache: the cache file for -c, or NULL
+ */
+struct options {
+    const char *image;
+    const char *field;
+    const char *cache;
+};
+
+/* Solve 'm' with the options 'ctx'. */
+static int solve(void *ctx, struct maze *m)
+{
+    const struct options *o = ctx;
+    return o->field != NULL ? field_solve(m, o->field) : bfs_solve(m);
+}
+
+/* Print the outcome 'path_length' of solving 'm' and write its image as
+ * 'ctx', the options, ask. Return 0 if a path was found, 1 otherwise. */
+static int emit(void *ctx, struct maze *m, int path_length)
+{
+    const struct options *o = ctx;
 
-    /* solve maze */
-    int path_length = bfs_solve(m);
     if (path_length == ERROR) {
         printf("bfs failed\n");
-        maze_cleanup(m);
         return 1;
     } else if (path_length == NOT_FOUND) {
         printf("no path found from start to destination\n");
-        maze_cleanup(m);
         return 1;
     }
+
     printf("bfs found a path of length: %d\n", path_length);
 
     /* print maze */
-    maze_print(m, false);
-    maze_output_ppm(m, "out.ppm");
+    if (maze_render_text(m, stdout, false, 0) || write_image(m, o->image)) {
+        printf("bfs could not write the maze\n");
+    }
+    report.path_length = report.path_length < 0
+                         ? path_length
+                         : report.path_length + path_length;
+    return 0;
+}
+
+/**
+ * run -- reads, solves and prints one maze
+ * @o: the options
+ *
+ * The times and the length of the path are added to the report.
+ *
+ * Return: 0 if a path was found, 1 if not and -1 if no maze could be read.
+ */
+static int run(struct options *o)
+{
+    double start = solver_report_now();
+
+    /* read maze */
+    struct maze *m = maze_read();
+    if (!m) {
+        printf("Error reading maze\n");
+        return -1;
+    }
+    double parsed = solver_report_now();
+
+    /* solve maze */
+    int path_length = solve(o, m);
+    double solved = solver_report_now();
+    report.parse += parsed - start;
+    report.solve += solved - parsed;
+
+    int ret = emit(o, m, path_length);
+    report.render += solver_report_now() - solved;
 
     maze_cleanup(m);
-    return 0;
+    return ret;
+}
+
+/**
+ * cache_run -- reads, solves and prints one map through a cache file
+ * @o: the options, with a cache file
+ *
+ * A map that an earlier run saved in the cache is neither read nor
+ * searched: the path is looked up in the mapped distance field and printed
+ * from the mapped cells. Only an image still needs the maze itself, which
+ * is read then. Any other map is read and solved as by field_solve() and
+ * saved in the cache. A map that does not come from a file cannot be
+ * keyed and is solved without the cache.
+ *
+ * Return: as run().
+ */
+static int cache_run(struct options *o)
+{
+    double start = solver_report_now();
+    uint64_t key;
+    struct maze_cache cache;
+    bool keyed = maze_cache_key_file(stdin, &key) == 0;
+    bool hit = keyed && maze_cache_load(&cache, o->cache, key) == 0;
+
+    if (!keyed) {
+        ulog("stdin is not a file, %s is not used.\n", o->cache);
+    } else if (hit) {
+        ulog("maze and distance field mapped from %s.\n", o->cache);
+    }
+
+    if (hit && strcmp(o->image, "none") == 0) {
+        char *cells = malloc((size_t) cache.n * (size_t) cache.n);
+        if (cells == NULL) {
+            maze_cache_cleanup(&cache);
+            printf("bfs failed\n");
+            return 1;
+        }
+        double parsed = solver_report_now();
+        int path_length = maze_cache_descend(&cache, cells);
+        record_field(&cache.field);
+        double solved = solver_report_now();
+        report.parse += parsed - start;
+        report.solve += solved - parsed;
+
+        int ret = 1;
+        if (path_length == MAZE_DISTANCE_UNREACHABLE) {
+            printf("no path found from start to destination\n");
+        } else {
+            printf("bfs found a path of length: %d\n", path_length);
+            if (maze_cache_render_text(&cache, cells, stdout)) {
+                printf("bfs could not write the maze\n");
+            }
+            report.path_length = path_length;
+            ret = 0;
+        }
+        report.render += solver_report_now() - solved;
+
+        free(cells);
+        maze_cache_cleanup(&cache);
+        return ret;
+    }
+
+    /* read maze */
+    struct maze *m = maze_read();
+    if (!m) {
+        if (hit) {
+            maze_cache_cleanup(&cache);
+        }
+        printf("Error reading maze\n");
+        return -1;
+    }
+    double parsed = solver_report_now();
+
+    /* solve maze */
+    int path_length;
+    if (hit) {
+        path_length = field_descend(&cache.field, m);
+        maze_cache_cleanup(&cache);
+    } else {
+        struct maze_distance field;
+        path_length = ERROR;
+        if (field_compute(&field, m) == 0) {
+            if (keyed && maze_cache_save(m, &field, o->cache, key)) {
+                ulog("could not save the cache to %s.\n", o->cache);
+            }
+            path_length = field_descend(&field, m);
+            maze_distance_cleanup(&field);
+        }
+    }
+    double solved = solver_report_now();
+    report.parse += parsed - start;
+    report.solve += solved - parsed;
+
+    int ret = emit(o, m, path_length);
+    report.render += solver_report_now() - solved;
+
+    maze_cleanup(m);
+    return ret;
+}
+
+int main(int argc, char *argv[]) {
+    bool print_report = false;
+    bool batch = false;
+    bool pipelined = false;
+    struct options o = { "ppm", NULL, NULL };
+    int opt;
+
+    while ((opt = getopt(argc, argv, "qsbBi:f:c:")) != -1) {
+        switch (opt) {
+        case 'q':
+            quiet = true;
+            break;
+        case 's':
+            print_report = true;
+            break;
+        case 'b':
+            batch = true;
+            break;
+        case 'B':
+            batch = true;
+            pipelined = true;
+            break;
+        case 'i':
+            o.image = optarg;
+            if (strcmp(o.image, "ppm") != 0 && strcmp(o.image, "pgm") != 0
+                && strcmp(o.image, "overview") != 0
+                && strcmp(o.image, "none") != 0) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'f':
+            o.field = optarg;
+            break;
+        case 'c':
+            o.cache = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (o.cache != NULL && (batch || o.field != NULL)) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (batch) {
+        /* Every maze would overwrite the image of the one before. */
+        o.image = "none";
+    }
+
+    solver_report_init(&report, o.cache != NULL ? "bfs_cache"
+                                : o.field != NULL ? "bfs_field" : "bfs");
+
+    /* In a batch the workspace and its queues are used again for every
+     * maze, so after the largest one no more memory is allocated. */
+    int ret = 0;
+    if (o.cache != NULL) {
+        ret = cache_run(&o) != 0;
+    } else if (pipelined) {
+        struct solver_pipeline p = { solve, emit, &o, PIPELINE_DEPTH,
+                                     0, 0, 0, 0 };
+        ret = solver_pipeline_run(&p);
+        report.parse = p.parse;
+        report.solve = p.solve_time;
+        report.render = p.emit_time;
+    } else {
+        do {
+            int status = run(&o);
+            if (status != 0) {
+                ret = 1;
+            }
+            if (status < 0) {
+                break;
+            }
+        } while (batch && solver_batch_next(stdin));
+    }
+
+    if (print_report) {
+        record_stats(&workspace);
+        solver_report_print(stderr, &report);
+    }
+
+    workspace_cleanup(&workspace);
+    return ret;
 }
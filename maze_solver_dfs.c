@@ -5,46 +5,68 @@
  * Universiteit van Amsterdam
  */
 
+// Needed for getopt()
+#define _POSIX_C_SOURCE 200809L
+
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "maze.h"
+#include "maze_neighbors.h"
+#include "maze_pred.h"
+#include "maze_render.h"
+#include "solver_pipeline.h"
+#include "solver_report.h"
+#include "solver_workspace.h"
 #include "stack.h"
+#include "stack_ext.h"
+#include "wsdeque.h"
 
 #define NOT_FOUND -1
 #define ERROR -2
 #define STACK_SIZE 4000
+#define DEQUE_SIZE 1024
+#define MAX_THREADS 256
 
-static int ***new_graph(int maze_size)
-{
-    int ***graph = malloc(maze_size * sizeof(int **));
+/* Number of mazes in the pipeline of -B: one being read, one being solved,
+ * one being written and one waiting. */
+#define PIPELINE_DEPTH 4
 
-    for (int i = 0; i < maze_size; i++) {
-        graph[i] = malloc(maze_size * sizeof(int *));
+/* Set by -q, keeps ulog() from tracing every cell. */
+static bool quiet;
 
-        for (int j = 0; j < maze_size; j++) {
-            graph[i][j] = malloc(sizeof(int) * 2);
-        }
-    }
+/* Filled in while solving, printed by -s. */
+static struct solver_report report;
 
-    return graph;
-}
+/**
+ * struct dfs_workspace -- what dfs_solve_helper() keeps between mazes
+ * @grid: the flat copy of the maze and the predecessors of its cells
+ * @rstack: the rows of the cells to expand
+ * @cstack: the columns of the cells to expand
+ *
+ * The stacks are made by the first search and emptied by every later one,
+ * so they keep the capacity they grew to.
+ */
+static struct dfs_workspace {
+    struct solver_workspace grid;
+    struct stack *rstack;
+    struct stack *cstack;
+} workspace;
 
-static void free_graph(int ***graph, int maze_size)
+static void ulog(const char *fmt, ...)
 {
-    for (int i = 0; i < maze_size; i++) {
-        for (int j = 0; j < maze_size; j++) {
-            free(graph[i][j]);
-        }
-        free(graph[i]);
+    if (quiet) {
+        return;
     }
-    free(graph);
-}
 
-static void ulog(const char *fmt, ...)
-{
     va_list va;
     va_start(va, fmt);
     fprintf(stderr, "dfs_solve_helper: ");
@@ -52,6 +74,56 @@ static void ulog(const char *fmt, ...)
     va_end(va);
 }
 
+/* Keep the statistics of both stacks and the memory of the workspace for
+ * the report. */
+static void record_stats(const struct dfs_workspace *w)
+{
+    struct container_stats stats;
+
+    report.extra_bytes += solver_workspace_bytes(&w->grid);
+    if (stack_get_stats(w->rstack, &stats) == 0) {
+        solver_report_add(&report, "rstack", &stats);
+        report.extra_bytes += stats.peak_bytes;
+    }
+    if (stack_get_stats(w->cstack, &stats) == 0) {
+        solver_report_add(&report, "cstack", &stats);
+        report.extra_bytes += stats.peak_bytes;
+    }
+}
+
+/* Get 'w' ready for a search in 'm'. Return 0 if successful, 1 otherwise. */
+static int workspace_reset(struct dfs_workspace *w, const struct maze *m)
+{
+    if (w->rstack == NULL) {
+        w->rstack = stack_init(STACK_SIZE);
+    }
+    if (w->cstack == NULL) {
+        w->cstack = stack_init(STACK_SIZE);
+    }
+    if (w->rstack == NULL || w->cstack == NULL) {
+        return 1;
+    }
+
+    /* A search that found the destination leaves its frontier behind. */
+    while (!stack_empty(w->rstack)) {
+        stack_pop(w->rstack);
+    }
+    while (!stack_empty(w->cstack)) {
+        stack_pop(w->cstack);
+    }
+
+    return solver_workspace_load(&w->grid, m);
+}
+
+static void workspace_cleanup(struct dfs_workspace *w)
+{
+    stack_cleanup(w->rstack);
+    stack_cleanup(w->cstack);
+    solver_workspace_cleanup(&w->grid);
+    w->rstack = NULL;
+    w->cstack = NULL;
+}
+
 /**
  * dfs_solve_helper -- solves a maze using Depth-First Search
  * @m: the maze to solve
@@ -60,6 +132,9 @@ static void ulog(const char *fmt, ...)
  * @dr: destination row
  * @dc: destination column
  *
+ * The stacks, the flat copy of the maze and the predecessors come from the
+ * workspace, which keeps them for the next maze.
+ *
  * Return: the length of the path, if found; otherwise, NOT_FOUND if
  *         or ERROR if an error occured.
  */
@@ -68,86 +143,63 @@ int dfs_solve_helper(struct maze *m, int sr, int sc, int dr, int dc)
     ulog("start           = (%d, %d).\n", sr, sc);
     ulog("destination     = (%d, %d).\n", dr, dc);
 
-    struct stack *rstack = stack_init(STACK_SIZE);
-    if (rstack == NULL) {
-        return ERROR;
-    }
-
-    struct stack *cstack = stack_init(STACK_SIZE);
-    if (cstack == NULL) {
-        stack_cleanup(rstack);
-        return ERROR;
-    }
-
-    int ***graph = new_graph(maze_size(m));
-    if (graph == NULL) {
-        stack_cleanup(rstack);
-        stack_cleanup(cstack);
+    if (workspace_reset(&workspace, m)) {
         return ERROR;
     }
+    struct stack *rstack = workspace.rstack;
+    struct stack *cstack = workspace.cstack;
+    struct maze_flat *flat = &workspace.grid.flat;
+    struct maze_pred *pred = &workspace.grid.pred;
 
     stack_push(rstack, sr);
     stack_push(cstack, sc);
 
     while (1) {
-        int r = stack_peek(rstack);
-        int c = stack_peek(cstack);
+        if (stack_empty(rstack)) {
+            ulog("nothing found, every reachable cell was visited.\n");
+            maze_flat_store(flat, m);
+            return NOT_FOUND;
+        }
 
-        maze_set(m, r, c, VISITED);
+        /* The way back is kept in the predecessors, so a cell leaves the
+         * stack as soon as it is expanded and every cell is expanded
+         * once. */
+        int r = stack_pop(rstack);
+        int c = stack_pop(cstack);
+        int index = maze_flat_index(flat, r, c);
 
-        if (r == dr && c == dc) {
-            int path_length = 0;
-            while (1) {
-                if (r == sr && c == sc) {
-                    free_graph(graph, maze_size(m));
-                    stack_cleanup(rstack);
-                    stack_cleanup(cstack);
-                    return path_length;
-                }
+        maze_flat_set(flat, index, VISITED);
 
-                maze_set(m, r, c, PATH);
-                int tmp = r;
-                r = graph[tmp][c][0];
-                c = graph[tmp][c][1];
-                path_length++;
-            }
+        if (r == dr && c == dc) {
+            report.expanded++;
+            int path_length = maze_pred_mark(pred, flat, index,
+                                             maze_flat_index(flat, sr, sc),
+                                             PATH);
+            maze_flat_store(flat, m);
+            return path_length;
         }
 
-        bool dead_end = true;
+        unsigned int open = maze_flat_neighbors(flat, index, FLOOR);
+        report.expanded++;
 
         for (size_t direction = 0; direction < N_MOVES; direction++) {
             int nr = r + m_offsets[direction][0];
             int nc = c + m_offsets[direction][1];
+            int next = index + flat->offsets[direction];
 
-            if (maze_get(m, nr, nc) == FLOOR) {
-                dead_end = false;
+            if (open & (1u << direction)) {
                 stack_push(rstack, nr);
                 stack_push(cstack, nc);
-                maze_set(m, nr, nc, VISITED);
-                graph[nr][nc][0] = r;
-                graph[nr][nc][1] = c;
-                ulog("next found at     (%d, %d).\n", nr, nc);
-            } else {
+                maze_flat_set(flat, next, VISITED);
+                maze_pred_set(pred, next, (unsigned int) direction);
+                if (!quiet) {
+                    ulog("next found at     (%d, %d).\n", nr, nc);
+                }
+            } else if (!quiet) {
                 ulog("blocking found at (%d, %d) is '%c'.\n",
-                     nr, nc, maze_get(m, nr, nc));
+                     nr, nc, maze_flat_get(flat, next));
             }
         }
-
-        if (dead_end) {
-            if (stack_size(rstack) < 1 || stack_size(cstack) < 1) {
-                ulog("nothing found;\n"
-                     "    stack_size(rstack) == %zu;\n",
-                     "    stack_size(cstack) == %zu;\n",
-                     stack_size(rstack), stack_size(cstack));
-                stack_cleanup(rstack);
-                stack_cleanup(cstack);
-                free_graph(graph, maze_size(m));
-                return ERROR;
-            }
-
-            stack_pop(rstack);
-            stack_pop(cstack);
-        }
     }
 }
 
@@ -199,31 +251,700 @@ int dfs_solve(struct maze *m) {
     return dfs_solve_helper(m, sr, sc, dr, dc);
 }
 
-int main(void) {
-    /* read maze */
-    struct maze *m = maze_read();
-    if (!m) {
-        printf("Error reading maze\n");
-        return 1;
+/* Marks left in the maze by tremaux_solve(). A cell on the current branch
+ * holds the direction back to the cell it was entered from, the start holds
+ * TREMAUX_ROOT. Cells that have been backtracked out of hold VISITED. */
+static const char tremaux_marks[N_MOVES] = { '^', '>', 'v', '<' };
+#define TREMAUX_ROOT 'o'
+
+/* Return the direction stored in the Tremaux mark 'ch', or -1. */
+static int tremaux_direction(char ch)
+{
+    for (int d = 0; d < N_MOVES; d++) {
+        if (tremaux_marks[d] == ch) {
+            return d;
+        }
     }
+    return -1;
+}
+
+/**
+ * tremaux_solve -- solves a maze with Tremaux's algorithm
+ * @m: the maze to solve
+ *
+ * A depth-first search that keeps its stack in the maze itself: every cell
+ * that is entered is marked with the direction back to the cell it came
+ * from, and the search backtracks along these marks when it is stuck. Each
+ * cell is entered and left once, and no memory is used besides the maze.
+ * When the destination is found the marks from it back to the start are
+ * exactly the path.
+ *
+ * Return: the length of the path, if found; otherwise, NOT_FOUND.
+ */
+static int tremaux_solve(struct maze *m)
+{
+    int sr, sc, dr, dc;
+    maze_start(m, &sr, &sc);
+    maze_destination(m, &dr, &dc);
+    report.extra_bytes = 0;
+
+    int r = sr;
+    int c = sc;
+    maze_set(m, r, c, TREMAUX_ROOT);
+    report.expanded++;
+
+    while (r != dr || c != dc) {
+        bool moved = false;
+
+        for (int d = 0; d < N_MOVES; d++) {
+            int nr = r + m_offsets[d][0];
+            int nc = c + m_offsets[d][1];
+            if (maze_get(m, nr, nc) == FLOOR) {
+                maze_set(m, nr, nc, tremaux_marks[(d + 2) % N_MOVES]);
+                r = nr;
+                c = nc;
+                moved = true;
+                report.expanded++;
+                break;
+            }
+        }
+        if (moved) {
+            continue;
+        }
+
+        char mark = maze_get(m, r, c);
+        if (mark == TREMAUX_ROOT) {
+            ulog("nothing found, every reachable cell was visited.\n");
+            maze_set(m, r, c, VISITED);
+            return NOT_FOUND;
+        }
+
+        int d = tremaux_direction(mark);
+        maze_set(m, r, c, VISITED);
+        r += m_offsets[d][0];
+        c += m_offsets[d][1];
+    }
+
+    int path_length = 0;
+    while (maze_get(m, r, c) != TREMAUX_ROOT) {
+        int d = tremaux_direction(maze_get(m, r, c));
+        maze_set(m, r, c, PATH);
+        r += m_offsets[d][0];
+        c += m_offsets[d][1];
+        path_length++;
+    }
+    maze_set(m, r, c, VISITED);
+
+    return path_length;
+}
+
+/* Set every VISITED cell of 'm' back to FLOOR. */
+static void clear_visited(struct maze *m)
+{
+    int n = maze_size(m);
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            if (maze_get(m, r, c) == VISITED) {
+                maze_set(m, r, c, FLOOR);
+            }
+        }
+    }
+}
+
+/**
+ * dldfs_solve -- solves a maze with depth-limited depth-first search
+ * @m: the maze to solve
+ *
+ * Runs a depth-first search that does not go deeper than a limit, starting
+ * with the distance from the start to the destination and doubling the
+ * limit until a path is found or the search no longer hits the limit. The
+ * stack holds one cell and the next direction to try per level, so the
+ * memory used is bounded by the limit rather than by the size of the maze.
+ * Visited cells are marked in the maze and cleared between rounds.
+ *
+ * This is not iterative deepening: a cell stays marked for the rest of a
+ * round once any branch reached it, so a shorter branch to it is not
+ * tried, and the limit doubles instead of growing by one. The path found
+ * is therefore not always the shortest. Rounds take time linear in the
+ * cells within the limit, where marks kept per branch would make them
+ * exponential on mazes with loops.
+ *
+ * Return: the length of the path, if found; otherwise, NOT_FOUND if there
+ *         is none or ERROR if an error occured.
+ */
+static int dldfs_solve(struct maze *m)
+{
+    int sr, sc, dr, dc;
+    maze_start(m, &sr, &sc);
+    maze_destination(m, &dr, &dc);
+
+    int limit = abs(dr - sr) + abs(dc - sc);
+    if (limit < 1) {
+        limit = 1;
+    }
+
+    int *cells = NULL;
+    unsigned char *next = NULL;
+
+    while (1) {
+        int *new_cells = realloc(cells, (size_t) (limit + 1) * sizeof(int));
+        if (new_cells == NULL) {
+            break;
+        }
+        cells = new_cells;
+        unsigned char *new_next = realloc(next, (size_t) (limit + 1));
+        if (new_next == NULL) {
+            break;
+        }
+        next = new_next;
+        size_t bytes = (size_t) (limit + 1) * (sizeof(int) + 1);
+        if (bytes > report.extra_bytes) {
+            report.extra_bytes = bytes;
+        }
+        ulog("depth limit %d.\n", limit);
+
+        int top = 0;
+        bool cut = false;
+        cells[0] = maze_index(m, sr, sc);
+        next[0] = 0;
+        maze_set(m, sr, sc, VISITED);
+        report.expanded++;
+
+        while (top >= 0) {
+            int r = maze_row(m, cells[top]);
+            int c = maze_col(m, cells[top]);
+
+            if (r == dr && c == dc) {
+                for (int i = top; i > 0; i--) {
+                    maze_set(m, maze_row(m, cells[i]), maze_col(m, cells[i]),
+                             PATH);
+                }
+                free(cells);
+                free(next);
+                return top;
+            }
+
+            if (next[top] == N_MOVES) {
+                top--;
+                continue;
+            }
+
+            int d = next[top]++;
+            int nr = r + m_offsets[d][0];
+            int nc = c + m_offsets[d][1];
+            if (maze_get(m, nr, nc) != FLOOR) {
+                continue;
+            }
+            if (top == limit) {
+                cut = true;
+                continue;
+            }
+
+            maze_set(m, nr, nc, VISITED);
+            report.expanded++;
+            top++;
+            cells[top] = maze_index(m, nr, nc);
+            next[top] = 0;
+        }
+
+        if (!cut) {
+            ulog("nothing found, every reachable cell was visited.\n");
+            free(cells);
+            free(next);
+            return NOT_FOUND;
+        }
+
+        clear_visited(m);
+        if (limit > INT_MAX / 2) {
+            break;
+        }
+        limit *= 2;
+    }
+
+    free(cells);
+    free(next);
+    return ERROR;
+}
+
+/**
+ * struct dfs_shared -- state shared by all parallel DFS workers
+ * @flat: a copy of the maze being explored, only read by the workers
+ * @visited: one flag per cell, set by the worker that claims the cell
+ * @workers: all workers, so that idle workers can pick a victim
+ * @n_workers: the number of workers
+ * @start: the index of the start cell
+ * @pending: the number of claimed cells that have not been expanded yet
+ * @failed: set when a worker could not push a cell
+ */
+struct dfs_shared {
+    struct maze_flat flat;
+    atomic_uchar *visited;
+    struct dfs_worker *workers;
+    int n_workers;
+    int start;
+    atomic_long pending;
+    atomic_bool failed;
+};
+
+/**
+ * struct dfs_worker -- a thread of the parallel DFS
+ * @thread: the thread running the worker
+ * @deque: the cells this worker has claimed but not expanded yet
+ * @shared: the shared state
+ * @seed: state of the random generator used to pick victims
+ * @reachable: the number of cells expanded by this worker
+ * @dead_ends: the number of dead ends other than the start found by this
+ *             worker
+ */
+struct dfs_worker {
+    pthread_t thread;
+    struct wsdeque *deque;
+    struct dfs_shared *shared;
+    unsigned int seed;
+    long reachable;
+    long dead_ends;
+};
+
+/* Try to steal a cell from a random other worker. Return -1 if none was
+ * found. */
+static int dfs_steal(struct dfs_worker *w)
+{
+    struct dfs_shared *sh = w->shared;
+
+    for (int attempt = 0; attempt < sh->n_workers; attempt++) {
+        w->seed = w->seed * 1103515245 + 12345;
+        struct dfs_worker *victim = &sh->workers[(w->seed >> 16) %
+                                                 (unsigned int) sh->n_workers];
+        if (victim == w) {
+            continue;
+        }
+
+        int cell = wsdeque_steal(victim->deque);
+        if (cell != -1) {
+            return cell;
+        }
+    }
+
+    return -1;
+}
+
+/* Expand 'cell': claim and push all unvisited neighbours. */
+static void dfs_expand(struct dfs_worker *w, int cell)
+{
+    struct dfs_shared *sh = w->shared;
+    unsigned int walls = maze_flat_neighbors(&sh->flat, cell, WALL);
+    int open = 0;
+    long claimed = 0;
+
+    for (size_t direction = 0; direction < N_MOVES; direction++) {
+        if (walls & (1u << direction)) {
+            continue;
+        }
+        open++;
+
+        int next = cell + sh->flat.offsets[direction];
+        if (atomic_exchange_explicit(&sh->visited[next], 1,
+                                     memory_order_relaxed)) {
+            continue;
+        }
+
+        if (wsdeque_push(w->deque, next)) {
+            atomic_store(&sh->failed, true);
+            continue;
+        }
+        claimed++;
+    }
+
+    w->reachable++;
+    if (open == 1 && cell != sh->start) {
+        w->dead_ends++;
+    }
+
+    /* Corridors replace the expanded cell with exactly one new cell, so
+     * the shared counter is only touched at junctions and dead ends. */
+    if (claimed != 1) {
+        atomic_fetch_add_explicit(&sh->pending, claimed - 1,
+                                  memory_order_acq_rel);
+    }
+}
+
+static void *dfs_worker_run(void *arg)
+{
+    struct dfs_worker *w = arg;
+    struct dfs_shared *sh = w->shared;
+
+    while (atomic_load_explicit(&sh->pending, memory_order_acquire) > 0) {
+        int cell = wsdeque_pop(w->deque);
+        if (cell == -1) {
+            cell = dfs_steal(w);
+        }
+        if (cell == -1) {
+            sched_yield();
+            continue;
+        }
+
+        dfs_expand(w, cell);
+    }
+
+    return NULL;
+}
+
+/* Add the statistics 's' of one deque to 'sum'. The maxima are added as
+ * well, as an upper bound of the items held by all deques at once. */
+static void add_stats(struct container_stats *sum,
+                      const struct container_stats *s)
+{
+    sum->push += s->push;
+    sum->pop += s->pop;
+    sum->max += s->max;
+    sum->resizes += s->resizes;
+    sum->bytes_copied += s->bytes_copied;
+    sum->capacity += s->capacity;
+    sum->peak_capacity += s->peak_capacity;
+    sum->bytes += s->bytes;
+    sum->peak_bytes += s->peak_bytes;
+    sum->failed += s->failed;
+    sum->empty_pops += s->empty_pops;
+}
+
+/**
+ * dfs_reachability -- explores the maze with several threads
+ * @m: the maze to explore
+ * @n_threads: the number of worker threads
+ *
+ * Every worker runs a depth-first search from its own work-stealing deque.
+ * A worker whose deque runs empty steals the oldest unexplored branch of
+ * another worker, so all threads stay busy until every cell reachable from
+ * the start has been expanded. Cells are claimed in a shared visited array
+ * rather than in the maze, so the maze itself is only read.
+ *
+ * Return: 1 if the destination is reachable from the start, 0 if it is not
+ *         or ERROR if an error occured.
+ */
+static int dfs_reachability(const struct maze *m, int n_threads)
+{
+    int n = maze_size(m);
+    struct dfs_worker workers[MAX_THREADS];
+    struct dfs_shared sh;
+    int sr, sc, dr, dc;
+    int ret = ERROR;
+
+    if (maze_flat_load(&sh.flat, m)) {
+        return ERROR;
+    }
+    sh.workers = workers;
+    sh.n_workers = 0;
+    atomic_init(&sh.pending, 1);
+    atomic_init(&sh.failed, false);
+    sh.visited = calloc((size_t) n * (size_t) n, sizeof(atomic_uchar));
+    if (sh.visited == NULL) {
+        maze_flat_cleanup(&sh.flat);
+        return ERROR;
+    }
+    report.extra_bytes = (size_t) n * (size_t) n * sizeof(atomic_uchar)
+                         + maze_flat_bytes(n);
+
+    for (int i = 0; i < n_threads; i++) {
+        workers[i].deque = wsdeque_init(DEQUE_SIZE);
+        if (workers[i].deque == NULL) {
+            goto out;
+        }
+        workers[i].shared = &sh;
+        workers[i].seed = (unsigned int) i * 2654435761u + 1;
+        workers[i].reachable = 0;
+        workers[i].dead_ends = 0;
+        sh.n_workers++;
+    }
+
+    maze_start(m, &sr, &sc);
+    maze_destination(m, &dr, &dc);
+    sh.start = maze_index(m, sr, sc);
+    atomic_store(&sh.visited[sh.start], 1);
+    if (wsdeque_push(workers[0].deque, sh.start)) {
+        goto out;
+    }
+
+    int started = 0;
+    for (; started < n_threads; started++) {
+        if (pthread_create(&workers[started].thread, NULL, dfs_worker_run,
+                           &workers[started])) {
+            break;
+        }
+    }
+    if (started == 0) {
+        goto out;
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    if (atomic_load(&sh.failed) || atomic_load(&sh.pending) != 0) {
+        goto out;
+    }
+
+    /* The deques of all workers are one entry of the report. */
+    struct container_stats deques;
+    memset(&deques, 0, sizeof(deques));
+    long reachable = 0;
+    long dead_ends = 0;
+    for (int i = 0; i < n_threads; i++) {
+        struct container_stats stats;
+        reachable += workers[i].reachable;
+        dead_ends += workers[i].dead_ends;
+        if (wsdeque_get_stats(workers[i].deque, &stats) == 0) {
+            add_stats(&deques, &stats);
+        }
+    }
+    report.expanded = reachable;
+    report.extra_bytes += deques.peak_bytes;
+    solver_report_add(&report, "wsdeque", &deques);
+
+    ret = atomic_load(&sh.visited[maze_index(m, dr, dc)]) ? 1 : 0;
+    printf("dfs reachability with %d threads: %ld cells reachable, "
+           "%ld dead ends, destination %s\n", started, reachable, dead_ends,
+           ret ? "reachable" : "unreachable");
+
+out:
+    for (int i = 0; i < sh.n_workers; i++) {
+        wsdeque_cleanup(workers[i].deque);
+    }
+    free(sh.visited);
+    maze_flat_cleanup(&sh.flat);
+    return ret;
+}
+
+/* Write the image 'format' of the solved maze: "ppm" to out.ppm, "pgm" to
+ * out.pgm, "overview" to out_overview.ppm or nothing for "none". Return 0
+ * if successful, 1 otherwise. */
+static int write_image(const struct maze *m, const char *format)
+{
+    if (strcmp(format, "ppm") == 0) {
+        return maze_render_ppm(m, "out.ppm", 0);
+    } else if (strcmp(format, "pgm") == 0) {
+        return maze_render_pgm(m, "out.pgm", 0);
+    } else if (strcmp(format, "overview") == 0) {
+        return maze_render_overview(m, "out_overview.ppm", 0);
+    }
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-q] [-s] [-b|-B] [-m mode] [-i image] "
+            "[-p threads]\n"
+            "    -q          do not trace the search on stderr\n"
+            "    -s          report timings, memory and container "
+            "statistics on stderr\n"
+            "    -b          solve every maze on stdin, separated by blank "
+            "lines, without\n"
+            "                images; -s then reports the totals\n"
+            "    -B          like -b, but read the next maze and write the "
+            "last one on\n"
+            "                their own threads while solving\n"
+            "    -m mode     dfs (default), dldfs (depth-limited, memory "
+            "bounded by the\n"
+            "                depth) or tremaux (no memory besides the maze)\n"
+            "    -i image    ppm (default), pgm, overview or none\n"
+            "    -p threads  explore everything reachable from the start "
+            "in parallel\n", prog);
+}
+
+/**
+ * struct options -- how every maze is solved and written
+ * @mode: the search to use
+ * @image: the kind of image to write
+ */
+struct options {
+    const char *mode;
+    const char *image;
+};
+
+/* Solve 'm' with the search the options 'ctx' ask for. */
+static int solve(void *ctx, struct maze *m)
+{
+    const struct options *o = ctx;
+
+    if (strcmp(o->mode, "dldfs") == 0) {
+        return dldfs_solve(m);
+    } else if (strcmp(o->mode, "tremaux") == 0) {
+        return tremaux_solve(m);
+    }
+    return dfs_solve(m);
+}
+
+/* Print the outcome 'path_length' of solving 'm' and write its image as
+ * 'ctx', the options, ask. Return 0 if a path was found, 1 otherwise. */
+static int emit(void *ctx, struct maze *m, int path_length)
+{
+    const struct options *o = ctx;
 
-    /* solve maze */
-    int path_length = dfs_solve(m);
     if (path_length == ERROR) {
         printf("dfs failed\n");
-        maze_cleanup(m);
         return 1;
     } else if (path_length == NOT_FOUND) {
         printf("no path found from start to destination\n");
-        maze_cleanup(m);
         return 1;
     }
+
     printf("dfs found a path of length: %d\n", path_length);
 
     /* print maze */
-    maze_print(m, false);
-    maze_output_ppm(m, "out.ppm");
+    if (maze_render_text(m, stdout, false, 0) || write_image(m, o->image)) {
+        printf("dfs could not write the maze\n");
+    }
+    report.path_length = report.path_length < 0
+                         ? path_length
+                         : report.path_length + path_length;
+    return 0;
+}
+
+/**
+ * run -- reads, solves and prints one maze
+ * @o: the options
+ *
+ * The times and the length of the path are added to the report.
+ *
+ * Return: 0 if a path was found, 1 if not and -1 if no maze could be read.
+ */
+static int run(struct options *o)
+{
+    double start = solver_report_now();
+
+    /* read maze */
+    struct maze *m = maze_read();
+    if (!m) {
+        printf("Error reading maze\n");
+        return -1;
+    }
+    double parsed = solver_report_now();
+    report.parse += parsed - start;
+
+    /* solve maze */
+    int path_length = solve(o, m);
+    double solved = solver_report_now();
+    report.solve += solved - parsed;
+
+    int ret = emit(o, m, path_length);
+    report.render += solver_report_now() - solved;
 
     maze_cleanup(m);
-    return 0;
+    return ret;
+}
+
+int main(int argc, char *argv[]) {
+    bool print_report = false;
+    bool batch = false;
+    bool pipelined = false;
+    struct options o = { "dfs", "ppm" };
+    int threads = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "qsbBm:i:p:")) != -1) {
+        switch (opt) {
+        case 'q':
+            quiet = true;
+            break;
+        case 's':
+            print_report = true;
+            break;
+        case 'b':
+            batch = true;
+            break;
+        case 'B':
+            batch = true;
+            pipelined = true;
+            break;
+        case 'm':
+            o.mode = optarg;
+            if (strcmp(o.mode, "dfs") != 0 && strcmp(o.mode, "dldfs") != 0
+                && strcmp(o.mode, "tremaux") != 0) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'i':
+            o.image = optarg;
+            if (strcmp(o.image, "ppm") != 0 && strcmp(o.image, "pgm") != 0
+                && strcmp(o.image, "overview") != 0
+                && strcmp(o.image, "none") != 0) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'p':
+            threads = atoi(optarg);
+            if (threads < 1 || threads > MAX_THREADS) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (batch && threads > 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (batch) {
+        /* Every maze would overwrite the image of the one before. */
+        o.image = "none";
+    }
+
+    solver_report_init(&report, threads > 0 ? "dfs_parallel" : o.mode);
+
+    if (threads > 0) {
+        double start = solver_report_now();
+
+        /* read maze */
+        struct maze *m = maze_read();
+        if (!m) {
+            printf("Error reading maze\n");
+            return 1;
+        }
+        double parsed = solver_report_now();
+        report.parse = parsed - start;
+
+        int reachable = dfs_reachability(m, threads);
+        report.solve = solver_report_now() - parsed;
+        maze_cleanup(m);
+        if (reachable == ERROR) {
+            printf("dfs failed\n");
+        }
+        if (print_report) {
+            solver_report_print(stderr, &report);
+        }
+        return reachable == 1 ? 0 : 1;
+    }
+
+    /* In a batch the workspace and its stacks are used again for every
+     * maze, so after the largest one no more memory is allocated. */
+    int ret = 0;
+    if (pipelined) {
+        struct solver_pipeline p = { solve, emit, &o, PIPELINE_DEPTH,
+                                     0, 0, 0, 0 };
+        ret = solver_pipeline_run(&p);
+        report.parse = p.parse;
+        report.solve = p.solve_time;
+        report.render = p.emit_time;
+    } else {
+        do {
+            int status = run(&o);
+            if (status != 0) {
+                ret = 1;
+            }
+            if (status < 0) {
+                break;
+            }
+        } while (batch && solver_batch_next(stdin));
+    }
+
+    if (print_report) {
+        record_stats(&workspace);
+        solver_report_print(stderr, &report);
+    }
+
+    workspace_cleanup(&workspace);
+    return ret;
 }
@@ -0,0 +1,445 @@
+/*
+ * maze_solver_dijkstra.c -- a cheapest path solver for weighted mazes
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+// Needed for getopt()
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "deque.h"
+#include "queue.h"
+#include "queue_ext.h"
+#include "solver_report.h"
+#include "terrain.h"
+
+#define NOT_FOUND -1
+#define ERROR -2
+#define QUEUE_SIZE 4000
+
+/* Distance of a cell that has not been reached yet. */
+#define UNREACHED UINT32_MAX
+
+/* Set in the direction of a cell once the 0-1 search has expanded it. */
+#define SETTLED 0x80
+
+/* Set by -q, keeps ulog() from tracing the search. */
+static bool quiet;
+
+/* Set by -m, the name of the search. */
+static const char *mode = "dijkstra";
+
+/* Filled in while solving, printed by -s. */
+static struct solver_report report;
+
+static void ulog(const char *fmt, ...)
+{
+    if (quiet) {
+        return;
+    }
+
+    va_list va;
+    va_start(va, fmt);
+    fprintf(stderr, "%s_solve: ", mode);
+    vfprintf(stderr, fmt, va);
+    va_end(va);
+}
+
+/**
+ * struct buckets -- Dial's bucket queue
+ * @n: the number of buckets, one more than the highest cost of a move
+ * @queues: the cells at each distance modulo @n
+ * @size: the number of cells in all buckets
+ *
+ * A cell at distance d is in bucket d % @n. As a move costs from 0 to
+ * @n - 1, all cells in the buckets are less than @n apart, so every bucket
+ * holds cells of a single distance and the buckets are emptied in the
+ * order of their distances by going round them. A move that costs nothing
+ * puts its cell back in the bucket that is being emptied, which the loop
+ * in dijkstra_solve() keeps draining until it is empty.
+ */
+struct buckets {
+    int n;
+    struct queue *queues[TERRAIN_MAX_COST + 1];
+    size_t size;
+};
+
+static void buckets_cleanup(struct buckets *b)
+{
+    for (int i = 0; i < b->n; i++) {
+        queue_cleanup(b->queues[i]);
+    }
+}
+
+/* Set up 'n' empty buckets in 'b'. Return 0 if successful, 1 otherwise. */
+static int buckets_init(struct buckets *b, int n)
+{
+    b->n = 0;
+    b->size = 0;
+    for (; b->n < n; b->n++) {
+        b->queues[b->n] = queue_init(QUEUE_SIZE);
+        if (b->queues[b->n] == NULL) {
+            buckets_cleanup(b);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Add the statistics of all buckets together for the report. */
+static void record_bucket_stats(const struct buckets *b)
+{
+    struct container_stats total;
+    struct container_stats stats;
+
+    memset(&total, 0, sizeof(total));
+    for (int i = 0; i < b->n; i++) {
+        if (queue_get_stats(b->queues[i], &stats)) {
+            return;
+        }
+        total.push += stats.push;
+        total.pop += stats.pop;
+        total.max += stats.max;
+        total.resizes += stats.resizes;
+        total.bytes_copied += stats.bytes_copied;
+        total.capacity += stats.capacity;
+        total.peak_capacity += stats.peak_capacity;
+        total.bytes += stats.bytes;
+        total.peak_bytes += stats.peak_bytes;
+        total.failed += stats.failed;
+        total.empty_pops += stats.empty_pops;
+    }
+    solver_report_add(&report, "buckets", &total);
+    report.extra_bytes += total.peak_bytes;
+}
+
+/**
+ * struct search -- the state of a search from the start
+ * @dist: the cost of the cheapest way found so far to each cell
+ * @from: the direction, as in m_offsets, in which each cell was entered on
+ *        that way
+ *
+ * Going back against @from leads to the start. The cost alone cannot tell
+ * the way back, as with moves that cost nothing two neighbours can be
+ * equally far from the start.
+ */
+struct search {
+    uint32_t *dist;
+    unsigned char *from;
+};
+
+static void search_cleanup(struct search *s)
+{
+    free(s->dist);
+    free(s->from);
+}
+
+/* Set up 's' for a search from the start of 't'. Return 0 if successful,
+ * 1 otherwise. */
+static int search_init(struct search *s, const struct terrain *t)
+{
+    size_t cells = (size_t) t->n * (size_t) t->n;
+
+    s->dist = malloc(cells * sizeof(uint32_t));
+    s->from = calloc(cells, 1);
+    if (s->dist == NULL || s->from == NULL) {
+        search_cleanup(s);
+        return 1;
+    }
+    report.extra_bytes = cells * (sizeof(uint32_t) + 1);
+
+    for (size_t i = 0; i < cells; i++) {
+        s->dist[i] = UNREACHED;
+    }
+    s->dist[t->start] = 0;
+    return 0;
+}
+
+/* Mark the path to 'cell' in 't' as PATH, leaving out the start, and
+ * return its number of moves. */
+static int mark_path(struct terrain *t, const struct search *s, int cell)
+{
+    const int offsets[N_MOVES] = { -t->n, 1, t->n, -1 };
+    int length = 0;
+
+    while (cell != t->start) {
+        t->cells[cell] = PATH;
+        length++;
+        cell -= offsets[s->from[cell] & ~SETTLED];
+    }
+    return length;
+}
+
+/**
+ * dijkstra_solve -- finds the cheapest path through a weighted maze
+ * @t: the maze to solve
+ * @length: set to the number of moves of the path
+ *
+ * Dijkstra's algorithm with Dial's bucket queue: as the costs are small
+ * integers, the cells to expand are kept in one queue per distance modulo
+ * the number of buckets, which makes every push and pop O(1). A cell may be
+ * queued again when a cheaper way to it is found; the old entry is skipped
+ * when its distance no longer matches. A move that costs nothing queues the
+ * cell in the bucket that is being emptied, behind the cells still in it.
+ *
+ * Return: the cost of the path, if found; otherwise, NOT_FOUND if there is
+ *         none or ERROR if an error occured.
+ */
+static long dijkstra_solve(struct terrain *t, int *length)
+{
+    const int offsets[N_MOVES] = { -t->n, 1, t->n, -1 };
+    struct search s;
+
+    if (search_init(&s, t)) {
+        return ERROR;
+    }
+
+    struct buckets b;
+    if (buckets_init(&b, t->max_cost + 1)) {
+        search_cleanup(&s);
+        return ERROR;
+    }
+
+    long ret = NOT_FOUND;
+    if (queue_push(b.queues[0], t->start)) {
+        ret = ERROR;
+        goto out;
+    }
+    b.size = 1;
+
+    for (uint32_t at = 0; b.size > 0; at++) {
+        struct queue *q = b.queues[at % (uint32_t) b.n];
+
+        while (!queue_empty(q)) {
+            int cell = queue_pop(q);
+            b.size--;
+            if (s.dist[cell] != at) {
+                continue;
+            }
+            report.expanded++;
+
+            if (cell == t->destination) {
+                *length = mark_path(t, &s, cell);
+                ret = at;
+                goto out;
+            }
+
+            for (int d = 0; d < N_MOVES; d++) {
+                int next = cell + offsets[d];
+                int cost = t->cost[next];
+                uint32_t through = at + (uint32_t) cost;
+                if (cost == TERRAIN_WALL || through >= s.dist[next]) {
+                    continue;
+                }
+
+                s.dist[next] = through;
+                s.from[next] = (unsigned char) d;
+                if (queue_push(b.queues[through % (uint32_t) b.n], next)) {
+                    ulog("queue_push failed at %d.\n", next);
+                    ret = ERROR;
+                    goto out;
+                }
+                b.size++;
+            }
+        }
+    }
+    ulog("nothing found, every reachable cell was visited.\n");
+
+out:
+    record_bucket_stats(&b);
+    buckets_cleanup(&b);
+    search_cleanup(&s);
+    return ret;
+}
+
+/* Add the statistics of 'd' to the report. */
+static void record_deque_stats(const struct deque *d)
+{
+    struct container_stats stats;
+
+    if (deque_get_stats(d, &stats) == 0) {
+        solver_report_add(&report, "deque", &stats);
+        report.extra_bytes += stats.peak_bytes;
+    }
+}
+
+/**
+ * zero_one_solve -- finds the cheapest path through a maze of costs 0 and 1
+ * @t: the maze to solve, with a @max_cost of at most 1
+ * @length: set to the number of moves of the path
+ *
+ * 0-1 breadth-first search: a cell reached by a move that costs nothing
+ * goes to the front of a deque and one reached by a move that costs 1 to
+ * the back. The deque then always holds cells of at most two distances,
+ * the lower ones in front, so cells leave it in the order of their
+ * distances without a priority queue, in O(n) time. A cell that was
+ * queued again is only expanded the first time it is popped, which is when
+ * its distance was lowest.
+ *
+ * Return: the cost of the path, if found; otherwise, NOT_FOUND if there is
+ *         none or ERROR if an error occured.
+ */
+static long zero_one_solve(struct terrain *t, int *length)
+{
+    const int offsets[N_MOVES] = { -t->n, 1, t->n, -1 };
+    struct search s;
+
+    if (search_init(&s, t)) {
+        return ERROR;
+    }
+
+    struct deque *d = deque_init(QUEUE_SIZE);
+    if (d == NULL) {
+        search_cleanup(&s);
+        return ERROR;
+    }
+
+    long ret = NOT_FOUND;
+    if (deque_push_back(d, t->start)) {
+        ret = ERROR;
+        goto out;
+    }
+
+    while (!deque_empty(d)) {
+        int cell = deque_pop_front(d);
+        if (s.from[cell] & SETTLED) {
+            continue;
+        }
+        s.from[cell] |= SETTLED;
+        report.expanded++;
+
+        if (cell == t->destination) {
+            *length = mark_path(t, &s, cell);
+            ret = s.dist[cell];
+            goto out;
+        }
+
+        for (int dir = 0; dir < N_MOVES; dir++) {
+            int next = cell + offsets[dir];
+            int cost = t->cost[next];
+            uint32_t through = s.dist[cell] + (uint32_t) cost;
+            if (cost == TERRAIN_WALL || through >= s.dist[next]) {
+                continue;
+            }
+
+            s.dist[next] = through;
+            s.from[next] = (unsigned char) dir;
+            if (cost == 0 ? deque_push_front(d, next)
+                          : deque_push_back(d, next)) {
+                ulog("deque push failed at %d.\n", next);
+                ret = ERROR;
+                goto out;
+            }
+        }
+    }
+    ulog("nothing found, every reachable cell was visited.\n");
+
+out:
+    record_deque_stats(d);
+    deque_cleanup(d);
+    search_cleanup(&s);
+    return ret;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-q] [-s] [-m mode]\n"
+            "    -q       do not trace the search on stderr\n"
+            "    -s       report timings, memory and container statistics "
+            "on stderr\n"
+            "    -m mode  dijkstra (default) or 01bfs, which needs every "
+            "cost to be 0 or 1\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    bool print_report = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "qsm:")) != -1) {
+        switch (opt) {
+        case 'q':
+            quiet = true;
+            break;
+        case 's':
+            print_report = true;
+            break;
+        case 'm':
+            mode = optarg;
+            if (strcmp(mode, "dijkstra") != 0 && strcmp(mode, "01bfs") != 0) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    solver_report_init(&report, mode);
+    double start = solver_report_now();
+
+    /* read maze */
+    struct terrain *t = terrain_read(stdin);
+    if (!t) {
+        printf("Error reading maze\n");
+        return 1;
+    }
+    double parsed = solver_report_now();
+
+    bool zero_one = strcmp(mode, "01bfs") == 0;
+    if (zero_one && t->max_cost > 1) {
+        printf("01bfs needs costs of 0 and 1, the maze has costs up to %d\n",
+               t->max_cost);
+        terrain_cleanup(t);
+        return 1;
+    }
+
+    /* solve maze */
+    int length = 0;
+    long cost = NOT_FOUND;
+    if (t->cost[t->start] == TERRAIN_WALL) {
+        ulog("the start is on a wall or on the border.\n");
+    } else if (zero_one) {
+        cost = zero_one_solve(t, &length);
+    } else {
+        cost = dijkstra_solve(t, &length);
+    }
+    double solved = solver_report_now();
+    report.parse = parsed - start;
+    report.solve = solved - parsed;
+
+    int ret = 1;
+    if (cost == ERROR) {
+        printf("%s failed\n", mode);
+    } else if (cost == NOT_FOUND) {
+        printf("no path found from start to destination\n");
+    } else {
+        printf("%s found a path of cost: %ld, length: %d\n", mode, cost,
+               length);
+
+        /* print maze */
+        if (terrain_print(t, stdout)) {
+            printf("%s could not write the maze\n", mode);
+        }
+        report.path_length = (int) cost;
+        report.render = solver_report_now() - solved;
+        ret = 0;
+    }
+
+    if (print_report) {
+        solver_report_print(stderr, &report);
+    }
+
+    terrain_cleanup(t);
+    return ret;
+}
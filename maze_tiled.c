@@ -0,0 +1,572 @@
+/*
+ * maze_tiled.c -- an implementation of maze.h that keeps the grid on disk
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+// Needed for getline(), pread() and pwrite()
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "maze_tiled.h"
+
+#define START 'S'
+#define FINISH 'D'
+
+#define TILE_SHIFT 6
+#define TILE_CELLS (MAZE_TILE_SIZE * MAZE_TILE_SIZE)
+
+_Static_assert(MAZE_TILE_SIZE == 1 << TILE_SHIFT,
+               "MAZE_TILE_SIZE must be 1 << TILE_SHIFT");
+
+/* Marks an unused entry of the slot arrays and the hash table. */
+#define NONE SIZE_MAX
+
+/**
+ * struct tile_cache -- the tiles of a maze that are in memory
+ * @fd: the file the tiles live in
+ * @written: a bitmap of the tiles that have been written to the file
+ * @slots: the number of tiles the cache can hold
+ * @used: the number of slots that hold a tile
+ * @cells: the cells of the cached tiles, TILE_CELLS per slot
+ * @tile: the tile held by each slot
+ * @dirty: whether each slot was changed since it was loaded
+ * @newer: the slot used right after each slot, NONE for @mru
+ * @older: the slot used right before each slot, NONE for @lru
+ * @mru: the most recently used slot
+ * @lru: the least recently used slot, the next one to be evicted
+ * @table: a hash table with linear probing from tile to slot
+ * @table_mask: the size of @table minus one
+ * @last_tile: the tile of the previous access, NONE if there was none
+ * @last_slot: the slot of @last_tile
+ * @stats: the statistics of the cache
+ *
+ * Every access first compares against @last_tile, because solvers mostly
+ * move to a neighbouring cell which is usually in the same tile. Only
+ * when that fails the tile is looked up in @table and moved to the front
+ * of the LRU list. A tile that was never written to the file is all walls,
+ * so it is filled in memory instead of being read.
+ */
+struct tile_cache {
+    int fd;
+    unsigned char *written;
+    size_t slots;
+    size_t used;
+    char *cells;
+    size_t *tile;
+    bool *dirty;
+    size_t *newer;
+    size_t *older;
+    size_t mru;
+    size_t lru;
+    size_t *table;
+    size_t table_mask;
+    size_t last_tile;
+    size_t last_slot;
+    struct maze_tile_stats stats;
+};
+
+/**
+ * struct maze -- the structure where the maze is stored
+ * @n: the number of rows and columns
+ * @start_index: the index of the start position
+ * @finish_index: the index of the destination position
+ * @tiles_per_row: the number of tiles in a row of tiles
+ * @cache: the tile cache, a pointer because it changes on every access
+ *         even when the maze itself does not
+ */
+struct maze {
+    int n;
+    int start_index;
+    int finish_index;
+    size_t tiles_per_row;
+    struct tile_cache *cache;
+};
+
+/* Move offsets: (row, column) We can only move in four directions.
+ *
+ *           (-1,0)
+ *    (0, -1)      (0, 1)
+ *           (1, 0)
+ */
+int m_offsets[N_MOVES][2] = { { -1, 0 }, { 0, 1 }, { 1, 0 }, { 0, -1 } };
+
+/* The tile cache has no way to report errors through maze_get() and
+ * maze_set(), so an I/O error ends the program. */
+static void io_failed(const char *what) {
+    perror(what);
+    abort();
+}
+
+static size_t table_hash(const struct tile_cache *tc, size_t tile) {
+    return (tile * (size_t) 0x9e3779b97f4a7c15u) & tc->table_mask;
+}
+
+static void table_insert(struct tile_cache *tc, size_t slot) {
+    size_t i = table_hash(tc, tc->tile[slot]);
+    while (tc->table[i] != NONE) {
+        i = (i + 1) & tc->table_mask;
+    }
+    tc->table[i] = slot;
+}
+
+static size_t table_find(const struct tile_cache *tc, size_t tile) {
+    size_t i = table_hash(tc, tile);
+    while (tc->table[i] != NONE && tc->tile[tc->table[i]] != tile) {
+        i = (i + 1) & tc->table_mask;
+    }
+    return i;
+}
+
+/* Remove the entry at 'i' and shift the entries after it back, so that
+ * lookups never stop at the hole. */
+static void table_remove(struct tile_cache *tc, size_t i) {
+    tc->table[i] = NONE;
+
+    for (size_t j = (i + 1) & tc->table_mask; tc->table[j] != NONE;
+         j = (j + 1) & tc->table_mask) {
+        size_t k = table_hash(tc, tc->tile[tc->table[j]]);
+
+        /* Move the entry if its home 'k' is not cyclically in (i, j]. */
+        bool stays = i <= j ? (i < k && k <= j) : (i < k || k <= j);
+        if (!stays) {
+            tc->table[i] = tc->table[j];
+            tc->table[j] = NONE;
+            i = j;
+        }
+    }
+}
+
+static void lru_unlink(struct tile_cache *tc, size_t slot) {
+    if (tc->newer[slot] != NONE) {
+        tc->older[tc->newer[slot]] = tc->older[slot];
+    } else {
+        tc->mru = tc->older[slot];
+    }
+    if (tc->older[slot] != NONE) {
+        tc->newer[tc->older[slot]] = tc->newer[slot];
+    } else {
+        tc->lru = tc->newer[slot];
+    }
+}
+
+static void lru_push(struct tile_cache *tc, size_t slot) {
+    tc->newer[slot] = NONE;
+    tc->older[slot] = tc->mru;
+    if (tc->mru != NONE) {
+        tc->newer[tc->mru] = slot;
+    } else {
+        tc->lru = slot;
+    }
+    tc->mru = slot;
+}
+
+static char *slot_cells(const struct tile_cache *tc, size_t slot) {
+    return tc->cells + slot * TILE_CELLS;
+}
+
+static off_t tile_offset(size_t tile) {
+    return (off_t) (tile * TILE_CELLS);
+}
+
+/* Drop the least recently used tile and return its slot. */
+static size_t evict(struct tile_cache *tc) {
+    size_t slot = tc->lru;
+    size_t tile = tc->tile[slot];
+
+    if (tc->dirty[slot]) {
+        if (pwrite(tc->fd, slot_cells(tc, slot), TILE_CELLS,
+                   tile_offset(tile)) != TILE_CELLS) {
+            io_failed("maze_tiled: writing a tile");
+        }
+        tc->written[tile / 8] |= (unsigned char) (1u << (tile % 8));
+        tc->stats.writebacks++;
+    }
+
+    lru_unlink(tc, slot);
+    table_remove(tc, table_find(tc, tile));
+    tc->stats.evictions++;
+    return slot;
+}
+
+/* Return the slot holding 'tile', loading it if needed. */
+static size_t tile_slot(struct tile_cache *tc, size_t tile) {
+    if (tile == tc->last_tile) {
+        tc->stats.hits++;
+        return tc->last_slot;
+    }
+
+    size_t i = table_find(tc, tile);
+    size_t slot = tc->table[i];
+
+    if (slot != NONE) {
+        tc->stats.hits++;
+        if (slot != tc->mru) {
+            lru_unlink(tc, slot);
+            lru_push(tc, slot);
+        }
+    } else {
+        tc->stats.misses++;
+        slot = tc->used < tc->slots ? tc->used++ : evict(tc);
+
+        char *cells = slot_cells(tc, slot);
+        if (tc->written[tile / 8] & (1u << (tile % 8))) {
+            if (pread(tc->fd, cells, TILE_CELLS, tile_offset(tile))
+                != TILE_CELLS) {
+                io_failed("maze_tiled: reading a tile");
+            }
+        } else {
+            memset(cells, WALL, TILE_CELLS);
+        }
+
+        tc->tile[slot] = tile;
+        tc->dirty[slot] = false;
+        table_insert(tc, slot);
+        lru_push(tc, slot);
+    }
+
+    tc->last_tile = tile;
+    tc->last_slot = slot;
+    return slot;
+}
+
+/* Return the cell at row 'r', column 'c' in the cache, loading its tile. */
+static char *cell(const struct maze *m, int r, int c) {
+    size_t tile = ((size_t) r >> TILE_SHIFT) * m->tiles_per_row
+                  + ((size_t) c >> TILE_SHIFT);
+    size_t within = (((size_t) r & (MAZE_TILE_SIZE - 1)) << TILE_SHIFT)
+                    + ((size_t) c & (MAZE_TILE_SIZE - 1));
+
+    return slot_cells(m->cache, tile_slot(m->cache, tile)) + within;
+}
+
+static void cache_free(struct tile_cache *tc) {
+    if (tc == NULL) {
+        return;
+    }
+
+    if (tc->fd != -1) {
+        close(tc->fd);
+    }
+    free(tc->written);
+    free(tc->cells);
+    free(tc->tile);
+    free(tc->dirty);
+    free(tc->newer);
+    free(tc->older);
+    free(tc->table);
+    free(tc);
+}
+
+/* Return the number of tiles to cache, from MAZE_TILE_CACHE if it is set. */
+static size_t cache_slots(void) {
+    const char *env = getenv("MAZE_TILE_CACHE");
+    if (env != NULL) {
+        long slots = atol(env);
+        if (slots > 0) {
+            return (size_t) slots;
+        }
+    }
+
+    return MAZE_TILE_CACHE_DEFAULT;
+}
+
+/* Create the tile cache and its file for a maze of 'tiles' tiles. Return
+ * the cache or NULL if an error occured. */
+static struct tile_cache *cache_init(size_t tiles) {
+    struct tile_cache *tc = calloc(1, sizeof(struct tile_cache));
+    if (tc == NULL) {
+        return NULL;
+    }
+
+    tc->fd = -1;
+    tc->slots = cache_slots();
+    if (tc->slots > tiles) {
+        tc->slots = tiles;
+    }
+
+    size_t table_size = 1;
+    while (table_size < tc->slots * 2) {
+        table_size *= 2;
+    }
+    tc->table_mask = table_size - 1;
+
+    tc->written = calloc((tiles + 7) / 8, 1);
+    tc->cells = malloc(tc->slots * TILE_CELLS);
+    tc->tile = malloc(tc->slots * sizeof(size_t));
+    tc->dirty = malloc(tc->slots * sizeof(bool));
+    tc->newer = malloc(tc->slots * sizeof(size_t));
+    tc->older = malloc(tc->slots * sizeof(size_t));
+    tc->table = malloc(table_size * sizeof(size_t));
+    if (!tc->written || !tc->cells || !tc->tile || !tc->dirty || !tc->newer
+        || !tc->older || !tc->table) {
+        cache_free(tc);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < table_size; i++) {
+        tc->table[i] = NONE;
+    }
+    tc->used = 0;
+    tc->mru = NONE;
+    tc->lru = NONE;
+    tc->last_tile = NONE;
+    tc->last_slot = NONE;
+    tc->stats.cached = tc->slots;
+
+    const char *dir = getenv("TMPDIR");
+    if (dir == NULL || *dir == '\0') {
+        dir = "/tmp";
+    }
+
+    char path[4096];
+    if (snprintf(path, sizeof(path), "%s/maze_tiled.XXXXXX", dir)
+        >= (int) sizeof(path)) {
+        cache_free(tc);
+        return NULL;
+    }
+
+    tc->fd = mkstemp(path);
+    if (tc->fd == -1) {
+        cache_free(tc);
+        return NULL;
+    }
+    unlink(path);
+
+    return tc;
+}
+
+/* Creates a square maze structure of 'n' rows by 'n' columns filled with
+ * walls. maze_init() is not part of the maze interface, it is a helper
+ * function for maze_read().
+ * Returns a pointer to the initialized maze or NULL if an error occured. */
+struct maze *maze_init(int n) {
+    if (n <= 0) {
+        return NULL;
+    }
+    struct maze *m = malloc(sizeof(struct maze));
+    if (!m) {
+        return NULL;
+    }
+    m->n = n;
+    m->tiles_per_row = ((size_t) n + MAZE_TILE_SIZE - 1) / MAZE_TILE_SIZE;
+    m->cache = cache_init(m->tiles_per_row * m->tiles_per_row);
+    if (!m->cache) {
+        free(m);
+        return NULL;
+    }
+
+    // And finally set the default start and finish locations.
+    m->start_index = maze_index(m, 1, 1); // upper left
+    m->finish_index = maze_index(m, maze_size(m) - 2,
+                                 maze_size(m) - 2); // lower right
+    return m;
+}
+
+void maze_cleanup(struct maze *m) {
+    if (getenv("MAZE_TILE_STATS") != NULL) {
+        maze_tile_stats_print(m);
+    }
+
+    cache_free(m->cache);
+    free(m);
+}
+
+int maze_tile_stats(const struct maze *m, struct maze_tile_stats *stats) {
+    if (m == NULL || stats == NULL) {
+        return 1;
+    }
+
+    *stats = m->cache->stats;
+    return 0;
+}
+
+void maze_tile_stats_print(const struct maze *m) {
+    struct maze_tile_stats stats;
+    if (maze_tile_stats(m, &stats)) {
+        return;
+    }
+
+    fprintf(stderr, "tiles %zu %zu %zu %zu %zu\n", stats.hits, stats.misses,
+            stats.evictions, stats.writebacks, stats.cached);
+}
+
+char maze_get(const struct maze *m, int r, int c) {
+    assert(r >= 0 && r < m->n && c >= 0 && c < m->n);
+    return *cell(m, r, c);
+}
+
+void maze_set(struct maze *m, int r, int c, char value) {
+    assert(r >= 0 && r < m->n && c >= 0 && c < m->n);
+    char *p = cell(m, r, c);
+    if (*p != value) {
+        *p = value;
+        m->cache->dirty[m->cache->last_slot] = true;
+    }
+}
+
+void maze_print(const struct maze *m, bool blocks) {
+    for (int r = 0; r < m->n; r++) {
+        for (int c = 0; c < m->n; c++) {
+            if (blocks && maze_get(m, r, c) == WALL) {
+                printf("\u2588");
+            } else if (maze_at_start(m, r, c)) {
+                putchar(START);
+            } else if (maze_at_destination(m, r, c)) {
+                putchar(FINISH);
+            } else {
+                putchar(maze_get(m, r, c));
+            }
+        }
+        printf("\n");
+    }
+    printf("\n");
+}
+
+/* Set RGB values in color array */
+static void set_rgb(unsigned char color[], unsigned char r, unsigned char g,
+                    unsigned char b) {
+    color[0] = r;
+    color[1] = g;
+    color[2] = b;
+}
+
+/* The colors are the same as those of maze_output_ppm() in maze.c. */
+int maze_output_ppm(const struct maze *m, const char *filename) {
+    FILE *fp = fopen(filename, "wb");
+    if (!fp) {
+        fprintf(stderr, "Cannot open file %s\n", filename);
+        return 1;
+    }
+
+    /* Write header */
+    fprintf(fp, "P6\n%d %d\n255\n", (int) m->n, (int) m->n);
+
+    /* Write RGB color data for every cell location. */
+    for (int r = 0; r < m->n; r++) {
+        for (int c = 0; c < m->n; c++) {
+            unsigned char color[3] = { 0, 0, 0 }; // black
+            char value = maze_get(m, r, c);
+            if (maze_at_start(m, r, c)) {
+                set_rgb(color, 0, 255, 0); // green
+            } else if (maze_at_destination(m, r, c)) {
+                set_rgb(color, 255, 165, 0); // orange
+            } else if (value == WALL) {
+                set_rgb(color, 255, 255, 255); // white
+            } else if (value == PATH) {
+                set_rgb(color, 255, 0, 0); // red
+            } else if (value == VISITED) {
+                set_rgb(color, 128, 128, 128); // gray
+            }
+            fwrite(color, 1, 3, fp);
+        }
+    }
+    fclose(fp);
+    return 0;
+}
+
+/* Detect and set start and finish locations in maze 'm'. */
+static void check_for_start_and_dest(struct maze *m, int r, int c, char val) {
+    if (val == START) {
+        m->start_index = maze_index(m, r, c);
+    } else if (val == FINISH) {
+        m->finish_index = maze_index(m, r, c);
+    }
+}
+
+/* Set 'val' character in 'm' at position 'r', 'c'. */
+static void set_value(struct maze *m, int r, int c, char val) {
+    if (val == WALL) {
+        maze_set(m, r, c, WALL);
+    } else {
+        /* Should overwrite start and finish markers with FLOOR. */
+        maze_set(m, r, c, FLOOR);
+    }
+}
+
+struct maze *maze_read(void) {
+    char *buf = NULL;
+    size_t bufsize = 0;
+
+    /* Read one line to get number of columns so we can allocate the maze. */
+    int ncols = (int) getline(&buf, &bufsize, stdin) - 1;
+    struct maze *m = maze_init(ncols);
+    if (!m) {
+        free(buf);
+        return NULL;
+    }
+
+    int row = 0;
+    do {
+        if (row == ncols) { /* Error: more rows than columns */
+            maze_cleanup(m);
+            free(buf);
+            return NULL;
+        }
+
+        int column = 0;
+        while (buf[column] != '\n') {
+            check_for_start_and_dest(m, row, column, buf[column]);
+            set_value(m, row, column, buf[column]);
+            column++;
+        }
+        row++;
+    } while (getline(&buf, &bufsize, stdin) == ncols + 1); // ncols + \n
+
+    if (row < ncols) { /* Error: more columns than rows */
+        maze_cleanup(m);
+        m = NULL;
+    }
+
+    free(buf);
+    return m;
+}
+
+void maze_start(const struct maze *m, int *r, int *c) {
+    *r = maze_row(m, m->start_index);
+    *c = maze_col(m, m->start_index);
+}
+
+void maze_destination(const struct maze *m, int *r, int *c) {
+    *r = maze_row(m, m->finish_index);
+    *c = maze_col(m, m->finish_index);
+}
+
+bool maze_at_start(const struct maze *m, int r, int c) {
+    return maze_index(m, r, c) == m->start_index;
+}
+
+bool maze_at_destination(const struct maze *m, int r, int c) {
+    return maze_index(m, r, c) == m->finish_index;
+}
+
+bool maze_valid_move(const struct maze *m, int r, int c) {
+    if (r > 0 && r < (m->n - 1) && c > 0 && c < (m->n - 1)) {
+        return true;
+    }
+    return false;
+}
+
+int maze_size(const struct maze *m) {
+    return m->n;
+}
+
+int maze_index(const struct maze *m, int r, int c) {
+    return m->n * r + c;
+}
+
+int maze_row(const struct maze *m, int index) {
+    return index / m->n;
+}
+
+int maze_col(const struct maze *m, int index) {
+    return index % m->n;
+}
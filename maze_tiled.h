@@ -0,0 +1,49 @@
+#ifndef _MAZE_TILED_H_
+#define _MAZE_TILED_H_
+
+/* Extensions to maze.h for the tiled, disk-backed maze in maze_tiled.c.
+ *
+ * The grid is stored in an unlinked temporary file in $TMPDIR as square
+ * tiles of MAZE_TILE_SIZE by MAZE_TILE_SIZE cells. Only a bounded number of
+ * tiles is kept in memory, the least recently used tile is written back
+ * and dropped when another one is needed. The number of cached tiles is
+ * read from the MAZE_TILE_CACHE environment variable by maze_read() and
+ * defaults to MAZE_TILE_CACHE_DEFAULT. If MAZE_TILE_STATS is set,
+ * maze_cleanup() prints the statistics below to stderr. */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "maze.h"
+
+/* Number of rows and columns in a tile, a 4 KiB tile fills one page. */
+#define MAZE_TILE_SIZE 64
+
+/* Number of tiles cached when MAZE_TILE_CACHE is not set (16 MiB). */
+#define MAZE_TILE_CACHE_DEFAULT 4096
+
+/**
+ * struct maze_tile_stats -- the statistics of the tile cache of a maze
+ * @hits: the number of cell accesses whose tile was in the cache
+ * @misses: the number of cell accesses that had to load a tile
+ * @evictions: the number of tiles dropped from the cache to make room
+ * @writebacks: the number of changed tiles written to the file
+ * @cached: the number of tiles the cache can hold
+ */
+struct maze_tile_stats {
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    size_t writebacks;
+    size_t cached;
+};
+
+/* Fill in 'stats' with the statistics of the tile cache of 'm'. Return 0
+ * if successful, 1 otherwise. */
+int maze_tile_stats(const struct maze *m, struct maze_tile_stats *stats);
+
+/* Print the statistics of the tile cache of 'm' to stderr as "tiles
+ * <hits> <misses> <evictions> <writebacks> <cached>". */
+void maze_tile_stats_print(const struct maze *m);
+
+#endif
@@ -0,0 +1,261 @@
+/*
+ * mpmc_queue.c -- a bounded lock-free multi-producer/multi-consumer queue
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpmc_queue.h"
+
+#define CACHE_LINE 64
+
+/* The maximum is sampled once every MAX_SAMPLE pushes (a power of two), so
+ * producers do not read the consumers' cache line on every push. */
+#define MAX_SAMPLE 64
+
+/**
+ * struct cell -- a slot in the ring
+ * @sequence: tells which operation may use the cell next
+ * @value: the item stored in the cell
+ *
+ * A cell at index i is free for the push with position pos when @sequence
+ * equals pos, and holds an item for the pop with position pos when
+ * @sequence equals pos + 1. After a pop @sequence is advanced by the
+ * capacity, which hands the cell to the push one lap later.
+ *
+ * @value is atomic only because mpmc_queue_peek() may read it while a
+ * push one lap later writes it; it is read and written with relaxed
+ * operations, ordered by @sequence.
+ */
+struct cell {
+    atomic_size_t sequence;
+    atomic_int value;
+};
+
+/**
+ * struct mpmc_queue -- the struct where the queue is stored
+ * @head: the position of the next push, shared by all producers
+ * @tail: the position of the next pop, shared by all consumers
+ * @max: the maximum number of items sampled by the producers
+ * @mask: the capacity minus one, the capacity is a power of two
+ * @cells: the ring of cells
+ *
+ * This is Dmitry Vyukov's bounded queue. Producers claim a position by
+ * moving @head forward with a compare-and-swap and consumers do the same
+ * with @tail. The sequence number in each cell tells a thread whether the
+ * cell at its position is ready, so producers and consumers never need to
+ * look at each other's index. @head and @tail each live on their own cache
+ * line.
+ *
+ * Since every push and pop moves @head or @tail forward by exactly one,
+ * they are also the push and pop counts for mpmc_queue_stats().
+ */
+struct mpmc_queue {
+    _Alignas(CACHE_LINE) atomic_size_t head;
+    _Alignas(CACHE_LINE) atomic_size_t tail;
+    _Alignas(CACHE_LINE) atomic_size_t max;
+    size_t mask;
+    struct cell *cells;
+};
+
+struct mpmc_queue *mpmc_queue_init(size_t capacity) {
+    /* Beyond this the rounding up below would overflow. */
+    if (capacity > SIZE_MAX / 2 + 1) {
+        return NULL;
+    }
+
+    size_t size = 2;
+    while (size < capacity) {
+        size *= 2;
+    }
+    if (size > SIZE_MAX / sizeof(struct cell)) {
+        return NULL;
+    }
+
+    struct mpmc_queue *q = aligned_alloc(CACHE_LINE, sizeof(struct mpmc_queue));
+    if (q == NULL) {
+        return NULL;
+    }
+
+    q->cells = malloc(size * sizeof(struct cell));
+    if (q->cells == NULL) {
+        free(q);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        atomic_init(&q->cells[i].sequence, i);
+        atomic_init(&q->cells[i].value, 0);
+    }
+
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->max, 0);
+    q->mask = size - 1;
+
+    return q;
+}
+
+void mpmc_queue_cleanup(struct mpmc_queue *q) {
+    if (q == NULL) {
+        return;
+    }
+
+    free(q->cells);
+    free(q);
+}
+
+void mpmc_queue_stats(const struct mpmc_queue *q) {
+    if (q == NULL) {
+        return;
+    }
+
+    fprintf(stderr, "stats %zu %zu %zu\n",
+            atomic_load_explicit(&q->head, memory_order_relaxed),
+            atomic_load_explicit(&q->tail, memory_order_relaxed),
+            atomic_load_explicit(&q->max, memory_order_relaxed));
+}
+
+/* Record 'length' as the maximum if it is larger than the current one. */
+static void update_max(struct mpmc_queue *q, size_t length) {
+    size_t max = atomic_load_explicit(&q->max, memory_order_relaxed);
+    while (length > max &&
+           !atomic_compare_exchange_weak_explicit(&q->max, &max, length,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+        /* 'max' was reloaded by the failed exchange. */
+    }
+}
+
+int mpmc_queue_push(struct mpmc_queue *q, int e) {
+    if (q == NULL) {
+        return 1;
+    }
+
+    struct cell *cell;
+    size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+
+    while (1) {
+        cell = &q->cells[pos & q->mask];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return 1; /* The cell still holds the item from one lap ago. */
+        } else {
+            pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+        }
+    }
+
+    /* Pairs with the fence in mpmc_queue_peek(): a peek that reads 'e'
+     * also sees that the pop of the last lap changed @sequence. */
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&cell->value, e, memory_order_relaxed);
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+
+    if ((pos & (MAX_SAMPLE - 1)) == 0) {
+        size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+        if (pos + 1 > tail) {
+            update_max(q, pos + 1 - tail);
+        }
+    }
+
+    return 0;
+}
+
+int mpmc_queue_pop(struct mpmc_queue *q) {
+    if (q == NULL) {
+        return -1;
+    }
+
+    struct cell *cell;
+    size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+
+    while (1) {
+        cell = &q->cells[pos & q->mask];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->tail, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return -1; /* Nothing has been pushed to this cell yet. */
+        } else {
+            pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+        }
+    }
+
+    int value = atomic_load_explicit(&cell->value, memory_order_relaxed);
+    atomic_store_explicit(&cell->sequence, pos + q->mask + 1,
+                          memory_order_release);
+
+    return value;
+}
+
+int mpmc_queue_peek(const struct mpmc_queue *q) {
+    if (q == NULL) {
+        return -1;
+    }
+
+    size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+
+    while (1) {
+        const struct cell *cell = &q->cells[pos & q->mask];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+
+        if (diff < 0) {
+            return -1; /* Nothing has been pushed to this cell yet. */
+        }
+
+        if (diff == 0) {
+            /* Another consumer may pop the item and a producer may push
+             * the next one into the cell while we read it. Both change
+             * @sequence, so an unchanged one means 'value' is the item. */
+            int value = atomic_load_explicit(&cell->value,
+                                             memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&cell->sequence,
+                                     memory_order_relaxed) == seq) {
+                return value;
+            }
+        }
+
+        pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    }
+}
+
+int mpmc_queue_empty(const struct mpmc_queue *q) {
+    if (q == NULL) {
+        return -1;
+    }
+
+    return mpmc_queue_size(q) == 0;
+}
+
+size_t mpmc_queue_size(const struct mpmc_queue *q) {
+    if (q == NULL) {
+        return 1;
+    }
+
+    /* Load @tail first, so that @head can never be behind it. */
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    size_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+
+    return head - tail;
+}
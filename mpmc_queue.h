@@ -0,0 +1,49 @@
+#ifndef _MPMC_QUEUE_H_
+#define _MPMC_QUEUE_H_
+
+#include <stddef.h>
+
+/* Handle to a bounded multi-producer/multi-consumer queue.
+ *
+ * Any number of threads may push and pop concurrently. None of the
+ * operations take a lock; a push or pop only retries when another thread
+ * claimed the same slot first. */
+struct mpmc_queue;
+
+/* Return a pointer to a queue that can hold at least 'capacity' items if
+ * successful, otherwise return NULL. The capacity is rounded up to a power
+ * of two (at least 2) and the queue does not grow. */
+struct mpmc_queue *mpmc_queue_init(size_t capacity);
+
+/* Cleanup queue. No thread may use the queue anymore. */
+void mpmc_queue_cleanup(struct mpmc_queue *q);
+
+/* Print queue statistics to stderr.
+ * The format is: 'stats' num_of_pushes num_of_pops max_elements
+ * The maximum is sampled and may be lower than the true maximum. */
+void mpmc_queue_stats(const struct mpmc_queue *q);
+
+/* Push item to the end of the queue.
+ * Return 0 if successful, 1 if the queue is full or on error. */
+int mpmc_queue_push(struct mpmc_queue *q, int e);
+
+/* Remove the first item from queue and return it.
+ * Return the first item if successful, -1 otherwise. */
+int mpmc_queue_pop(struct mpmc_queue *q);
+
+/* Return the first item from queue. Leave queue unchanged. With several
+ * consumers the item may be popped by another thread right after this
+ * returns, but the value returned was at the front of the queue at some
+ * point during the call.
+ * Return the first item if successful, -1 otherwise. */
+int mpmc_queue_peek(const struct mpmc_queue *q);
+
+/* Return 1 if queue is empty, 0 if the queue contains any elements and
+ * return -1 if the operation fails. */
+int mpmc_queue_empty(const struct mpmc_queue *q);
+
+/* Return the number of elements stored in the queue. While other threads
+ * are using the queue this is only a snapshot. */
+size_t mpmc_queue_size(const struct mpmc_queue *q);
+
+#endif
@@ -5,10 +5,17 @@
  * Universiteit van Amsterdam
  */
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-#include "queue.h"
+#include "queue_ext.h"
+#include "vmem.h"
+
+/* A mapped queue hands the pages behind its tail back to the kernel in
+ * spans of this many items, the size of a 2 MiB huge page. */
+#define DISCARD_ITEMS ((size_t) (2 << 20) / sizeof(int))
 
 /**
  * struct queue -- the struct where the queue is stored
@@ -20,10 +27,30 @@
  * @pop: the number of times the queue has been popped
  * @max: the maximum @length that has been reached
  * @data: a pointer to the items in the queue
+ * @alloc: the allocator the structure and @data come from
+ * @inline_data: the items array of the struct queue_inline, or NULL
+ * @embedded: true if the structure lives in a struct queue_inline
+ * @huge_pages: whether the mapping @data lives in uses huge pages
+ * @reserved: the size in bytes of the mapping @data lives in, or 0
+ * @resizes: the number of times @data grew
+ * @copied: the number of bytes copied while @data grew
+ * @peak_capacity: the maximum @capacity that has been reached
+ * @failed: the number of pushes that failed
+ * @empty_pops: the number of pops on an empty queue
  *
  * This is a straightforward implementation of a queue. Since the queue
  * may be resized, we cannot store the items inside the structure itself,
  * and instead we have to store the items in another region in memory.
+ *
+ * A queue made by queue_init_inline() starts out with @data pointing at
+ * @inline_data. Neither the structure nor @inline_data may be given back to
+ * @alloc.
+ *
+ * A queue made by queue_init_mapped() is a ring over a region from
+ * vmem_reserve() that spans the maximum capacity, rounded up to whole
+ * DISCARD_ITEMS spans. It never resizes. Each time the tail leaves a span
+ * and that span holds no items, its pages are discarded, so the memory in
+ * use follows the items in the queue instead of the whole ring.
  */
 struct queue {
     size_t length;
@@ -34,27 +61,106 @@ struct queue {
     size_t pop;
     size_t max;
     int *data;
+    const struct allocator *alloc;
+    int *inline_data;
+    bool embedded;
+    bool huge_pages;
+    size_t reserved;
+    size_t resizes;
+    size_t copied;
+    size_t peak_capacity;
+    size_t failed;
+    size_t empty_pops;
 };
 
+_Static_assert(sizeof(struct queue) <= sizeof(((struct queue_inline *) 0)->header),
+               "struct queue does not fit in struct queue_inline");
+
+/* Set up the fields of a new, empty queue. */
+static void queue_setup(struct queue *q, int *data, size_t capacity,
+                        const struct allocator *a) {
+    q->data = data;
+    q->alloc = a;
+    q->inline_data = NULL;
+    q->embedded = false;
+    q->huge_pages = false;
+    q->reserved = 0;
+    q->length = 0;
+    q->capacity = capacity;
+    q->head = 0;
+    q->tail = 0;
+    q->push = 0;
+    q->pop = 0;
+    q->max = 0;
+    q->resizes = 0;
+    q->copied = 0;
+    q->peak_capacity = capacity;
+    q->failed = 0;
+    q->empty_pops = 0;
+}
+
 struct queue *queue_init(size_t capacity) {
+    return queue_init_with_allocator(capacity, &malloc_allocator);
+}
+
+struct queue *queue_init_with_allocator(size_t capacity,
+                                        const struct allocator *a) {
+    if (a == NULL) {
+        return NULL;
+    }
+
+    struct queue *q = a->alloc(a->ctx, sizeof(struct queue));
+    if (q == NULL) {
+        return NULL;
+    }
+
+    int *data = a->alloc(a->ctx, capacity * sizeof(int));
+    if (data == NULL) {
+        a->release(a->ctx, q, sizeof(struct queue));
+        return NULL;
+    }
+
+    queue_setup(q, data, capacity, a);
+
+    return q;
+}
+
+struct queue *queue_init_inline(struct queue_inline *storage) {
+    if (storage == NULL) {
+        return NULL;
+    }
+
+    struct queue *q = (struct queue *) &storage->header;
+    queue_setup(q, storage->items, QUEUE_INLINE_CAPACITY, &malloc_allocator);
+    q->inline_data = storage->items;
+    q->embedded = true;
+
+    return q;
+}
+
+struct queue *queue_init_mapped(size_t max_capacity, bool huge_pages) {
+    if (max_capacity == 0 ||
+        max_capacity > SIZE_MAX / sizeof(int) - DISCARD_ITEMS) {
+        return NULL;
+    }
+
     struct queue *q = malloc(sizeof(struct queue));
     if (q == NULL) {
         return NULL;
     }
 
-    q->data = malloc(capacity * sizeof(int));
-    if (q->data == NULL) {
+    size_t capacity = (max_capacity + DISCARD_ITEMS - 1) / DISCARD_ITEMS
+                      * DISCARD_ITEMS;
+    size_t reserved = capacity * sizeof(int);
+    int *data = vmem_reserve(reserved, huge_pages);
+    if (data == NULL) {
         free(q);
         return NULL;
     }
 
-    q->length = 0;
-    q->capacity = capacity;
-    q->head = 0;
-    q->tail = 0;
-    q->push = 0;
-    q->pop = 0;
-    q->max = 0;
+    queue_setup(q, data, capacity, &malloc_allocator);
+    q->reserved = reserved;
+    q->huge_pages = huge_pages;
 
     return q;
 }
@@ -64,8 +170,34 @@ void queue_cleanup(struct queue *q) {
         return;
     }
     
-    free(q->data);
-    free(q);
+    if (q->reserved) {
+        vmem_release(q->data, q->reserved, q->huge_pages);
+    } else if (q->data != q->inline_data) {
+        q->alloc->release(q->alloc->ctx, q->data, q->capacity * sizeof(int));
+    }
+    if (!q->embedded) {
+        q->alloc->release(q->alloc->ctx, q, sizeof(struct queue));
+    }
+}
+
+int queue_get_stats(const struct queue *q, struct container_stats *stats) {
+    if (q == NULL || stats == NULL) {
+        return 1;
+    }
+
+    stats->push = q->push;
+    stats->pop = q->pop;
+    stats->max = q->max;
+    stats->resizes = q->resizes;
+    stats->bytes_copied = q->copied;
+    stats->capacity = q->capacity;
+    stats->peak_capacity = q->peak_capacity;
+    stats->bytes = q->capacity * sizeof(int);
+    stats->peak_bytes = q->peak_capacity * sizeof(int);
+    stats->failed = q->failed;
+    stats->empty_pops = q->empty_pops;
+
+    return 0;
 }
 
 void queue_stats(const struct queue *q) {
@@ -82,9 +214,16 @@ int queue_push(struct queue *q, int e) {
     }
     
     if (q->length >= q->capacity) {
+        if (q->reserved) {
+            /* The whole reservation is in use. */
+            q->failed++;
+            return 1;
+        }
+
         size_t new_capacity = q->capacity * 2 + 1;
-        int *new = malloc(new_capacity * sizeof(int));
+        int *new = q->alloc->alloc(q->alloc->ctx, new_capacity * sizeof(int));
         if (new == NULL) {
+            q->failed++;
             return 1;
         }
 
@@ -104,12 +243,20 @@ int queue_push(struct queue *q, int e) {
             new[i] = q->data[old_index];
         }
 
-        free(q->data);
+        if (q->data != q->inline_data) {
+            q->alloc->release(q->alloc->ctx, q->data,
+                              q->capacity * sizeof(int));
+        }
 
         q->tail = 0;
         q->head = q->length;
         q->data = new;
         q->capacity = new_capacity;
+        q->resizes++;
+        q->copied += q->length * sizeof(int);
+        if (new_capacity > q->peak_capacity) {
+            q->peak_capacity = new_capacity;
+        }
     }
 
     q->data[q->head++] = e;
@@ -134,11 +281,19 @@ int queue_pop(struct queue *q) {
     }
     
     if (q->length == 0) {
+        q->empty_pops++;
         return -1;
     }
 
     int value = q->data[q->tail++];
 
+    if (q->reserved && q->tail % DISCARD_ITEMS == 0 &&
+        q->capacity - (q->length - 1) >= DISCARD_ITEMS) {
+        /* The span the tail just left is free, so give its pages back. */
+        vmem_discard(q->data + q->tail - DISCARD_ITEMS,
+                     DISCARD_ITEMS * sizeof(int));
+    }
+
     if (q->tail >= q->capacity) {
         q->tail -= q->capacity;
     }
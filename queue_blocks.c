@@ -0,0 +1,325 @@
+/*
+ * queue_blocks.c -- an unrolled block-list implementation of queue.h
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "queue_ext.h"
+
+/* Number of items stored in a single block. */
+#define BLOCK_ITEMS 1024
+
+/* Maximum number of spare blocks kept around for reuse. */
+#define POOL_MAX 4
+
+/**
+ * struct block -- a fixed-size chunk of the queue
+ * @next: the next (newer) block in the queue or the next block in the pool
+ * @items: the items stored in this block
+ */
+struct block {
+    struct block *next;
+    int items[BLOCK_ITEMS];
+};
+
+/**
+ * struct queue -- the struct where the queue is stored
+ * @length: the number of items currently in the queue
+ * @head: the index in @back where the next item will be pushed
+ * @tail: the index in @front of the first item in the queue
+ * @push: the number of times the queue has been pushed to
+ * @pop: the number of times the queue has been popped
+ * @max: the maximum @length that has been reached
+ * @front: the oldest block, items are popped from here
+ * @back: the newest block, items are pushed here
+ * @pool: a list of spare blocks that can be reused by @back
+ * @pool_size: the number of blocks in @pool
+ * @alloc: the allocator the structure and the blocks come from
+ * @embedded: true if the structure lives in a struct queue_inline
+ * @blocks: the number of blocks allocated, including those in @pool
+ * @peak_blocks: the maximum @blocks that has been reached
+ * @resizes: the number of times a block was linked in after @back
+ * @failed: the number of pushes that failed
+ * @empty_pops: the number of pops on an empty queue
+ *
+ * The queue is a linked list of blocks. Pushing fills up @back and links
+ * in a new block once it is full, popping drains @front and hands the
+ * empty block to @pool once it is exhausted. Items are never copied when
+ * the queue grows, and since the pool is small the memory in use stays
+ * proportional to the number of items between @front and @back.
+ *
+ * A block is much larger than the items array of a struct queue_inline, so
+ * queue_init_inline() only places the structure there and still allocates
+ * the first block.
+ */
+struct queue {
+    size_t length;
+    size_t head;
+    size_t tail;
+    size_t push;
+    size_t pop;
+    size_t max;
+    struct block *front;
+    struct block *back;
+    struct block *pool;
+    size_t pool_size;
+    const struct allocator *alloc;
+    bool embedded;
+    size_t blocks;
+    size_t peak_blocks;
+    size_t resizes;
+    size_t failed;
+    size_t empty_pops;
+};
+
+_Static_assert(sizeof(struct queue) <= sizeof(((struct queue_inline *) 0)->header),
+               "struct queue does not fit in struct queue_inline");
+
+/* Return a spare block from the pool, or allocate a new one. */
+static struct block *block_get(struct queue *q) {
+    struct block *b = q->pool;
+    if (b != NULL) {
+        q->pool = b->next;
+        q->pool_size--;
+    } else {
+        b = q->alloc->alloc(q->alloc->ctx, sizeof(struct block));
+        if (b == NULL) {
+            return NULL;
+        }
+        if (++q->blocks > q->peak_blocks) {
+            q->peak_blocks = q->blocks;
+        }
+    }
+
+    b->next = NULL;
+    return b;
+}
+
+/* Hand a drained block back to the pool, or free it if the pool is full. */
+static void block_put(struct queue *q, struct block *b) {
+    if (q->pool_size >= POOL_MAX) {
+        q->alloc->release(q->alloc->ctx, b, sizeof(struct block));
+        q->blocks--;
+        return;
+    }
+
+    b->next = q->pool;
+    q->pool = b;
+    q->pool_size++;
+}
+
+/* Free a linked list of blocks. */
+static void block_free_list(struct queue *q, struct block *b) {
+    while (b != NULL) {
+        struct block *next = b->next;
+        q->alloc->release(q->alloc->ctx, b, sizeof(struct block));
+        b = next;
+    }
+}
+
+/* Set up the fields of a new, empty queue and allocate its first block.
+ * Return 0 if successful, 1 otherwise. */
+static int queue_setup(struct queue *q, const struct allocator *a) {
+    q->front = a->alloc(a->ctx, sizeof(struct block));
+    if (q->front == NULL) {
+        return 1;
+    }
+
+    q->alloc = a;
+    q->embedded = false;
+    q->front->next = NULL;
+    q->back = q->front;
+    q->pool = NULL;
+    q->pool_size = 0;
+    q->length = 0;
+    q->head = 0;
+    q->tail = 0;
+    q->push = 0;
+    q->pop = 0;
+    q->max = 0;
+    q->blocks = 1;
+    q->peak_blocks = 1;
+    q->resizes = 0;
+    q->failed = 0;
+    q->empty_pops = 0;
+
+    return 0;
+}
+
+struct queue *queue_init(size_t capacity) {
+    return queue_init_with_allocator(capacity, &malloc_allocator);
+}
+
+struct queue *queue_init_with_allocator(size_t capacity,
+                                        const struct allocator *a) {
+    (void) capacity; /* Blocks are allocated on demand. */
+
+    if (a == NULL) {
+        return NULL;
+    }
+
+    struct queue *q = a->alloc(a->ctx, sizeof(struct queue));
+    if (q == NULL) {
+        return NULL;
+    }
+
+    if (queue_setup(q, a)) {
+        a->release(a->ctx, q, sizeof(struct queue));
+        return NULL;
+    }
+
+    return q;
+}
+
+struct queue *queue_init_inline(struct queue_inline *storage) {
+    if (storage == NULL) {
+        return NULL;
+    }
+
+    struct queue *q = (struct queue *) &storage->header;
+    if (queue_setup(q, &malloc_allocator)) {
+        return NULL;
+    }
+    q->embedded = true;
+
+    return q;
+}
+
+struct queue *queue_init_mapped(size_t max_capacity, bool huge_pages) {
+    (void) huge_pages;
+
+    /* Blocks never copy items, so the usual storage already grows without
+     * copying and without holding on to drained memory. */
+    return queue_init_with_allocator(max_capacity, &malloc_allocator);
+}
+
+void queue_cleanup(struct queue *q) {
+    if (q == NULL) {
+        return;
+    }
+
+    block_free_list(q, q->front);
+    block_free_list(q, q->pool);
+    if (!q->embedded) {
+        q->alloc->release(q->alloc->ctx, q, sizeof(struct queue));
+    }
+}
+
+int queue_get_stats(const struct queue *q, struct container_stats *stats) {
+    if (q == NULL || stats == NULL) {
+        return 1;
+    }
+
+    stats->push = q->push;
+    stats->pop = q->pop;
+    stats->max = q->max;
+    stats->resizes = q->resizes;
+    stats->bytes_copied = 0; /* Items never move. */
+    stats->capacity = q->blocks * BLOCK_ITEMS;
+    stats->peak_capacity = q->peak_blocks * BLOCK_ITEMS;
+    stats->bytes = q->blocks * sizeof(struct block);
+    stats->peak_bytes = q->peak_blocks * sizeof(struct block);
+    stats->failed = q->failed;
+    stats->empty_pops = q->empty_pops;
+
+    return 0;
+}
+
+void queue_stats(const struct queue *q) {
+    if (q == NULL) {
+        return;
+    }
+
+    fprintf(stderr, "stats %zu %zu %zu\n", q->push, q->pop, q->max);
+}
+
+int queue_push(struct queue *q, int e) {
+    if (q == NULL) {
+        return 1;
+    }
+
+    if (q->head >= BLOCK_ITEMS) {
+        struct block *b = block_get(q);
+        if (b == NULL) {
+            q->failed++;
+            return 1;
+        }
+
+        q->back->next = b;
+        q->back = b;
+        q->head = 0;
+        q->resizes++;
+    }
+
+    q->back->items[q->head++] = e;
+    q->length++;
+    q->push++;
+
+    if (q->length >= q->max) {
+        q->max = q->length;
+    }
+
+    return 0;
+}
+
+int queue_pop(struct queue *q) {
+    if (q == NULL) {
+        return -1;
+    }
+
+    if (q->length == 0) {
+        q->empty_pops++;
+        return -1;
+    }
+
+    int value = q->front->items[q->tail++];
+    q->length--;
+    q->pop++;
+
+    if (q->tail >= BLOCK_ITEMS) {
+        if (q->front == q->back) {
+            /* The queue is empty, so simply start over in this block. */
+            q->head = 0;
+        } else {
+            struct block *drained = q->front;
+            q->front = drained->next;
+            block_put(q, drained);
+        }
+        q->tail = 0;
+    }
+
+    return value;
+}
+
+int queue_peek(const struct queue *q) {
+    if (q == NULL) {
+        return -1;
+    }
+
+    if (q->length == 0) {
+        return -1;
+    }
+
+    return q->front->items[q->tail];
+}
+
+int queue_empty(const struct queue *q) {
+    if (q == NULL) {
+        return -1;
+    }
+
+    return q->length == 0;
+}
+
+size_t queue_size(const struct queue *q) {
+    if (q == NULL) {
+        return 1;
+    }
+
+    return q->length;
+}
@@ -0,0 +1,55 @@
+#ifndef _QUEUE_EXT_H_
+#define _QUEUE_EXT_H_
+
+/* Extensions to the interface in queue.h. */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "allocator.h"
+#include "container_stats.h"
+#include "queue.h"
+
+/* Number of items that fit in a struct queue_inline before the queue has
+ * to move its items to the heap. */
+#define QUEUE_INLINE_CAPACITY 64
+
+/* Memory for a queue and its first QUEUE_INLINE_CAPACITY items, to be
+ * placed wherever the caller likes, for example in a local variable. The
+ * fields are private to the queue implementation. */
+struct queue_inline {
+    union {
+        max_align_t align;
+        unsigned char bytes[256];
+    } header;
+    int items[QUEUE_INLINE_CAPACITY];
+};
+
+/* Return a pointer to a queue data structure with an initial capacity of
+ * 'capacity' if successful, otherwise return NULL. The queue structure and
+ * its items are allocated with 'a', which must outlive the queue. */
+struct queue *queue_init_with_allocator(size_t capacity,
+                                        const struct allocator *a);
+
+/* Return a pointer to a queue that lives in 'storage' and stores its first
+ * QUEUE_INLINE_CAPACITY items there as well, or NULL if 'storage' is NULL
+ * or the queue could not be set up. queue.c never allocates memory here.
+ * Once the queue outgrows 'storage' its items move to memory from
+ * malloc(). queue_cleanup() must still be called, but it leaves 'storage'
+ * itself alone. */
+struct queue *queue_init_inline(struct queue_inline *storage);
+
+/* Return a pointer to a queue that can hold up to 'max_capacity' items, or
+ * NULL if an error occured. Address space for all items is reserved up
+ * front with mmap() and memory is only committed as the queue reaches it,
+ * so the items are never copied. If 'huge_pages' is true the items are
+ * placed on transparent huge pages where the system allows it. Pushing
+ * onto a full queue returns 1. Backends that never copy items anyway may
+ * use their usual storage instead. */
+struct queue *queue_init_mapped(size_t max_capacity, bool huge_pages);
+
+/* Fill in 'stats' with the statistics of 'q'. Return 0 if successful, 1
+ * otherwise. */
+int queue_get_stats(const struct queue *q, struct container_stats *stats);
+
+#endif
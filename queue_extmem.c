@@ -0,0 +1,628 @@
+/*
+ * queue_extmem.c -- an implementation of queue.h that spills to disk
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+// Needed for fallocate() and FALLOC_FL_PUNCH_HOLE
+#define _GNU_SOURCE
+
+#include <aio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "queue_ext.h"
+
+/* Number of items in a chunk, the unit that is written and read. */
+#ifndef EXTMEM_CHUNK_ITEMS
+#define EXTMEM_CHUNK_ITEMS (1 << 18)
+#endif
+
+/* Number of full chunks kept in memory before the queue starts spilling. */
+#ifndef EXTMEM_READY_MAX
+#define EXTMEM_READY_MAX 4
+#endif
+
+/* Number of writes that may be in flight at the same time. */
+#define WRITE_MAX 4
+
+/* Maximum number of spare chunks kept around for reuse. */
+#define POOL_MAX 2
+
+#define CHUNK_BYTES ((off_t) (EXTMEM_CHUNK_ITEMS * sizeof(int)))
+
+/**
+ * struct chunk -- a fixed-size piece of the queue
+ * @next: the next (newer) chunk on the list this chunk is on
+ * @offset: where the chunk lives in the file, if it was ever written
+ * @in_flight: true while a write or read of this chunk has not been waited
+ *             for
+ * @cb: the control block of the last write or read of this chunk
+ * @items: the items stored in this chunk
+ */
+struct chunk {
+    struct chunk *next;
+    off_t offset;
+    bool in_flight;
+    struct aiocb cb;
+    int items[EXTMEM_CHUNK_ITEMS];
+};
+
+/**
+ * struct list -- a singly linked list of chunks with a tail pointer
+ * @first: the oldest chunk on the list
+ * @last: the newest chunk on the list
+ * @count: the number of chunks on the list
+ */
+struct list {
+    struct chunk *first;
+    struct chunk *last;
+    size_t count;
+};
+
+/**
+ * struct queue -- the struct where the queue is stored
+ * @length: the number of items currently in the queue
+ * @head: the index in @back where the next item will be pushed
+ * @tail: the index in @front of the first item in the queue
+ * @push: the number of times the queue has been pushed to
+ * @pop: the number of times the queue has been popped
+ * @max: the maximum @length that has been reached
+ * @front: the oldest chunk, items are popped from here
+ * @back: the newest chunk, items are pushed here
+ * @ready: full chunks in memory that come right after @front
+ * @reading: a chunk being read ahead from the file, or NULL
+ * @writing: chunks being written to the file, oldest first
+ * @pool: spare chunks
+ * @fd: the temporary file, or -1 if the queue has not spilled yet
+ * @read_offset: the file offset of the oldest chunk not yet read back
+ * @write_offset: the file offset where the next chunk will be written
+ * @alloc: the allocator the structure and the chunks come from
+ * @embedded: true if the structure lives in a struct queue_inline
+ * @chunks: the number of chunks in memory, including those in @pool
+ * @peak_chunks: the maximum @chunks that has been reached
+ * @resizes: the number of times a new @back was started
+ * @failed: the number of pushes that failed
+ * @empty_pops: the number of pops on an empty queue
+ *
+ * In queue order the items are in @front, @ready, @reading, the file from
+ * @read_offset, @writing and finally @back. As long as the file is not in
+ * use, full chunks simply go to @ready. Once @ready is full, every chunk
+ * that fills up is written to the end of the file instead, so the memory
+ * in use stays bounded no matter how long the queue gets.
+ *
+ * All I/O is done a whole chunk at a time with POSIX asynchronous I/O.
+ * Writes only have to finish before their memory is needed again, and the
+ * chunk after @ready is read ahead while @front is drained, so the file is
+ * written and read sequentially in the background. A chunk that is still
+ * on @writing when its turn comes is taken from there instead of read back.
+ * The file is unlinked right after it is created and space that has been
+ * read back is punched out, so it only holds the middle of the queue.
+ */
+struct queue {
+    size_t length;
+    size_t head;
+    size_t tail;
+    size_t push;
+    size_t pop;
+    size_t max;
+    struct chunk *front;
+    struct chunk *back;
+    struct list ready;
+    struct chunk *reading;
+    struct list writing;
+    struct list pool;
+    int fd;
+    off_t read_offset;
+    off_t write_offset;
+    const struct allocator *alloc;
+    bool embedded;
+    size_t chunks;
+    size_t peak_chunks;
+    size_t resizes;
+    size_t failed;
+    size_t empty_pops;
+};
+
+_Static_assert(sizeof(struct queue) <= sizeof(((struct queue_inline *) 0)->header),
+               "struct queue does not fit in struct queue_inline");
+
+static void list_append(struct list *l, struct chunk *c) {
+    c->next = NULL;
+    if (l->last) {
+        l->last->next = c;
+    } else {
+        l->first = c;
+    }
+    l->last = c;
+    l->count++;
+}
+
+static struct chunk *list_take(struct list *l) {
+    struct chunk *c = l->first;
+    if (c == NULL) {
+        return NULL;
+    }
+
+    l->first = c->next;
+    if (l->first == NULL) {
+        l->last = NULL;
+    }
+    l->count--;
+    c->next = NULL;
+    return c;
+}
+
+/* Return a spare chunk from the pool, or allocate a new one. */
+static struct chunk *chunk_get(struct queue *q) {
+    struct chunk *c = list_take(&q->pool);
+    if (c == NULL) {
+        c = q->alloc->alloc(q->alloc->ctx, sizeof(struct chunk));
+        if (c == NULL) {
+            return NULL;
+        }
+        c->in_flight = false;
+        if (++q->chunks > q->peak_chunks) {
+            q->peak_chunks = q->chunks;
+        }
+    }
+
+    return c;
+}
+
+/* Hand a chunk back to the pool, or free it if the pool is full. */
+static void chunk_put(struct queue *q, struct chunk *c) {
+    if (q->pool.count >= POOL_MAX) {
+        q->alloc->release(q->alloc->ctx, c, sizeof(struct chunk));
+        q->chunks--;
+    } else {
+        list_append(&q->pool, c);
+    }
+}
+
+/* Wait for the I/O in flight on 'c', if any. Return 0 if it transferred
+ * the whole chunk, 1 otherwise. */
+static int chunk_wait(struct chunk *c) {
+    const struct aiocb *list[1] = { &c->cb };
+
+    if (!c->in_flight) {
+        return 0;
+    }
+
+    while (aio_error(&c->cb) == EINPROGRESS) {
+        aio_suspend(list, 1, NULL);
+    }
+
+    c->in_flight = false;
+    return aio_return(&c->cb) != CHUNK_BYTES;
+}
+
+/* Start an asynchronous write or read of the chunk 'c' at 'offset'.
+ * Return 0 if successful, 1 otherwise. */
+static int chunk_start(struct queue *q, struct chunk *c, off_t offset,
+                       bool write) {
+    memset(&c->cb, 0, sizeof(c->cb));
+    c->cb.aio_fildes = q->fd;
+    c->cb.aio_offset = offset;
+    c->cb.aio_buf = c->items;
+    c->cb.aio_nbytes = (size_t) CHUNK_BYTES;
+    c->cb.aio_sigevent.sigev_notify = SIGEV_NONE;
+    c->offset = offset;
+
+    if (write ? aio_write(&c->cb) : aio_read(&c->cb)) {
+        return 1;
+    }
+
+    c->in_flight = true;
+    return 0;
+}
+
+/* Create the unlinked temporary file the queue spills to. Return 0 if
+ * successful, 1 otherwise. */
+static int file_open(struct queue *q) {
+    const char *dir = getenv("TMPDIR");
+    if (dir == NULL || *dir == '\0') {
+        dir = "/tmp";
+    }
+
+    char path[4096];
+    if (snprintf(path, sizeof(path), "%s/queue_extmem.XXXXXX", dir)
+        >= (int) sizeof(path)) {
+        return 1;
+    }
+
+    q->fd = mkstemp(path);
+    if (q->fd == -1) {
+        return 1;
+    }
+
+    unlink(path);
+    q->read_offset = 0;
+    q->write_offset = 0;
+    return 0;
+}
+
+/* Give the file space of the chunk at 'offset' back to the file system. */
+static void file_discard(struct queue *q, off_t offset) {
+#ifdef FALLOC_FL_PUNCH_HOLE
+    fallocate(q->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset,
+              CHUNK_BYTES);
+#else
+    (void) q;
+    (void) offset;
+#endif
+}
+
+/* Move the writes at the front of @writing that have finished to the pool.
+ * If 'wait' is true, wait for the oldest write first. Return 0 if
+ * successful, 1 if a write failed. */
+static int reap_writes(struct queue *q, bool wait) {
+    struct chunk *c;
+
+    while ((c = q->writing.first) != NULL) {
+        if (!wait && aio_error(&c->cb) == EINPROGRESS) {
+            break;
+        }
+
+        wait = false;
+        list_take(&q->writing);
+        int failed = chunk_wait(c);
+        chunk_put(q, c);
+        if (failed) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Move the chunk 'c' that just filled up out of the way of @back, either
+ * to @ready or to the file. Return 0 if successful, 1 otherwise. */
+static int spill(struct queue *q, struct chunk *c) {
+    bool in_file = q->fd != -1 && (q->read_offset < q->write_offset ||
+                                   q->reading != NULL);
+
+    if (!in_file && q->writing.count == 0 &&
+        q->ready.count < EXTMEM_READY_MAX) {
+        list_append(&q->ready, c);
+        return 0;
+    }
+
+    if (q->fd == -1 && file_open(q)) {
+        return 1;
+    }
+
+    if (reap_writes(q, q->writing.count >= WRITE_MAX)) {
+        return 1;
+    }
+
+    if (chunk_start(q, c, q->write_offset, true)) {
+        return 1;
+    }
+
+    list_append(&q->writing, c);
+    q->write_offset += CHUNK_BYTES;
+    return 0;
+}
+
+/* If the next chunk after @ready lives in the file, take it: from @writing
+ * if its write is still around, otherwise by starting a read. Return the
+ * chunk, which may still be in flight, or NULL if there is none or an
+ * error occured. */
+static struct chunk *fetch(struct queue *q) {
+    if (q->fd == -1 || q->read_offset >= q->write_offset) {
+        return NULL;
+    }
+
+    /* Writes finish in order, so only the oldest one can be next. */
+    struct chunk *c = q->writing.first;
+    if (c != NULL && c->offset == q->read_offset) {
+        list_take(&q->writing);
+    } else {
+        c = chunk_get(q);
+        if (c == NULL) {
+            return NULL;
+        }
+
+        if (chunk_start(q, c, q->read_offset, false)) {
+            chunk_put(q, c);
+            return NULL;
+        }
+    }
+
+    q->read_offset += CHUNK_BYTES;
+    return c;
+}
+
+/* Replace the drained @front by the next chunk in queue order. Return 0 if
+ * successful, 1 otherwise. */
+static int refill(struct queue *q) {
+    struct chunk *next = list_take(&q->ready);
+
+    if (next == NULL) {
+        next = q->reading;
+        q->reading = NULL;
+        if (next == NULL) {
+            next = fetch(q);
+        }
+
+        if (next != NULL) {
+            if (chunk_wait(next)) {
+                /* The items are gone, the queue can't go on. */
+                chunk_put(q, next);
+                return 1;
+            }
+            file_discard(q, next->offset);
+        } else if (q->fd != -1 && q->read_offset < q->write_offset) {
+            /* The chunk couldn't be fetched, try again later. */
+            return 1;
+        }
+    }
+
+    if (next == NULL) {
+        /* Everything that is left is in @back. */
+        next = q->back;
+    }
+
+    chunk_put(q, q->front);
+    q->front = next;
+    q->tail = 0;
+
+    if (q->ready.count == 0 && q->reading == NULL) {
+        q->reading = fetch(q);
+    }
+
+    if (q->fd != -1 && q->read_offset == q->write_offset &&
+        q->reading == NULL && q->writing.count == 0) {
+        /* Nothing is left in the file, so start over at its beginning. */
+        q->read_offset = 0;
+        q->write_offset = 0;
+    }
+
+    return 0;
+}
+
+/* Set up the fields of a new, empty queue and allocate its first chunk.
+ * Return 0 if successful, 1 otherwise. */
+static int queue_setup(struct queue *q, const struct allocator *a) {
+    q->front = a->alloc(a->ctx, sizeof(struct chunk));
+    if (q->front == NULL) {
+        return 1;
+    }
+    q->front->in_flight = false;
+
+    q->alloc = a;
+    q->embedded = false;
+    q->back = q->front;
+    q->ready = (struct list) { NULL, NULL, 0 };
+    q->reading = NULL;
+    q->writing = (struct list) { NULL, NULL, 0 };
+    q->pool = (struct list) { NULL, NULL, 0 };
+    q->fd = -1;
+    q->read_offset = 0;
+    q->write_offset = 0;
+    q->length = 0;
+    q->head = 0;
+    q->tail = 0;
+    q->push = 0;
+    q->pop = 0;
+    q->max = 0;
+    q->chunks = 1;
+    q->peak_chunks = 1;
+    q->resizes = 0;
+    q->failed = 0;
+    q->empty_pops = 0;
+
+    return 0;
+}
+
+struct queue *queue_init(size_t capacity) {
+    return queue_init_with_allocator(capacity, &malloc_allocator);
+}
+
+struct queue *queue_init_with_allocator(size_t capacity,
+                                        const struct allocator *a) {
+    (void) capacity; /* Chunks are allocated on demand. */
+
+    if (a == NULL) {
+        return NULL;
+    }
+
+    struct queue *q = a->alloc(a->ctx, sizeof(struct queue));
+    if (q == NULL) {
+        return NULL;
+    }
+
+    if (queue_setup(q, a)) {
+        a->release(a->ctx, q, sizeof(struct queue));
+        return NULL;
+    }
+
+    return q;
+}
+
+struct queue *queue_init_inline(struct queue_inline *storage) {
+    if (storage == NULL) {
+        return NULL;
+    }
+
+    struct queue *q = (struct queue *) &storage->header;
+    if (queue_setup(q, &malloc_allocator)) {
+        return NULL;
+    }
+    q->embedded = true;
+
+    return q;
+}
+
+struct queue *queue_init_mapped(size_t max_capacity, bool huge_pages) {
+    (void) huge_pages;
+
+    /* Chunks never copy items and the memory in use is bounded anyway. */
+    return queue_init_with_allocator(max_capacity, &malloc_allocator);
+}
+
+static void list_free(struct queue *q, struct list *l) {
+    struct chunk *c;
+    while ((c = list_take(l)) != NULL) {
+        q->alloc->release(q->alloc->ctx, c, sizeof(struct chunk));
+    }
+}
+
+void queue_cleanup(struct queue *q) {
+    if (q == NULL) {
+        return;
+    }
+
+    /* The I/O in flight must finish before its memory can go. */
+    for (struct chunk *c = q->writing.first; c != NULL; c = c->next) {
+        chunk_wait(c);
+    }
+    if (q->reading != NULL) {
+        chunk_wait(q->reading);
+        q->alloc->release(q->alloc->ctx, q->reading, sizeof(struct chunk));
+    }
+
+    if (q->back != q->front) {
+        q->alloc->release(q->alloc->ctx, q->back, sizeof(struct chunk));
+    }
+    q->alloc->release(q->alloc->ctx, q->front, sizeof(struct chunk));
+    list_free(q, &q->ready);
+    list_free(q, &q->writing);
+    list_free(q, &q->pool);
+
+    if (q->fd != -1) {
+        close(q->fd);
+    }
+    if (!q->embedded) {
+        q->alloc->release(q->alloc->ctx, q, sizeof(struct queue));
+    }
+}
+
+int queue_get_stats(const struct queue *q, struct container_stats *stats) {
+    if (q == NULL || stats == NULL) {
+        return 1;
+    }
+
+    stats->push = q->push;
+    stats->pop = q->pop;
+    stats->max = q->max;
+    stats->resizes = q->resizes;
+    stats->bytes_copied = 0; /* Spilling is I/O, not copying. */
+    stats->capacity = q->chunks * EXTMEM_CHUNK_ITEMS;
+    stats->peak_capacity = q->peak_chunks * EXTMEM_CHUNK_ITEMS;
+    stats->bytes = q->chunks * sizeof(struct chunk);
+    stats->peak_bytes = q->peak_chunks * sizeof(struct chunk);
+    stats->failed = q->failed;
+    stats->empty_pops = q->empty_pops;
+
+    return 0;
+}
+
+void queue_stats(const struct queue *q) {
+    if (q == NULL) {
+        return;
+    }
+
+    fprintf(stderr, "stats %zu %zu %zu\n", q->push, q->pop, q->max);
+}
+
+int queue_push(struct queue *q, int e) {
+    if (q == NULL) {
+        return 1;
+    }
+
+    if (q->head >= EXTMEM_CHUNK_ITEMS) {
+        struct chunk *c = chunk_get(q);
+        if (c == NULL) {
+            q->failed++;
+            return 1;
+        }
+
+        /* While @front is also @back it stays where it is. */
+        if (q->back != q->front && spill(q, q->back)) {
+            chunk_put(q, c);
+            q->failed++;
+            return 1;
+        }
+
+        q->back = c;
+        q->head = 0;
+        q->resizes++;
+    }
+
+    q->back->items[q->head++] = e;
+    q->length++;
+    q->push++;
+
+    if (q->length >= q->max) {
+        q->max = q->length;
+    }
+
+    return 0;
+}
+
+int queue_pop(struct queue *q) {
+    if (q == NULL) {
+        return -1;
+    }
+
+    if (q->length == 0) {
+        q->empty_pops++;
+        return -1;
+    }
+
+    /* Only left drained by a refill that failed earlier. */
+    if (q->tail >= EXTMEM_CHUNK_ITEMS && refill(q)) {
+        return -1;
+    }
+
+    int value = q->front->items[q->tail++];
+    q->length--;
+    q->pop++;
+
+    if (q->length == 0) {
+        /* The queue is empty, so @front is @back; start over in it. */
+        q->head = 0;
+        q->tail = 0;
+    } else if (q->tail >= EXTMEM_CHUNK_ITEMS) {
+        /* Move on right away, so queue_peek() finds the next item. */
+        refill(q);
+    }
+
+    return value;
+}
+
+int queue_peek(const struct queue *q) {
+    if (q == NULL) {
+        return -1;
+    }
+
+    if (q->length == 0 || q->tail >= EXTMEM_CHUNK_ITEMS) {
+        return -1;
+    }
+
+    return q->front->items[q->tail];
+}
+
+int queue_empty(const struct queue *q) {
+    if (q == NULL) {
+        return -1;
+    }
+
+    return q->length == 0;
+}
+
+size_t queue_size(const struct queue *q) {
+    if (q == NULL) {
+        return 1;
+    }
+
+    return q->length;
+}
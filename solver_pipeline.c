@@ -0,0 +1,275 @@
+/*
+ * solver_pipeline.c -- reading, solving and writing mazes on three threads
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "solver_pipeline.h"
+#include "solver_report.h"
+#include "solver_workspace.h"
+#include "spsc_queue.h"
+
+/* Number of times a stage retries a full or empty queue before it goes to
+ * sleep. */
+#define SPINS 64
+
+/**
+ * struct slot -- a maze on its way through the pipeline
+ * @m: the maze, or NULL if it could not be read
+ * @result: what @solve returned for @m
+ */
+struct slot {
+    struct maze *m;
+    int result;
+};
+
+/**
+ * struct channel -- a queue between two stages that they can sleep on
+ * @q: the lock-free queue the slot indices go through
+ * @lock: held to go to sleep on @changed and to wake a sleeper
+ * @changed: signalled after a push or pop while @waiting is nonzero
+ * @waiting: the number of stages asleep on @changed, or about to be
+ *
+ * Pushes and pops go through @q without a lock. Only a stage that finds
+ * @q full or empty for SPINS tries takes @lock, and the other stage only
+ * takes it when @waiting says that someone sleeps. The sleeper raises
+ * @waiting before it tries @q once more under @lock, and the other stage
+ * reads @waiting after its push or pop, so one of them always sees the
+ * other and no wakeup is lost.
+ */
+struct channel {
+    struct spsc_queue *q;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    atomic_int waiting;
+};
+
+/**
+ * struct state -- what the three threads share
+ * @p: the pipeline being run
+ * @slots: @p->depth slots, handed from thread to thread by index
+ * @free: slots the writer is done with, for the reader
+ * @read: slots holding a maze that was read, for the solver
+ * @solved: slots holding a solved maze, for the writer
+ * @end: the index that follows the last slot through the queues
+ * @status: 1 once a maze was not solved or could not be read, only
+ *          written by the writer
+ *
+ * Each queue has one producer and one consumer, so the slots need no lock:
+ * a slot belongs to whichever thread last popped its index.
+ */
+struct state {
+    struct solver_pipeline *p;
+    struct slot *slots;
+    struct channel free;
+    struct channel read;
+    struct channel solved;
+    int end;
+    int status;
+};
+
+/* Set up 'ch' with a queue of 'capacity' items. Return 0 if successful,
+ * 1 otherwise, in which case 'ch' must still be cleaned up. */
+static int channel_init(struct channel *ch, size_t capacity)
+{
+    ch->q = spsc_queue_init(capacity);
+    pthread_mutex_init(&ch->lock, NULL);
+    pthread_cond_init(&ch->changed, NULL);
+    atomic_init(&ch->waiting, 0);
+    return ch->q == NULL;
+}
+
+static void channel_cleanup(struct channel *ch)
+{
+    spsc_queue_cleanup(ch->q);
+    pthread_mutex_destroy(&ch->lock);
+    pthread_cond_destroy(&ch->changed);
+}
+
+/* Wake the other stage of 'ch' if it sleeps, after a push or pop. */
+static void wake(struct channel *ch)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&ch->waiting, memory_order_relaxed) > 0) {
+        pthread_mutex_lock(&ch->lock);
+        pthread_cond_broadcast(&ch->changed);
+        pthread_mutex_unlock(&ch->lock);
+    }
+}
+
+/* Push 'e' onto 'ch', waiting while it is full. */
+static void put(struct channel *ch, int e)
+{
+    for (int i = 0; i < SPINS; i++) {
+        if (spsc_queue_push(ch->q, e) == 0) {
+            wake(ch);
+            return;
+        }
+        sched_yield(); /* Queue full, give the next stage a turn. */
+    }
+
+    pthread_mutex_lock(&ch->lock);
+    atomic_fetch_add(&ch->waiting, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+    while (spsc_queue_push(ch->q, e)) {
+        pthread_cond_wait(&ch->changed, &ch->lock);
+    }
+    atomic_fetch_sub(&ch->waiting, 1);
+    pthread_mutex_unlock(&ch->lock);
+    wake(ch);
+}
+
+/* Pop an item from 'ch', waiting while it is empty. */
+static int take(struct channel *ch)
+{
+    int e;
+    for (int i = 0; i < SPINS; i++) {
+        if ((e = spsc_queue_pop(ch->q)) != -1) {
+            wake(ch);
+            return e;
+        }
+        sched_yield(); /* Queue empty, give the stage before a turn. */
+    }
+
+    pthread_mutex_lock(&ch->lock);
+    atomic_fetch_add(&ch->waiting, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+    while ((e = spsc_queue_pop(ch->q)) == -1) {
+        pthread_cond_wait(&ch->changed, &ch->lock);
+    }
+    atomic_fetch_sub(&ch->waiting, 1);
+    pthread_mutex_unlock(&ch->lock);
+    wake(ch);
+    return e;
+}
+
+static void *reader(void *arg)
+{
+    struct state *s = arg;
+    bool first = true;
+
+    while (first || solver_batch_next(stdin)) {
+        first = false;
+        int i = take(&s->free);
+        double start = solver_report_now();
+        s->slots[i].m = maze_read();
+        s->p->parse += solver_report_now() - start;
+        put(&s->read, i);
+        if (s->slots[i].m == NULL) {
+            break;
+        }
+        s->p->mazes++;
+    }
+
+    put(&s->read, s->end);
+    return NULL;
+}
+
+static void *writer(void *arg)
+{
+    struct state *s = arg;
+    int i;
+
+    while ((i = take(&s->solved)) != s->end) {
+        struct slot *slot = &s->slots[i];
+        if (slot->m == NULL) {
+            printf("Error reading maze\n");
+            s->status = 1;
+        } else {
+            double start = solver_report_now();
+            if (s->p->emit(s->p->ctx, slot->m, slot->result)) {
+                s->status = 1;
+            }
+            s->p->emit_time += solver_report_now() - start;
+            maze_cleanup(slot->m);
+        }
+        put(&s->free, i);
+    }
+
+    return NULL;
+}
+
+/* Solve every maze the reader hands on, on the calling thread. */
+static void solve_all(struct state *s)
+{
+    int i;
+
+    while ((i = take(&s->read)) != s->end) {
+        struct slot *slot = &s->slots[i];
+        if (slot->m != NULL) {
+            double start = solver_report_now();
+            slot->result = s->p->solve(s->p->ctx, slot->m);
+            s->p->solve_time += solver_report_now() - start;
+        }
+        put(&s->solved, i);
+    }
+
+    put(&s->solved, s->end);
+}
+
+int solver_pipeline_run(struct solver_pipeline *p)
+{
+    if (p == NULL || p->solve == NULL || p->emit == NULL || p->depth < 1) {
+        return 1;
+    }
+
+    struct state s;
+    s.p = p;
+    s.end = p->depth;
+    s.status = 0;
+    p->parse = 0;
+    p->solve_time = 0;
+    p->emit_time = 0;
+    p->mazes = 0;
+
+    /* Every queue can hold all slots and the end at once. */
+    size_t capacity = (size_t) p->depth + 1;
+    s.slots = calloc((size_t) p->depth, sizeof(struct slot));
+    int failed = channel_init(&s.free, capacity);
+    failed |= channel_init(&s.read, capacity);
+    failed |= channel_init(&s.solved, capacity);
+    int ret = 1;
+    if (s.slots == NULL || failed) {
+        goto out;
+    }
+    for (int i = 0; i < p->depth; i++) {
+        spsc_queue_push(s.free.q, i);
+    }
+
+    pthread_t write_thread;
+    if (pthread_create(&write_thread, NULL, writer, &s)) {
+        goto out;
+    }
+
+    /* Without a reader the batch is empty, and the solver and the writer
+     * still have to see its end. */
+    pthread_t read_thread;
+    bool reading = pthread_create(&read_thread, NULL, reader, &s) == 0;
+    if (!reading) {
+        put(&s.read, s.end);
+    }
+
+    solve_all(&s);
+    if (reading) {
+        pthread_join(read_thread, NULL);
+    }
+    pthread_join(write_thread, NULL);
+    ret = s.status || !reading;
+
+out:
+    channel_cleanup(&s.free);
+    channel_cleanup(&s.read);
+    channel_cleanup(&s.solved);
+    free(s.slots);
+    return ret;
+}
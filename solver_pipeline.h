@@ -0,0 +1,46 @@
+#ifndef _SOLVER_PIPELINE_H_
+#define _SOLVER_PIPELINE_H_
+
+/* A batch of mazes solved in a pipeline of three threads.
+ *
+ * A reader thread parses the next maze with maze_read() and a writer
+ * thread prints the result of the previous one while the calling thread
+ * solves the current one, so reading and writing overlap with solving.
+ * The threads hand mazes on through bounded single-producer/single-
+ * consumer queues, so at most @depth mazes are in memory at any time. The
+ * results come out in the order of the mazes on stdin. */
+
+#include <stdbool.h>
+
+#include "maze.h"
+
+/**
+ * struct solver_pipeline -- the stages of a pipelined batch
+ * @solve: solves a maze and returns its result, on the calling thread
+ * @emit: prints a maze and 'result' to stdout, on the writer thread, and
+ *        returns 0 if a path was found, 1 otherwise
+ * @ctx: passed to @solve and @emit
+ * @depth: the number of mazes that may be in the pipeline at once, at
+ *         least 3 to keep every stage busy
+ * @parse: set to the seconds the reader spent parsing
+ * @solve_time: set to the seconds spent in @solve
+ * @emit_time: set to the seconds spent in @emit
+ * @mazes: set to the number of mazes that were read
+ */
+struct solver_pipeline {
+    int (*solve)(void *ctx, struct maze *m);
+    int (*emit)(void *ctx, struct maze *m, int result);
+    void *ctx;
+    int depth;
+    double parse;
+    double solve_time;
+    double emit_time;
+    long mazes;
+};
+
+/* Solve every maze on stdin, separated by blank lines, with 'p'. A maze
+ * that cannot be read is reported as "Error reading maze" and ends the
+ * batch. Return 0 if every @emit returned 0, 1 otherwise. */
+int solver_pipeline_run(struct solver_pipeline *p);
+
+#endif
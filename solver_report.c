@@ -0,0 +1,84 @@
+/*
+ * solver_report.c -- timing and memory reports of the maze solvers
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include "solver_report.h"
+
+void solver_report_init(struct solver_report *report, const char *solver)
+{
+    if (report == NULL) {
+        return;
+    }
+
+    memset(report, 0, sizeof(*report));
+    report->solver = solver;
+    report->path_length = -1;
+}
+
+double solver_report_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+int solver_report_add(struct solver_report *report, const char *name,
+                      const struct container_stats *stats)
+{
+    if (report == NULL || name == NULL || stats == NULL
+        || report->n_containers == SOLVER_REPORT_MAX_CONTAINERS) {
+        return 1;
+    }
+
+    report->names[report->n_containers] = name;
+    report->containers[report->n_containers] = *stats;
+    report->n_containers++;
+    return 0;
+}
+
+int solver_report_print(FILE *fp, const struct solver_report *report)
+{
+    if (fp == NULL || report == NULL || report->solver == NULL) {
+        return 1;
+    }
+
+    /* ru_maxrss is in kilobytes on Linux. */
+    struct rusage usage;
+    long maxrss = 0;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        maxrss = usage.ru_maxrss;
+    }
+
+    size_t push = 0;
+    size_t max = 0;
+    size_t peak_bytes = 0;
+    for (size_t i = 0; i < report->n_containers; i++) {
+        push += report->containers[i].push;
+        max += report->containers[i].max;
+        peak_bytes += report->containers[i].peak_bytes;
+    }
+
+    fprintf(fp, "report solver=%s path=%d parse=%.6f solve=%.6f "
+                "render=%.6f maxrss_kb=%ld expanded=%ld extra_bytes=%zu "
+                "push=%zu max=%zu peak_bytes=%zu\n", report->solver,
+            report->path_length, report->parse, report->solve, report->render,
+            maxrss, report->expanded, report->extra_bytes, push, max,
+            peak_bytes);
+
+    for (size_t i = 0; i < report->n_containers; i++) {
+        container_stats_write_json(fp, report->names[i],
+                                   &report->containers[i]);
+    }
+
+    return ferror(fp) != 0;
+}
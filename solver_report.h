@@ -0,0 +1,58 @@
+#ifndef _SOLVER_REPORT_H_
+#define _SOLVER_REPORT_H_
+
+/* A machine-readable summary of one run of a maze solver, written to
+ * stderr when a solver is given -s. bench_solvers.sh collects these. */
+
+#include <stdio.h>
+
+#include "container_stats.h"
+
+/* Maximum number of containers whose statistics are reported. */
+#define SOLVER_REPORT_MAX_CONTAINERS 4
+
+/**
+ * struct solver_report -- what a run of a solver did
+ * @solver: the name of the solver
+ * @path_length: the length of the path found, or -1 if there is none
+ * @parse: seconds spent reading the maze
+ * @solve: seconds spent solving the maze
+ * @render: seconds spent printing the maze and writing the image
+ * @expanded: the number of cells whose neighbours were looked at
+ * @extra_bytes: the peak number of bytes the solver used besides the maze
+ * @n_containers: the number of entries used in @names and @containers
+ * @names: the names of the containers used by the solver
+ * @containers: the statistics of the containers, taken before cleanup
+ */
+struct solver_report {
+    const char *solver;
+    int path_length;
+    double parse;
+    double solve;
+    double render;
+    long expanded;
+    size_t extra_bytes;
+    size_t n_containers;
+    const char *names[SOLVER_REPORT_MAX_CONTAINERS];
+    struct container_stats containers[SOLVER_REPORT_MAX_CONTAINERS];
+};
+
+/* Clear 'report' for a run of 'solver'. */
+void solver_report_init(struct solver_report *report, const char *solver);
+
+/* Return the time in seconds on a monotonic clock. */
+double solver_report_now(void);
+
+/* Add the statistics of the container 'name' to 'report'. Return 0 if
+ * successful, 1 if 'report' is full. */
+int solver_report_add(struct solver_report *report, const char *name,
+                      const struct container_stats *stats);
+
+/* Write 'report' to 'fp' as one line of space separated key=value pairs
+ * starting with "report", followed by one JSON line per container. The
+ * line also holds the peak resident set size of the process and the totals
+ * of push, max and peak_bytes over all containers. Return 0 if successful,
+ * 1 otherwise. */
+int solver_report_print(FILE *fp, const struct solver_report *report);
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * solver_workspace.c -- memory kept by a solver between mazes
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+#include <stdlib.h>
+
+#include "solver_workspace.h"
+
+void solver_workspace_init(struct solver_workspace *w)
+{
+    if (w == NULL) {
+        return;
+    }
+
+    w->flat.n = 0;
+    w->flat.cells = NULL;
+    w->pred.n = 0;
+    w->pred.bits = NULL;
+    w->cells = NULL;
+    w->cells_size = 0;
+    w->pred_size = 0;
+    w->grows = 0;
+}
+
+/* Make 'w' hold at least 'cells_size' bytes of cells and the predecessors
+ * of a maze of size 'n'. Only a buffer that is too small is replaced, so
+ * neither size ever goes down. Return 0 if successful, 1 otherwise. */
+static int grow(struct solver_workspace *w, size_t cells_size, int n)
+{
+    size_t pred_size = maze_pred_bytes(n);
+    bool grown = false;
+
+    /* The old contents are of no use, so there is nothing to copy. */
+    if (cells_size > w->cells_size) {
+        free(w->cells);
+        w->cells = malloc(cells_size);
+        if (w->cells == NULL) {
+            solver_workspace_cleanup(w);
+            return 1;
+        }
+        w->cells_size = cells_size;
+        grown = true;
+    }
+    if (pred_size > w->pred_size) {
+        free(w->pred.bits);
+        w->pred.bits = malloc(pred_size);
+        if (w->pred.bits == NULL) {
+            solver_workspace_cleanup(w);
+            return 1;
+        }
+        w->pred_size = pred_size;
+        grown = true;
+    }
+    if (grown) {
+        w->grows++;
+    }
+
+    w->pred.n = n;
+    return 0;
+}
+
+int solver_workspace_load(struct solver_workspace *w, const struct maze *m)
+{
+    if (w == NULL || m == NULL) {
+        return 1;
+    }
+
+    int n = maze_size(m);
+    if (grow(w, maze_flat_bytes(n), n)) {
+        return 1;
+    }
+    return maze_flat_load_at(&w->flat, m, w->cells, w->cells_size);
+}
+
+int solver_workspace_reserve(struct solver_workspace *w,
+                             const struct maze *m)
+{
+    if (w == NULL || m == NULL) {
+        return 1;
+    }
+
+    /* Keep the cells of earlier loads, but do not ask for any. */
+    return grow(w, 0, maze_size(m));
+}
+
+void solver_workspace_cleanup(struct solver_workspace *w)
+{
+    if (w == NULL) {
+        return;
+    }
+
+    free(w->cells);
+    free(w->pred.bits);
+    size_t grows = w->grows;
+    solver_workspace_init(w);
+    w->grows = grows;
+}
+
+size_t solver_workspace_bytes(const struct solver_workspace *w)
+{
+    if (w == NULL) {
+        return 0;
+    }
+
+    return w->cells_size + w->pred_size;
+}
+
+bool solver_batch_next(FILE *fp)
+{
+    if (fp == NULL) {
+        return false;
+    }
+
+    int ch;
+    while ((ch = getc(fp)) == '\n') {
+        continue;
+    }
+    if (ch == EOF) {
+        return false;
+    }
+
+    ungetc(ch, fp);
+    return true;
+}
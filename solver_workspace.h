@@ -0,0 +1,61 @@
+#ifndef _SOLVER_WORKSPACE_H_
+#define _SOLVER_WORKSPACE_H_
+
+/* The memory a solver needs for each cell of a maze, kept from one solve
+ * to the next.
+ *
+ * A solver that loads its flat copy of the maze and its predecessors into
+ * a workspace only allocates when a maze is larger than any before it.
+ * After that the workspace stays at its high-water mark, so solving a
+ * stream of mazes of similar size makes no allocator calls at all. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "maze_neighbors.h"
+#include "maze_pred.h"
+
+/**
+ * struct solver_workspace -- per-cell memory for a solver
+ * @flat: the flat copy of the last maze loaded, which the solver marks
+ * @pred: the direction each cell of that maze was reached in
+ * @cells: the memory @flat lives in
+ * @cells_size: the number of bytes at @cells
+ * @pred_size: the number of bytes at @pred.bits
+ * @grows: the number of times the memory had to grow
+ */
+struct solver_workspace {
+    struct maze_flat flat;
+    struct maze_pred pred;
+    char *cells;
+    size_t cells_size;
+    size_t pred_size;
+    size_t grows;
+};
+
+/* Set up 'w' as an empty workspace, which allocates nothing yet. */
+void solver_workspace_init(struct solver_workspace *w);
+
+/* Load a flat copy of 'm' into 'w' and size its predecessors for 'm',
+ * growing the memory of 'w' if 'm' is larger than any maze before it.
+ * Return 0 if successful, 1 otherwise. */
+int solver_workspace_load(struct solver_workspace *w, const struct maze *m);
+
+/* Size the predecessors of 'w' for 'm' like solver_workspace_load(), but
+ * without a flat copy, for a solver that reads and marks 'm' itself.
+ * Return 0 if successful, 1 otherwise. */
+int solver_workspace_reserve(struct solver_workspace *w,
+                             const struct maze *m);
+
+/* Free all memory of 'w' and leave it empty. */
+void solver_workspace_cleanup(struct solver_workspace *w);
+
+/* Return the number of bytes 'w' holds. */
+size_t solver_workspace_bytes(const struct solver_workspace *w);
+
+/* Skip the blank lines that separate mazes in a batch on 'fp'. Return true
+ * if another maze follows, false at the end of the file. */
+bool solver_batch_next(FILE *fp);
+
+#endif
@@ -0,0 +1,195 @@
+/*
+ * spsc_queue.c -- a lock-free single-producer/single-consumer ring queue
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "spsc_queue.h"
+
+#define CACHE_LINE 64
+
+/**
+ * struct spsc_queue -- the struct where the queue is stored
+ * @head: the number of items ever pushed, written by the producer only
+ * @tail_cache: the producer's last seen value of @tail
+ * @push: the number of times the queue has been pushed to
+ * @max: the maximum number of items the producer has seen in the queue
+ * @tail: the number of items ever popped, written by the consumer only
+ * @head_cache: the consumer's last seen value of @head
+ * @pop: the number of times the queue has been popped
+ * @mask: the capacity minus one, the capacity is a power of two
+ * @data: a pointer to the items in the queue
+ *
+ * @head and @tail only ever increase and are reduced to an index in @data
+ * with @mask. Each side keeps its own index and counters on a separate
+ * cache line, so the producer and the consumer never write to the same
+ * line. Each side also remembers the last value of the other side's index
+ * and only reloads it when the cached value says the queue is full (or
+ * empty), which keeps the cache line of the other side from bouncing
+ * between cores on every operation.
+ *
+ * The counters are atomic only so that spsc_queue_stats() may be called
+ * from the other thread; they are updated with relaxed stores.
+ */
+struct spsc_queue {
+    _Alignas(CACHE_LINE) atomic_size_t head;
+    size_t tail_cache;
+    atomic_size_t push;
+    atomic_size_t max;
+
+    _Alignas(CACHE_LINE) atomic_size_t tail;
+    size_t head_cache;
+    atomic_size_t pop;
+
+    _Alignas(CACHE_LINE) size_t mask;
+    int *data;
+};
+
+struct spsc_queue *spsc_queue_init(size_t capacity) {
+    /* Beyond this the rounding up below would overflow. */
+    if (capacity > SIZE_MAX / 2 + 1) {
+        return NULL;
+    }
+
+    size_t size = 1;
+    while (size < capacity) {
+        size *= 2;
+    }
+    if (size > SIZE_MAX / sizeof(int)) {
+        return NULL;
+    }
+
+    struct spsc_queue *q = aligned_alloc(CACHE_LINE, sizeof(struct spsc_queue));
+    if (q == NULL) {
+        return NULL;
+    }
+
+    q->data = malloc(size * sizeof(int));
+    if (q->data == NULL) {
+        free(q);
+        return NULL;
+    }
+
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->push, 0);
+    atomic_init(&q->pop, 0);
+    atomic_init(&q->max, 0);
+    q->tail_cache = 0;
+    q->head_cache = 0;
+    q->mask = size - 1;
+
+    return q;
+}
+
+void spsc_queue_cleanup(struct spsc_queue *q) {
+    if (q == NULL) {
+        return;
+    }
+
+    free(q->data);
+    free(q);
+}
+
+void spsc_queue_stats(const struct spsc_queue *q) {
+    if (q == NULL) {
+        return;
+    }
+
+    fprintf(stderr, "stats %zu %zu %zu\n",
+            atomic_load_explicit(&q->push, memory_order_relaxed),
+            atomic_load_explicit(&q->pop, memory_order_relaxed),
+            atomic_load_explicit(&q->max, memory_order_relaxed));
+}
+
+int spsc_queue_push(struct spsc_queue *q, int e) {
+    if (q == NULL) {
+        return 1;
+    }
+
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+
+    if (head - q->tail_cache > q->mask) {
+        q->tail_cache = atomic_load_explicit(&q->tail, memory_order_acquire);
+        if (head - q->tail_cache > q->mask) {
+            return 1;
+        }
+    }
+
+    q->data[head & q->mask] = e;
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+
+    size_t pushes = atomic_load_explicit(&q->push, memory_order_relaxed);
+    atomic_store_explicit(&q->push, pushes + 1, memory_order_relaxed);
+
+    /* This is an upper bound, since the consumer may have popped items
+     * since @tail_cache was loaded. */
+    size_t length = head + 1 - q->tail_cache;
+    if (length > atomic_load_explicit(&q->max, memory_order_relaxed)) {
+        atomic_store_explicit(&q->max, length, memory_order_relaxed);
+    }
+
+    return 0;
+}
+
+int spsc_queue_pop(struct spsc_queue *q) {
+    if (q == NULL) {
+        return -1;
+    }
+
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+
+    if (tail == q->head_cache) {
+        q->head_cache = atomic_load_explicit(&q->head, memory_order_acquire);
+        if (tail == q->head_cache) {
+            return -1;
+        }
+    }
+
+    int value = q->data[tail & q->mask];
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+
+    size_t pops = atomic_load_explicit(&q->pop, memory_order_relaxed);
+    atomic_store_explicit(&q->pop, pops + 1, memory_order_relaxed);
+
+    return value;
+}
+
+int spsc_queue_peek(const struct spsc_queue *q) {
+    if (q == NULL) {
+        return -1;
+    }
+
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    if (tail == atomic_load_explicit(&q->head, memory_order_acquire)) {
+        return -1;
+    }
+
+    return q->data[tail & q->mask];
+}
+
+int spsc_queue_empty(const struct spsc_queue *q) {
+    if (q == NULL) {
+        return -1;
+    }
+
+    return spsc_queue_size(q) == 0;
+}
+
+size_t spsc_queue_size(const struct spsc_queue *q) {
+    if (q == NULL) {
+        return 1;
+    }
+
+    /* Load @tail first, so that @head can never be behind it. */
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    size_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+
+    return head - tail;
+}
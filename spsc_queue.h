@@ -0,0 +1,46 @@
+#ifndef _SPSC_QUEUE_H_
+#define _SPSC_QUEUE_H_
+
+#include <stddef.h>
+
+/* Handle to a single-producer/single-consumer queue.
+ *
+ * The queue can be shared between exactly two threads: one thread may call
+ * spsc_queue_push(), the other may call spsc_queue_pop() and
+ * spsc_queue_peek(). spsc_queue_size(), spsc_queue_empty() and
+ * spsc_queue_stats() may be called from either thread. None of the
+ * operations block or take a lock. */
+struct spsc_queue;
+
+/* Return a pointer to a queue that can hold at least 'capacity' items if
+ * successful, otherwise return NULL. The capacity is rounded up to a power
+ * of two and the queue does not grow. */
+struct spsc_queue *spsc_queue_init(size_t capacity);
+
+/* Cleanup queue. Neither thread may use the queue anymore. */
+void spsc_queue_cleanup(struct spsc_queue *q);
+
+/* Print queue statistics to stderr.
+ * The format is: 'stats' num_of_pushes num_of_pops max_elements */
+void spsc_queue_stats(const struct spsc_queue *q);
+
+/* Push item to the end of the queue. Producer only.
+ * Return 0 if successful, 1 if the queue is full or on error. */
+int spsc_queue_push(struct spsc_queue *q, int e);
+
+/* Remove the first item from queue and return it. Consumer only.
+ * Return the first item if successful, -1 otherwise. */
+int spsc_queue_pop(struct spsc_queue *q);
+
+/* Return the first item from queue. Leave queue unchanged. Consumer only.
+ * Return the first item if successful, -1 otherwise. */
+int spsc_queue_peek(const struct spsc_queue *q);
+
+/* Return 1 if queue is empty, 0 if the queue contains any elements and
+ * return -1 if the operation fails. */
+int spsc_queue_empty(const struct spsc_queue *q);
+
+/* Return the number of elements stored in the queue. */
+size_t spsc_queue_size(const struct spsc_queue *q);
+
+#endif
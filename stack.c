@@ -5,10 +5,14 @@
  * Universiteit van Amsterdam
  */
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-#include "stack.h"
+#include "stack_ext.h"
+#include "vmem.h"
 
 /**
  * struct stack -- the structure where the stack is stored.
@@ -18,10 +22,28 @@
  * @pop: the number of times the stack has been popped
  * @max: the maximum @length that has been reached
  * @data: a pointer to the items on the stack
+ * @alloc: the allocator the structure and @data come from
+ * @inline_data: the items array of the struct stack_inline, or NULL
+ * @embedded: true if the structure lives in a struct stack_inline
+ * @huge_pages: whether the mapping @data lives in uses huge pages
+ * @reserved: the size in bytes of the mapping @data lives in, or 0
+ * @resizes: the number of times @data grew
+ * @copied: the number of bytes copied while @data grew
+ * @peak_capacity: the maximum @capacity that has been reached
+ * @failed: the number of pushes that failed
+ * @empty_pops: the number of pops on an empty stack
  *
  * This is a straightforward implementation of a stack. Since the stack
  * may be resized, we cannot store the items inside the structure itself,
  * and instead we have to store the items in another region in memory.
+ *
+ * A stack made by stack_init_inline() starts out with @data pointing at
+ * @inline_data. Neither the structure nor @inline_data may be given back to
+ * @alloc, and the first resize has to copy the items instead of resizing.
+ *
+ * A stack made by stack_init_mapped() has @data in a region from
+ * vmem_reserve() that already spans the maximum capacity. It never resizes,
+ * the kernel commits a page the first time a push reaches it.
  */
 struct stack {
     size_t length;
@@ -30,25 +52,101 @@ struct stack {
     size_t pop;
     size_t max;
     int *data;
+    const struct allocator *alloc;
+    int *inline_data;
+    bool embedded;
+    bool huge_pages;
+    size_t reserved;
+    size_t resizes;
+    size_t copied;
+    size_t peak_capacity;
+    size_t failed;
+    size_t empty_pops;
 };
 
+_Static_assert(sizeof(struct stack) <= sizeof(((struct stack_inline *) 0)->header),
+               "struct stack does not fit in struct stack_inline");
+
+/* Set up the fields of a new, empty stack. */
+static void stack_setup(struct stack *s, int *data, size_t capacity,
+                        const struct allocator *a) {
+    s->data = data;
+    s->alloc = a;
+    s->inline_data = NULL;
+    s->embedded = false;
+    s->huge_pages = false;
+    s->reserved = 0;
+    s->length = 0;
+    s->capacity = capacity;
+    s->push = 0;
+    s->pop = 0;
+    s->max = 0;
+    s->resizes = 0;
+    s->copied = 0;
+    s->peak_capacity = capacity;
+    s->failed = 0;
+    s->empty_pops = 0;
+}
+
 struct stack *stack_init(size_t capacity) {
+    return stack_init_with_allocator(capacity, &malloc_allocator);
+}
+
+struct stack *stack_init_with_allocator(size_t capacity,
+                                        const struct allocator *a) {
+    if (a == NULL) {
+        return NULL;
+    }
+
+    struct stack *s = a->alloc(a->ctx, sizeof(struct stack));
+    if (s == NULL) {
+        return NULL;
+    }
+
+    int *data = a->alloc(a->ctx, capacity * sizeof(int));
+    if (data == NULL) {
+        a->release(a->ctx, s, sizeof(struct stack));
+        return NULL;
+    }
+
+    stack_setup(s, data, capacity, a);
+
+    return s;
+}
+
+struct stack *stack_init_inline(struct stack_inline *storage) {
+    if (storage == NULL) {
+        return NULL;
+    }
+
+    struct stack *s = (struct stack *) &storage->header;
+    stack_setup(s, storage->items, STACK_INLINE_CAPACITY, &malloc_allocator);
+    s->inline_data = storage->items;
+    s->embedded = true;
+
+    return s;
+}
+
+struct stack *stack_init_mapped(size_t max_capacity, bool huge_pages) {
+    if (max_capacity == 0 || max_capacity > SIZE_MAX / sizeof(int)) {
+        return NULL;
+    }
+
     struct stack *s = malloc(sizeof(struct stack));
     if (s == NULL) {
         return NULL;
     }
 
-    s->data = malloc(capacity * sizeof(int));
-    if (s->data == NULL) {
+    size_t reserved = max_capacity * sizeof(int);
+    int *data = vmem_reserve(reserved, huge_pages);
+    if (data == NULL) {
         free(s);
         return NULL;
     }
 
-    s->length = 0;
-    s->capacity = capacity;
-    s->push = 0;
-    s->pop = 0;
-    s->max = 0;
+    stack_setup(s, data, max_capacity, &malloc_allocator);
+    s->reserved = reserved;
+    s->huge_pages = huge_pages;
 
     return s;
 }
@@ -58,8 +156,34 @@ void stack_cleanup(struct stack *s) {
         return;
     }
 
-    free(s->data);
-    free(s);
+    if (s->reserved) {
+        vmem_release(s->data, s->reserved, s->huge_pages);
+    } else if (s->data != s->inline_data) {
+        s->alloc->release(s->alloc->ctx, s->data, s->capacity * sizeof(int));
+    }
+    if (!s->embedded) {
+        s->alloc->release(s->alloc->ctx, s, sizeof(struct stack));
+    }
+}
+
+int stack_get_stats(const struct stack *s, struct container_stats *stats) {
+    if (s == NULL || stats == NULL) {
+        return 1;
+    }
+
+    stats->push = s->push;
+    stats->pop = s->pop;
+    stats->max = s->max;
+    stats->resizes = s->resizes;
+    stats->bytes_copied = s->copied;
+    stats->capacity = s->capacity;
+    stats->peak_capacity = s->peak_capacity;
+    stats->bytes = s->capacity * sizeof(int);
+    stats->peak_bytes = s->peak_capacity * sizeof(int);
+    stats->failed = s->failed;
+    stats->empty_pops = s->empty_pops;
+
+    return 0;
 }
 
 void stack_stats(const struct stack *s) {
@@ -76,14 +200,43 @@ int stack_push(struct stack *s, int c) {
     }
 
     if (s->length >= s->capacity) {
-        size_t new_capacity = s->capacity * 2 + 1;
-        int *new = realloc(s->data, new_capacity * sizeof(int));
-        if (new == NULL) {
+        if (s->reserved) {
+            /* The whole reservation is in use. */
+            s->failed++;
             return 1;
         }
 
+        size_t new_capacity = s->capacity * 2 + 1;
+        uintptr_t old = (uintptr_t) s->data;
+        int *new;
+        if (s->data == s->inline_data) {
+            /* The inline items can't be resized, so spill to the heap. */
+            new = s->alloc->alloc(s->alloc->ctx, new_capacity * sizeof(int));
+            if (new == NULL) {
+                s->failed++;
+                return 1;
+            }
+            memcpy(new, s->data, s->length * sizeof(int));
+        } else {
+            new = s->alloc->resize(s->alloc->ctx, s->data,
+                                   s->capacity * sizeof(int),
+                                   new_capacity * sizeof(int));
+            if (new == NULL) {
+                s->failed++;
+                return 1;
+            }
+        }
+
+        /* A resize that moved the items had to copy them. */
+        if ((uintptr_t) new != old) {
+            s->copied += s->length * sizeof(int);
+        }
+        s->resizes++;
         s->capacity = new_capacity;
         s->data = new;
+        if (new_capacity > s->peak_capacity) {
+            s->peak_capacity = new_capacity;
+        }
     }
 
     s->data[s->length++] = c;
@@ -102,6 +255,7 @@ int stack_pop(struct stack *s) {
     }
 
     if (s->length == 0) {
+        s->empty_pops++;
         return -1;
     }
 
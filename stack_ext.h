@@ -0,0 +1,53 @@
+#ifndef _STACK_EXT_H_
+#define _STACK_EXT_H_
+
+/* Extensions to the interface in stack.h. */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "allocator.h"
+#include "container_stats.h"
+#include "stack.h"
+
+/* Number of items that fit in a struct stack_inline before the stack has
+ * to move its items to the heap. */
+#define STACK_INLINE_CAPACITY 64
+
+/* Memory for a stack and its first STACK_INLINE_CAPACITY items, to be
+ * placed wherever the caller likes, for example in a local variable. The
+ * fields are private to stack.c. */
+struct stack_inline {
+    union {
+        max_align_t align;
+        unsigned char bytes[256];
+    } header;
+    int items[STACK_INLINE_CAPACITY];
+};
+
+/* Return a pointer to a stack data structure with an initial capacity of
+ * 'capacity' if successful, otherwise return NULL. The stack structure and
+ * its items are allocated with 'a', which must outlive the stack. */
+struct stack *stack_init_with_allocator(size_t capacity,
+                                        const struct allocator *a);
+
+/* Return a pointer to a stack that lives in 'storage' and stores its first
+ * STACK_INLINE_CAPACITY items there as well, or NULL if 'storage' is NULL.
+ * This never allocates memory. Once the stack outgrows 'storage' its items
+ * move to memory from malloc(). stack_cleanup() must still be called, but
+ * it leaves 'storage' itself alone. */
+struct stack *stack_init_inline(struct stack_inline *storage);
+
+/* Return a pointer to a stack that can hold up to 'max_capacity' items, or
+ * NULL if an error occured. Address space for all items is reserved up
+ * front with mmap() and memory is only committed as the stack reaches it,
+ * so the items are never copied. If 'huge_pages' is true the items are
+ * placed on transparent huge pages where the system allows it. Pushing
+ * onto a full stack returns 1. */
+struct stack *stack_init_mapped(size_t max_capacity, bool huge_pages);
+
+/* Fill in 'stats' with the statistics of 's'. Return 0 if successful, 1
+ * otherwise. */
+int stack_get_stats(const struct stack *s, struct container_stats *stats);
+
+#endif
@@ -0,0 +1,149 @@
+/*
+ * terrain.c -- reading and printing weighted mazes
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+// Needed for getline()
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "terrain.h"
+
+#define START 'S'
+#define FINISH 'D'
+
+int terrain_cost(char ch)
+{
+    if (ch == WALL) {
+        return TERRAIN_WALL;
+    }
+    if (ch >= '0' && ch <= '9') {
+        return ch - '0';
+    }
+    return 1;
+}
+
+/* Store row 'r' of 'line' in 't'. Return 0 if successful, 1 if it holds
+ * a second start or destination. */
+static int store_row(struct terrain *t, int r, const char *line)
+{
+    for (int c = 0; c < t->n; c++) {
+        int index = r * t->n + c;
+        char ch = line[c];
+
+        if (ch == START || ch == FINISH) {
+            int *at = ch == START ? &t->start : &t->destination;
+            if (*at != -1) {
+                return 1;
+            }
+            *at = index;
+            ch = FLOOR;
+        }
+
+        /* The border is inaccessible, as in maze.h. */
+        int cost = terrain_cost(ch);
+        if (r == 0 || c == 0 || r == t->n - 1 || c == t->n - 1) {
+            cost = TERRAIN_WALL;
+        }
+        t->cells[index] = ch;
+        t->cost[index] = (unsigned char) cost;
+        if (cost != TERRAIN_WALL && cost > t->max_cost) {
+            t->max_cost = cost;
+        }
+    }
+    return 0;
+}
+
+struct terrain *terrain_read(FILE *fp)
+{
+    if (fp == NULL) {
+        return NULL;
+    }
+
+    char *buf = NULL;
+    size_t bufsize = 0;
+
+    /* The first line gives the number of columns. */
+    ssize_t len = getline(&buf, &bufsize, fp);
+    if (len < 2 || buf[len - 1] != '\n') {
+        free(buf);
+        return NULL;
+    }
+
+    struct terrain *t = malloc(sizeof(*t));
+    if (t == NULL) {
+        free(buf);
+        return NULL;
+    }
+    t->n = (int) len - 1;
+    t->start = -1;
+    t->destination = -1;
+    t->max_cost = 1;
+    t->cost = malloc((size_t) t->n * (size_t) t->n);
+    t->cells = malloc((size_t) t->n * (size_t) t->n);
+    if (t->cost == NULL || t->cells == NULL) {
+        terrain_cleanup(t);
+        free(buf);
+        return NULL;
+    }
+
+    int r = 0;
+    do {
+        if (r == t->n || len != t->n + 1 || store_row(t, r, buf)) {
+            terrain_cleanup(t);
+            free(buf);
+            return NULL;
+        }
+        r++;
+    } while ((len = getline(&buf, &bufsize, fp)) != -1);
+    free(buf);
+
+    if (r < t->n || t->start == -1 || t->destination == -1) {
+        terrain_cleanup(t);
+        return NULL;
+    }
+    return t;
+}
+
+void terrain_cleanup(struct terrain *t)
+{
+    if (t == NULL) {
+        return;
+    }
+
+    free(t->cost);
+    free(t->cells);
+    free(t);
+}
+
+int terrain_print(const struct terrain *t, FILE *fp)
+{
+    if (t == NULL || fp == NULL) {
+        return 1;
+    }
+
+    char *row = malloc((size_t) t->n + 1);
+    if (row == NULL) {
+        return 1;
+    }
+
+    for (int r = 0; r < t->n; r++) {
+        memcpy(row, t->cells + (size_t) r * (size_t) t->n, (size_t) t->n);
+        if (t->start / t->n == r) {
+            row[t->start % t->n] = START;
+        }
+        if (t->destination / t->n == r) {
+            row[t->destination % t->n] = FINISH;
+        }
+        row[t->n] = '\n';
+        fwrite(row, 1, (size_t) t->n + 1, fp);
+    }
+    fputc('\n', fp);
+
+    free(row);
+    return ferror(fp) != 0;
+}
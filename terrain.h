@@ -0,0 +1,59 @@
+#ifndef _TERRAIN_H_
+#define _TERRAIN_H_
+
+/* Weighted mazes, in which entering a cell has a small integer cost.
+ *
+ * The file format is that of maze_read() with one addition: a digit '0' to
+ * '9' is a floor cell that costs that much to enter. A cell that costs
+ * nothing stands for a conveyor or a teleport pad. maze.h stores such
+ * cells as plain FLOOR, so a terrain keeps its own copy of the grid. Every
+ * other cell that is not a WALL costs 1, including the start and the
+ * destination. As in maze.h the border cannot be entered, whatever it
+ * holds. */
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "maze.h"
+
+/* Cost of a WALL, which cannot be entered. */
+#define TERRAIN_WALL UCHAR_MAX
+
+/* Highest cost of a cell. */
+#define TERRAIN_MAX_COST 9
+
+/**
+ * struct terrain -- a weighted maze
+ * @n: the number of rows and columns
+ * @start: the index of the start, as by maze_index()
+ * @destination: the index of the destination
+ * @max_cost: the highest cost of any cell that is not a wall
+ * @cost: the cost of entering each cell, TERRAIN_WALL for walls
+ * @cells: the characters of the cells, which solvers may mark with PATH or
+ *         VISITED; start and destination hold the character of their floor
+ */
+struct terrain {
+    int n;
+    int start;
+    int destination;
+    int max_cost;
+    unsigned char *cost;
+    char *cells;
+};
+
+/* Read a square weighted maze from 'fp'. Return a pointer to the terrain
+ * or NULL if an error occured. */
+struct terrain *terrain_read(FILE *fp);
+
+/* Free all memory associated with 't'. */
+void terrain_cleanup(struct terrain *t);
+
+/* Return the cost of entering a cell shown as 'ch'. */
+int terrain_cost(char ch);
+
+/* Write 't' to 'fp' like maze_print(), with the start and destination
+ * shown as 'S' and 'D'. Return 0 if successful, 1 otherwise. */
+int terrain_print(const struct terrain *t, FILE *fp);
+
+#endif
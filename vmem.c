@@ -0,0 +1,94 @@
+/*
+ * vmem.c -- reserving and releasing large regions of virtual memory
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+// Needed for MAP_ANONYMOUS, MAP_NORESERVE and madvise()
+#define _DEFAULT_SOURCE
+
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "vmem.h"
+
+/* The size of a transparent huge page on x86-64 and most arm64 kernels. */
+#define HUGE_PAGE_SIZE ((size_t) 2 << 20)
+
+size_t vmem_page_size(void) {
+    static size_t page_size = 0;
+
+    if (page_size == 0) {
+        long size = sysconf(_SC_PAGESIZE);
+        page_size = size > 0 ? (size_t) size : 4096;
+    }
+
+    return page_size;
+}
+
+/* Round 'size' up to a multiple of 'align', which is a power of two. */
+static size_t round_up(size_t size, size_t align) {
+    return (size + align - 1) & ~(align - 1);
+}
+
+void *vmem_reserve(size_t size, bool huge_pages) {
+    if (size == 0) {
+        return NULL;
+    }
+
+    size_t align = huge_pages ? HUGE_PAGE_SIZE : vmem_page_size();
+    size = round_up(size, align);
+
+    /* Map one alignment unit extra, so an aligned start can be cut out. */
+    size_t mapped = huge_pages ? size + align : size;
+    unsigned char *base = mmap(NULL, mapped, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                               -1, 0);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+
+    if (!huge_pages) {
+        return base;
+    }
+
+    unsigned char *start = (unsigned char *) round_up((uintptr_t) base, align);
+    size_t before = (size_t) (start - base);
+    size_t after = mapped - before - size;
+    if (before > 0) {
+        munmap(base, before);
+    }
+    if (after > 0) {
+        munmap(start + size, after);
+    }
+
+#ifdef MADV_HUGEPAGE
+    /* Only a hint, the region works fine without huge pages. */
+    madvise(start, size, MADV_HUGEPAGE);
+#endif
+
+    return start;
+}
+
+void vmem_release(void *ptr, size_t size, bool huge_pages) {
+    if (ptr == NULL || size == 0) {
+        return;
+    }
+
+    /* munmap() only rounds up to a whole page, so the rest of a huge page
+     * vmem_reserve() rounded up to would stay mapped. */
+    size_t align = huge_pages ? HUGE_PAGE_SIZE : vmem_page_size();
+    munmap(ptr, round_up(size, align));
+}
+
+void vmem_discard(void *ptr, size_t size) {
+    size_t page = vmem_page_size();
+    uintptr_t start = round_up((uintptr_t) ptr, page);
+    uintptr_t end = ((uintptr_t) ptr + size) & ~(page - 1);
+
+    if (end > start) {
+        madvise((void *) start, end - start, MADV_DONTNEED);
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef _VMEM_H_
+#define _VMEM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Reserve 'size' bytes of zeroed virtual memory. Physical pages are only
+ * committed by the kernel when they are first touched. If 'huge_pages' is
+ * true the region is aligned to and marked for transparent huge pages.
+ * Return a pointer to the region or NULL if an error occured. */
+void *vmem_reserve(size_t size, bool huge_pages);
+
+/* Unmap a region returned by vmem_reserve() for 'size' bytes, with the
+ * same 'huge_pages' it was reserved with. */
+void vmem_release(void *ptr, size_t size, bool huge_pages);
+
+/* Give the physical pages that lie entirely within the 'size' bytes at
+ * 'ptr' back to the kernel. The range stays reserved and reads as zeros
+ * the next time it is touched. */
+void vmem_discard(void *ptr, size_t size);
+
+/* Return the size of a page in bytes. */
+size_t vmem_page_size(void);
+
+#endif
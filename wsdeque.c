@@ -0,0 +1,300 @@
+/*
+ * wsdeque.c -- a Chase-Lev work-stealing deque
+ *
+ * Artsiom Dzenisiuk 16141253
+ * Universiteit van Amsterdam
+ */
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "wsdeque.h"
+
+#define CACHE_LINE 64
+
+/**
+ * struct ring -- a circular array of items
+ * @older: the ring that was replaced by this one
+ * @mask: the capacity minus one, the capacity is a power of two
+ * @items: the items
+ */
+struct ring {
+    struct ring *older;
+    size_t mask;
+    atomic_int items[];
+};
+
+/**
+ * struct wsdeque -- the structure where the deque is stored
+ * @top: the position of the oldest item, moved forward by thieves
+ * @bottom: the position after the newest item, only changed by the owner
+ * @ring: the ring that currently holds the items
+ * @push: the number of times the owner pushed an item
+ * @pop: the number of times the owner popped an item
+ * @max: the maximum number of items the owner has seen in the deque
+ * @resizes: the number of times the ring was replaced by a bigger one
+ * @copied: the number of bytes of items copied into bigger rings
+ * @bytes: the number of bytes of items in @ring and the older rings
+ * @failed: the number of pushes that failed
+ * @empty_pops: the number of pops by the owner that found nothing
+ * @steal: the number of items that were stolen
+ *
+ * This is the deque of Chase and Lev, with the memory orderings of Lê et
+ * al. The owner works at @bottom without any atomic read-modify-write,
+ * except when it pops the very last item and might race a thief for it.
+ * Thieves claim the item at @top with a compare-and-swap.
+ *
+ * When the ring is full the owner copies the items to a ring twice the
+ * size. A thief may still be reading the old ring at that moment, so old
+ * rings are kept in the @older list until wsdeque_cleanup().
+ */
+struct wsdeque {
+    _Alignas(CACHE_LINE) atomic_llong top;
+    atomic_size_t steal;
+    _Alignas(CACHE_LINE) atomic_llong bottom;
+    _Atomic(struct ring *) ring;
+    size_t push;
+    size_t pop;
+    size_t max;
+    size_t resizes;
+    size_t copied;
+    size_t bytes;
+    size_t failed;
+    size_t empty_pops;
+};
+
+static struct ring *ring_init(size_t size) {
+    struct ring *r = malloc(sizeof(struct ring) + size * sizeof(atomic_int));
+    if (r == NULL) {
+        return NULL;
+    }
+
+    r->older = NULL;
+    r->mask = size - 1;
+    return r;
+}
+
+static int ring_get(const struct ring *r, long long i) {
+    return atomic_load_explicit(&r->items[(size_t) i & r->mask],
+                                memory_order_relaxed);
+}
+
+static void ring_put(struct ring *r, long long i, int e) {
+    atomic_store_explicit(&r->items[(size_t) i & r->mask], e,
+                          memory_order_relaxed);
+}
+
+struct wsdeque *wsdeque_init(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) {
+        size *= 2;
+    }
+
+    struct wsdeque *d = aligned_alloc(CACHE_LINE, sizeof(struct wsdeque));
+    if (d == NULL) {
+        return NULL;
+    }
+
+    struct ring *r = ring_init(size);
+    if (r == NULL) {
+        free(d);
+        return NULL;
+    }
+
+    atomic_init(&d->top, 0);
+    atomic_init(&d->bottom, 0);
+    atomic_init(&d->ring, r);
+    atomic_init(&d->steal, 0);
+    d->push = 0;
+    d->pop = 0;
+    d->max = 0;
+    d->resizes = 0;
+    d->copied = 0;
+    d->bytes = size * sizeof(atomic_int);
+    d->failed = 0;
+    d->empty_pops = 0;
+
+    return d;
+}
+
+void wsdeque_cleanup(struct wsdeque *d) {
+    if (d == NULL) {
+        return;
+    }
+
+    struct ring *r = atomic_load_explicit(&d->ring, memory_order_relaxed);
+    while (r != NULL) {
+        struct ring *older = r->older;
+        free(r);
+        r = older;
+    }
+    free(d);
+}
+
+void wsdeque_stats(const struct wsdeque *d) {
+    if (d == NULL) {
+        return;
+    }
+
+    fprintf(stderr, "stats %zu %zu %zu\n", d->push,
+            d->pop + atomic_load_explicit(&d->steal, memory_order_relaxed),
+            d->max);
+}
+
+int wsdeque_get_stats(const struct wsdeque *d, struct container_stats *stats) {
+    if (d == NULL || stats == NULL) {
+        return 1;
+    }
+
+    /* Rings only grow and the old ones are kept, so the current values are
+     * also the peaks. */
+    struct ring *r = atomic_load_explicit(&d->ring, memory_order_relaxed);
+    stats->push = d->push;
+    stats->pop = d->pop + atomic_load_explicit(&d->steal, memory_order_relaxed);
+    stats->max = d->max;
+    stats->resizes = d->resizes;
+    stats->bytes_copied = d->copied;
+    stats->capacity = r->mask + 1;
+    stats->peak_capacity = r->mask + 1;
+    stats->bytes = d->bytes;
+    stats->peak_bytes = d->bytes;
+    stats->failed = d->failed;
+    stats->empty_pops = d->empty_pops;
+
+    return 0;
+}
+
+/* Replace the ring 'r' by one of twice the size holding the items between
+ * 'top' and 'bottom'. Return the new ring or NULL if allocation failed. */
+static struct ring *grow(struct wsdeque *d, struct ring *r, long long top,
+                         long long bottom) {
+    struct ring *bigger = ring_init((r->mask + 1) * 2);
+    if (bigger == NULL) {
+        return NULL;
+    }
+
+    for (long long i = top; i < bottom; i++) {
+        ring_put(bigger, i, ring_get(r, i));
+    }
+
+    bigger->older = r;
+    atomic_store_explicit(&d->ring, bigger, memory_order_release);
+    d->resizes++;
+    d->copied += (size_t) (bottom - top) * sizeof(atomic_int);
+    d->bytes += (bigger->mask + 1) * sizeof(atomic_int);
+    return bigger;
+}
+
+int wsdeque_push(struct wsdeque *d, int e) {
+    if (d == NULL) {
+        return 1;
+    }
+
+    long long bottom = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    long long top = atomic_load_explicit(&d->top, memory_order_acquire);
+    struct ring *r = atomic_load_explicit(&d->ring, memory_order_relaxed);
+
+    if ((size_t) (bottom - top) > r->mask) {
+        r = grow(d, r, top, bottom);
+        if (r == NULL) {
+            d->failed++;
+            return 1;
+        }
+    }
+
+    ring_put(r, bottom, e);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&d->bottom, bottom + 1, memory_order_relaxed);
+
+    d->push++;
+    if ((size_t) (bottom + 1 - top) > d->max) {
+        d->max = (size_t) (bottom + 1 - top);
+    }
+
+    return 0;
+}
+
+int wsdeque_pop(struct wsdeque *d) {
+    if (d == NULL) {
+        return -1;
+    }
+
+    long long bottom = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    struct ring *r = atomic_load_explicit(&d->ring, memory_order_relaxed);
+    atomic_store_explicit(&d->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long top = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        /* The deque was empty. */
+        atomic_store_explicit(&d->bottom, bottom + 1, memory_order_relaxed);
+        d->empty_pops++;
+        return -1;
+    }
+
+    int value = ring_get(r, bottom);
+
+    if (top == bottom) {
+        /* This is the last item, so a thief may be trying to take it. */
+        int won = atomic_compare_exchange_strong_explicit(&d->top, &top,
+                                                          top + 1,
+                                                          memory_order_seq_cst,
+                                                          memory_order_relaxed);
+        atomic_store_explicit(&d->bottom, bottom + 1, memory_order_relaxed);
+        if (!won) {
+            /* A thief took it, so the deque was empty after all. */
+            d->empty_pops++;
+            return -1;
+        }
+    }
+
+    d->pop++;
+    return value;
+}
+
+int wsdeque_steal(struct wsdeque *d) {
+    if (d == NULL) {
+        return -1;
+    }
+
+    long long top = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long bottom = atomic_load_explicit(&d->bottom, memory_order_acquire);
+
+    if (top >= bottom) {
+        return -1;
+    }
+
+    struct ring *r = atomic_load_explicit(&d->ring, memory_order_acquire);
+    int value = ring_get(r, top);
+
+    if (!atomic_compare_exchange_strong_explicit(&d->top, &top, top + 1,
+                                                 memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        return -1;
+    }
+
+    atomic_fetch_add_explicit(&d->steal, 1, memory_order_relaxed);
+    return value;
+}
+
+int wsdeque_empty(const struct wsdeque *d) {
+    if (d == NULL) {
+        return -1;
+    }
+
+    return wsdeque_size(d) == 0;
+}
+
+size_t wsdeque_size(const struct wsdeque *d) {
+    if (d == NULL) {
+        return 1;
+    }
+
+    long long top = atomic_load_explicit(&d->top, memory_order_acquire);
+    long long bottom = atomic_load_explicit(&d->bottom, memory_order_acquire);
+
+    return bottom > top ? (size_t) (bottom - top) : 0;
+}
@@ -0,0 +1,53 @@
+#ifndef _WSDEQUE_H_
+#define _WSDEQUE_H_
+
+#include <stddef.h>
+
+#include "container_stats.h"
+
+/* Handle to a work-stealing deque.
+ *
+ * The deque has one owner thread, which pushes and pops items at the
+ * bottom like a stack. Any other thread may steal items from the top. */
+struct wsdeque;
+
+/* Return a pointer to a deque with an initial capacity of 'capacity' if
+ * successful, otherwise return NULL. The deque grows when it is full. */
+struct wsdeque *wsdeque_init(size_t capacity);
+
+/* Cleanup deque. No thread may use the deque anymore. */
+void wsdeque_cleanup(struct wsdeque *d);
+
+/* Print deque statistics to stderr.
+ * The format is: 'stats' num_of_pushes num_of_pops max_elements
+ * where num_of_pops includes the items that were stolen. */
+void wsdeque_stats(const struct wsdeque *d);
+
+/* Fill in 'stats' with the statistics of 'd', where pop includes the items
+ * that were stolen. Only the owner, or any thread once no other thread
+ * uses the deque anymore. Return 0 if successful, 1 otherwise. */
+int wsdeque_get_stats(const struct wsdeque *d, struct container_stats *stats);
+
+/* Push item onto the bottom of the deque. Owner only.
+ * Return 0 if successful, 1 otherwise. */
+int wsdeque_push(struct wsdeque *d, int e);
+
+/* Pop item from the bottom of the deque and return it. Owner only.
+ * Return the bottom item if successful, -1 otherwise. */
+int wsdeque_pop(struct wsdeque *d);
+
+/* Steal item from the top of the deque and return it. Any thread but the
+ * owner.
+ * Return the top item if successful, -1 if the deque is empty or another
+ * thread took the item first. */
+int wsdeque_steal(struct wsdeque *d);
+
+/* Return 1 if deque is empty, 0 if the deque contains any elements and
+ * return -1 if the operation fails. */
+int wsdeque_empty(const struct wsdeque *d);
+
+/* Return the number of elements stored in the deque. While other threads
+ * are using the deque this is only a snapshot. */
+size_t wsdeque_size(const struct wsdeque *d);
+
+#endif